@@ -0,0 +1,59 @@
+/**
+ * aspects.cpp benchmarks
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#include "bench.hpp"
+#include "../src/aspects.hpp"
+#include "../test/synthetic_sky.hpp"
+
+namespace {
+
+using namespace github::paulyc;
+
+using synthetic::at;
+
+static constexpr double YEAR_JD = 365.25;
+
+}
+
+// against the synthetic sky, since the ephemeris isn't here; the second figure is
+// what sampling the sky costs, the rest of the first is the search itself
+BENCHMARK(aspects_year) {
+    JPLEphems ephems;
+    synthetic::Sky::open(ephems);
+    const jd_clock::time_point from = at(synthetic::Sky::T0), to = at(synthetic::Sky::T0 + YEAR_JD);
+    std::size_t found = 0;
+    bench::run("findAspects, all 45 pairs, per day searched", static_cast<std::size_t>(YEAR_JD), [&]() {
+        found = findAspects(ephems, from, to).size();
+        bench::keep(found);
+    });
+    std::cout << "  " << found << " aspects a year\n";
+
+    const JPLEphems::Point bodies[] = {
+        JPLEphems::Sun, JPLEphems::Moon, JPLEphems::Mercury, JPLEphems::Venus, JPLEphems::Mars,
+        JPLEphems::Jupiter, JPLEphems::Saturn, JPLEphems::Uranus, JPLEphems::Neptune, JPLEphems::Pluto,
+    };
+    JPLEphems::State states[10];
+    bench::run("the ten-body sample alone, per half-day step", static_cast<std::size_t>(YEAR_JD) * 2, [&]() {
+        for (double jd = synthetic::Sky::T0; jd < synthetic::Sky::T0 + YEAR_JD; jd += 0.5) {
+            ephems.get_geocentric(jd, bodies, 10, states, true);
+            bench::keep(states);
+        }
+    });
+}
@@ -0,0 +1,77 @@
+/**
+ * bench.hpp - tiny benchmark harness
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#ifndef PAULYC_BENCH_HPP
+#define PAULYC_BENCH_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+struct Benchmark {
+    std::string name;
+    std::function<void()> fun;
+};
+
+std::vector<Benchmark>& registry();
+
+struct Registrar {
+    Registrar(const char *name, std::function<void()> fun) {
+        registry().push_back(Benchmark {name, fun});
+    }
+};
+
+// keep the optimizer from throwing away a result we only compute to time it
+template <typename T>
+inline void keep(const T &value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+// time fun(), which processes `items` things per call, reporting the best of a few
+// runs as ns per item and items per second
+template <typename F>
+void run(const std::string &name, std::size_t items, F &&fun) {
+    using clock = std::chrono::steady_clock;
+    static constexpr int RUNS = 5;
+    double best = 1e300;
+    fun(); // warm up caches and any lazy tables
+    for (int i = 0; i < RUNS; ++i) {
+        const clock::time_point start = clock::now();
+        fun();
+        const std::chrono::duration<double> elapsed = clock::now() - start;
+        best = std::min(best, elapsed.count());
+    }
+    std::cout << name << ": " << (best * 1e9 / static_cast<double>(items)) << " ns/item, "
+              << (static_cast<double>(items) / best) << " items/s\n";
+}
+
+}
+
+#define BENCHMARK(name) \
+    static void bench_##name(); \
+    static bench::Registrar registrar_##name(#name, bench_##name); \
+    static void bench_##name()
+
+#endif /* PAULYC_BENCH_HPP */
@@ -0,0 +1,81 @@
+/**
+ * calculus.cpp benchmarks
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#include "bench.hpp"
+#include "../src/calculus.hpp"
+#include "../src/chebyshev.hpp"
+
+namespace {
+
+using namespace github::paulyc;
+
+static constexpr std::size_t SAMPLES = 1000000;
+static constexpr long double DELTA = 1e-4l;
+
+// cheap enough that the cost of getting to it shows
+inline long double f(long double x) {
+    return x * (x * (0.5l * x - 1.0l) + 2.0l) / (1.0l + x * x);
+}
+
+template <typename Op>
+void sweep(const char *name, const Op &op) {
+    bench::run(name, SAMPLES, [&]() {
+        long double sum = 0.0l;
+        for (std::size_t i = 0; i < SAMPLES; ++i) {
+            sum += op(static_cast<long double>(i) * 1e-5l);
+        }
+        bench::keep(sum);
+    });
+}
+
+}
+
+BENCHMARK(calculus_derivative) {
+    const fun_1d_t fun = f;
+    const auto lambda = [](long double x) { return f(x); };
+    sweep("f itself (lower bound)", lambda);
+    sweep("d_op, std::function", d_op(fun, DELTA));
+    sweep("make_d_op<1>, lambda", make_d_op<1>(lambda, DELTA));
+    sweep("make_richardson_op<1>, lambda", make_richardson_op<1>(lambda, DELTA));
+}
+
+BENCHMARK(calculus_second_derivative) {
+    const fun_1d_t fun = f;
+    const auto lambda = [](long double x) { return f(x); };
+    // how d2_op used to be built
+    sweep("d_op(d_op), std::function", d_op(d_op(fun, DELTA), DELTA));
+    sweep("make_d_op<2>, lambda", make_d_op<2>(lambda, DELTA));
+    sweep("make_richardson_op<2>, lambda", make_richardson_op<2>(lambda, DELTA));
+}
+
+BENCHMARK(calculus_chebyshev) {
+    // stand-in for an ephemeris lookup: smooth, and not cheap
+    const auto expensive = [](long double x) {
+        long double sum = 0.0l;
+        for (int k = 1; k <= 20; ++k) {
+            sum += sinl(k * x) / (k * k);
+        }
+        return sum;
+    };
+    const ChebyshevApproximation<long double> fit(expensive, 0.0l, 10.0l, 1e-15l);
+    std::cout << fit.pieces().size() << " pieces from " << fit.evaluations() << " evaluations\n";
+    sweep("direct", expensive);
+    sweep("ChebyshevApproximation", fit);
+}
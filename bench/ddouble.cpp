@@ -0,0 +1,112 @@
+/**
+ * ddouble.cpp benchmarks
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "bench.hpp"
+#include "../src/ddouble.hpp"
+
+namespace {
+
+using mmm::ddouble;
+
+static constexpr std::size_t SAMPLES = 100000;
+
+// the same inputs in every type: exactly representable in a double-double
+struct Inputs {
+    std::vector<ddouble> x, y;
+
+    Inputs() {
+        for (std::size_t i = 0; i < SAMPLES; ++i) {
+            x.push_back(ddouble(std::cos(i * 0.001) * 30.0) + std::sin(i * 0.003) * 0x1p-60);
+            y.push_back(ddouble(std::sin(i * 0.0007) + 1.5) + std::cos(i * 0.002) * 0x1p-60);
+        }
+    }
+
+    template <typename T>
+    std::vector<T> as(const std::vector<ddouble> &v) const {
+        std::vector<T> out;
+        for (const ddouble &d : v) {
+            out.push_back(static_cast<T>(static_cast<__float128>(d)));
+        }
+        return out;
+    }
+};
+
+struct Op {
+    const char *name;
+    __float128 (*reference)(__float128, __float128);
+};
+
+static const Op OPS[] = {
+    {"a * b + a", [](__float128 a, __float128 b) { return a * b + a; }},
+    {"a / b", [](__float128 a, __float128 b) { return a / b; }},
+    {"sqrt(b)", [](__float128, __float128 b) { return sqrtq(b); }},
+    {"sin(a)", [](__float128 a, __float128) { return sinq(a); }},
+    {"atan2(b, a)", [](__float128 a, __float128 b) { return atan2q(b, a); }},
+};
+
+template <typename T>
+T apply(std::size_t op, const T &a, const T &b) {
+    using mmm::sqrt;
+    using mmm::sin;
+    using mmm::atan2;
+    switch (op) {
+    case 0: return a * b + a;
+    case 1: return a / b;
+    case 2: return sqrt(b);
+    case 3: return sin(a);
+    default: return atan2(b, a);
+    }
+}
+
+// time each op in T, and report its worst error against __float128 as the
+// number of correct bits
+template <typename T>
+void compare(const char *type, const Inputs &in) {
+    const std::vector<T> x = in.as<T>(in.x), y = in.as<T>(in.y);
+    std::vector<T> out(SAMPLES);
+    for (std::size_t op = 0; op < std::size(OPS); ++op) {
+        bench::run(std::string(type) + " " + OPS[op].name, SAMPLES, [&]() {
+            for (std::size_t i = 0; i < SAMPLES; ++i) {
+                out[i] = apply(op, x[i], y[i]);
+            }
+            bench::keep(out);
+        });
+        __float128 worst = 0;
+        for (std::size_t i = 0; i < SAMPLES; ++i) {
+            const __float128 exact = OPS[op].reference(static_cast<__float128>(in.x[i]), static_cast<__float128>(in.y[i]));
+            worst = std::max(worst, fabsq(static_cast<__float128>(out[i]) - exact) / std::max(fabsq(exact), 1.0q));
+        }
+        std::cout << "  " << (worst > 0 ? -static_cast<double>(log2q(worst)) : 113.0) << " correct bits\n";
+    }
+}
+
+}
+
+BENCHMARK(ddouble_vs_float128) {
+    const Inputs in;
+    compare<double>("double", in);
+    compare<long double>("long double", in);
+    compare<ddouble>("ddouble", in);
+    compare<__float128>("__float128", in);
+}
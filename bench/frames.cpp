@@ -0,0 +1,79 @@
+/**
+ * frames.cpp benchmarks
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#include "bench.hpp"
+#include "../src/frames.hpp"
+
+namespace {
+
+using github::paulyc::FrameRotation;
+
+static constexpr std::size_t SAMPLES = 100000;
+
+struct Series {
+    std::vector<jd_clock::time_point> jds;
+    std::vector<cartesian3dvec> in, out;
+
+    // one vector every ~5 minutes over a year
+    Series() {
+        for (std::size_t i = 0; i < SAMPLES; ++i) {
+            const long double jd = jd_clock::JD2000_EPOCH_JD + 7300.0l + 365.25l * i / SAMPLES;
+            jds.push_back(jd_clock::time_point(jd_clock::duration(jd)));
+            in.push_back(cartesian3dvec {{cosl(i * 0.001l), sinl(i * 0.001l), 0.1l}});
+            out.push_back(cartesian3dvec {{0.0l, 0.0l, 0.0l}});
+        }
+    }
+};
+
+}
+
+BENCHMARK(frames_equatorial_to_ecliptic) {
+    Series s;
+    FrameRotation frames;
+    bench::run("exact matrix per sample", SAMPLES, [&]() {
+        frames.toEclipticOfDate(s.jds, s.in, s.out, true);
+        bench::keep(s.out);
+    });
+    bench::run("interpolated, 1 day nodes", SAMPLES, [&]() {
+        frames.toEclipticOfDate(s.jds, s.in, s.out);
+        bench::keep(s.out);
+    });
+    const mat3x3q_t fixed = frames.ecliptic(s.jds[0].time_since_epoch().count());
+    bench::run("one fixed matrix (lower bound)", SAMPLES, [&]() {
+        for (std::size_t i = 0; i < SAMPLES; ++i) {
+            const vec3q_t q = fixed.mul(s.in[i]);
+            s.out[i] = cartesian3dvec {{q.raw[0], q.raw[1], q.raw[2]}};
+        }
+        bench::keep(s.out);
+    });
+}
+
+BENCHMARK(frames_ecliptic_to_equatorial) {
+    Series s;
+    FrameRotation frames;
+    bench::run("exact matrix per sample", SAMPLES, [&]() {
+        frames.fromEclipticOfDate(s.jds, s.in, s.out, true);
+        bench::keep(s.out);
+    });
+    bench::run("interpolated, 1 day nodes", SAMPLES, [&]() {
+        frames.fromEclipticOfDate(s.jds, s.in, s.out);
+        bench::keep(s.out);
+    });
+}
@@ -0,0 +1,83 @@
+/**
+ * iso8601.cpp benchmarks
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#include "bench.hpp"
+#include "../src/iso8601.hpp"
+
+#include <ctime>
+#include <iomanip>
+#include <sstream>
+
+namespace {
+
+using namespace github::paulyc;
+
+static constexpr std::size_t SAMPLES = 1000000;
+
+// a spread of event times over two centuries
+std::vector<std::chrono::system_clock::time_point> timestamps() {
+    std::vector<std::chrono::system_clock::time_point> tps;
+    for (std::size_t i = 0; i < SAMPLES; ++i) {
+        tps.push_back(std::chrono::system_clock::from_time_t(-2000000000ll + static_cast<std::time_t>(i) * 6311) +
+                      std::chrono::milliseconds(i % 1000));
+    }
+    return tps;
+}
+
+}
+
+BENCHMARK(iso8601_format) {
+    const auto tps = timestamps();
+    std::vector<char> out(SAMPLES * iso8601::LENGTH);
+    bench::run("iso8601::format into one buffer", SAMPLES, [&]() {
+        char *p = out.data();
+        for (const auto &tp : tps) {
+            p = iso8601::format(tp, p);
+        }
+        bench::keep(out);
+    });
+    // what operator<< used to do, minus the global gmtime() buffer
+    bench::run("gmtime_r + put_time into an ostringstream", SAMPLES, [&]() {
+        std::ostringstream os;
+        for (const auto &tp : tps) {
+            const std::time_t tt = std::chrono::system_clock::to_time_t(tp);
+            std::tm tm;
+            os << std::put_time(gmtime_r(&tt, &tm), "%FT%T%z (%Z)") << '\n';
+        }
+        bench::keep(os.str());
+    });
+}
+
+BENCHMARK(iso8601_parse) {
+    const auto tps = timestamps();
+    std::vector<char> text(SAMPLES * iso8601::LENGTH);
+    char *p = text.data();
+    for (const auto &tp : tps) {
+        p = iso8601::format(tp, p);
+    }
+    std::vector<std::chrono::system_clock::time_point> back(SAMPLES);
+    bench::run("iso8601::parse", SAMPLES, [&]() {
+        for (std::size_t i = 0; i < SAMPLES; ++i) {
+            iso8601::parse(std::string_view(text.data() + i * iso8601::LENGTH, iso8601::LENGTH), back[i]);
+        }
+        bench::keep(back);
+    });
+    std::cout << "  round trips: " << (std::equal(back.begin(), back.end(), tps.begin()) ? "exact" : "NOT exact") << std::endl;
+}
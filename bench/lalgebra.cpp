@@ -0,0 +1,159 @@
+/**
+ * lalgebra.cpp benchmarks
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#include "bench.hpp"
+#include "../src/lalgebra.hpp"
+
+namespace {
+
+static constexpr std::size_t SAMPLES = 1000000;
+
+// how mat3x3 multiplied and transposed before it was unrolled
+mat3x3q_t loopMul(const mat3x3q_t &a, const mat3x3q_t &b) {
+    mat3x3q_t product;
+    for (std::size_t i = 0; i < 3; ++i) {
+        for (std::size_t j = 0; j < 3; ++j) {
+            product.elems[i][j] = a.elems[i][0] * b.elems[0][j] + a.elems[i][1] * b.elems[1][j] + a.elems[i][2] * b.elems[2][j];
+        }
+    }
+    return product;
+}
+
+mat3x3q_t loopTranspose(const mat3x3q_t &m) {
+    mat3x3q_t t;
+    for (std::size_t i = 0; i < 3; ++i) {
+        for (std::size_t j = 0; j < 3; ++j) {
+            t.elems[i][j] = m.elems[j][i];
+        }
+    }
+    return t;
+}
+
+long double angle(std::size_t i) {
+    return 1e-6l * static_cast<long double>(i);
+}
+
+}
+
+BENCHMARK(lalgebra_mat3x3_product) {
+    const mat3x3q_t a = mat3x3q_t::R_1(0.4l), b = mat3x3q_t::R_3(1.1l);
+    std::vector<mat3x3q_t> out(SAMPLES);
+    bench::run("per-element loop", SAMPLES, [&]() {
+        for (std::size_t i = 0; i < SAMPLES; ++i) {
+            out[i] = loopMul(out[i > 0 ? i - 1 : 0], b);
+        }
+        bench::keep(out);
+    });
+    out.assign(SAMPLES, a);
+    bench::run("unrolled", SAMPLES, [&]() {
+        for (std::size_t i = 0; i < SAMPLES; ++i) {
+            out[i] = out[i > 0 ? i - 1 : 0].mul(b);
+        }
+        bench::keep(out);
+    });
+}
+
+BENCHMARK(lalgebra_composed_rotation) {
+    std::vector<mat3x3q_t> out(SAMPLES);
+    bench::run("R_3 R_1 R_3, per-element loop products", SAMPLES, [&]() {
+        for (std::size_t i = 0; i < SAMPLES; ++i) {
+            out[i] = loopMul(loopMul(mat3x3q_t::R_3(-angle(i)), mat3x3q_t::R_1(0.409l + angle(i))), mat3x3q_t::R_3(2.0l * angle(i)));
+        }
+        bench::keep(out);
+    });
+    bench::run("R_3 R_1 R_3, unrolled products", SAMPLES, [&]() {
+        for (std::size_t i = 0; i < SAMPLES; ++i) {
+            out[i] = mat3x3q_t::R_3(-angle(i)).mul(mat3x3q_t::R_1(0.409l + angle(i))).mul(mat3x3q_t::R_3(2.0l * angle(i)));
+        }
+        bench::keep(out);
+    });
+    bench::run("R_seq<3, 1, 3>", SAMPLES, [&]() {
+        for (std::size_t i = 0; i < SAMPLES; ++i) {
+            out[i] = mat3x3q_t::R_seq<3, 1, 3>(-angle(i), 0.409l + angle(i), 2.0l * angle(i));
+        }
+        bench::keep(out);
+    });
+}
+
+BENCHMARK(lalgebra_inverse_rotation) {
+    const mat3x3q_t m = mat3x3q_t::R_seq<3, 1, 3>(-0.2l, 0.409l, 0.1l);
+    std::vector<vec3q_t> v(SAMPLES, vec3q_t {0.1l, 0.2l, 0.3l});
+    bench::run("loop transpose, then mul", SAMPLES, [&]() {
+        for (std::size_t i = 1; i < SAMPLES; ++i) {
+            v[i] = loopTranspose(m).mul(v[i - 1]);
+        }
+        bench::keep(v);
+    });
+    bench::run("transposeMul", SAMPLES, [&]() {
+        for (std::size_t i = 1; i < SAMPLES; ++i) {
+            v[i] = m.transposeMul(v[i - 1]);
+        }
+        bench::keep(v);
+    });
+}
+
+BENCHMARK(lalgebra_funmat) {
+    typedef funmat3x3<spherical3dvec> fm;
+    typedef std::function<long double(const spherical3dvec&, int, int)> coeffun;
+    // how funmat3x3 held sph2cart_mtrx before: one type-erased call per element
+    const coeffun sinθcosø = [](const spherical3dvec &v, int, int) { return sinl(v.θ()) * cosl(v.ø()); };
+    const coeffun cosθcosø = [](const spherical3dvec &v, int, int) { return cosl(v.θ()) * cosl(v.ø()); };
+    const coeffun sinθsinø = [](const spherical3dvec &v, int, int) { return sinl(v.θ()) * sinl(v.ø()); };
+    const coeffun cosθsinø = [](const spherical3dvec &v, int, int) { return cosl(v.θ()) * sinl(v.ø()); };
+    const coeffun minus_sinø = [](const spherical3dvec &v, int, int) { return -sinl(v.ø()); };
+    const coeffun cosø = [](const spherical3dvec &v, int, int) { return cosl(v.ø()); };
+    const coeffun cosθ = [](const spherical3dvec &v, int, int) { return cosl(v.θ()); };
+    const coeffun minus_sinθ = [](const spherical3dvec &v, int, int) { return -sinl(v.θ()); };
+    const coeffun zero = [](const spherical3dvec &, int, int) { return 0.0l; };
+    const std::array<std::array<coeffun, 3>, 3> m = {{
+        {sinθcosø, cosθcosø, minus_sinø},
+        {sinθsinø, cosθsinø, cosø},
+        {cosθ, minus_sinθ, zero},
+    }};
+
+    std::vector<spherical3dvec> v;
+    for (std::size_t i = 0; i < SAMPLES; ++i) {
+        v.push_back(spherical3dvec {{1.0l, angle(i) + 0.1l, 3.0l * angle(i)}});
+    }
+    std::vector<spherical3dvec> out(v);
+    bench::run("sph2cart_mtrx, std::function elements", SAMPLES, [&]() {
+        for (std::size_t i = 0; i < SAMPLES; ++i) {
+            spherical3dvec r {{0.0l, 0.0l, 0.0l}};
+            for (int row = 0; row < 3; ++row) {
+                r.raw[row] = m[row][0](v[i], row, 0) * v[i].raw[0] + m[row][1](v[i], row, 1) * v[i].raw[1] + m[row][2](v[i], row, 2) * v[i].raw[2];
+            }
+            out[i] = r;
+        }
+        bench::keep(out);
+    });
+    bench::run("sph2cart_mtrx, expression template", SAMPLES, [&]() {
+        for (std::size_t i = 0; i < SAMPLES; ++i) {
+            out[i] = fm::sph2cart_mtrx.mul(v[i]);
+        }
+        bench::keep(out);
+    });
+    const auto r13 = fm::R_1_mtrx.mul(fm::R_3_mtrx);
+    bench::run("R_1_mtrx R_3_mtrx, expression template", SAMPLES, [&]() {
+        for (std::size_t i = 0; i < SAMPLES; ++i) {
+            out[i] = r13.mul(v[i]);
+        }
+        bench::keep(out);
+    });
+}
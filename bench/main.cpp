@@ -0,0 +1,47 @@
+/**
+ * benchmark runner
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#include "bench.hpp"
+
+#include <cstring>
+
+namespace bench {
+
+std::vector<Benchmark>& registry() {
+    static std::vector<Benchmark> benchmarks;
+    return benchmarks;
+}
+
+}
+
+// bench [substring ...] runs every benchmark whose name contains one of the substrings, or all of them
+int main(int argc, char *argv[]) {
+    for (const bench::Benchmark &b : bench::registry()) {
+        bool selected = argc < 2;
+        for (int i = 1; i < argc; ++i) {
+            selected = selected || b.name.find(argv[i]) != std::string::npos;
+        }
+        if (selected) {
+            std::cout << "== " << b.name << '\n';
+            b.fun();
+        }
+    }
+    return 0;
+}
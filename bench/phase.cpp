@@ -0,0 +1,121 @@
+/**
+ * phase.cpp benchmarks
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#include "bench.hpp"
+#include "../src/phase.hpp"
+
+#include <cmath>
+#include <string>
+#include <vector>
+
+namespace {
+
+using namespace github::paulyc;
+
+static constexpr std::size_t SAMPLES = 1000000;
+
+// Stand-in for the ephemeris, which isn't here to bench against: the Earth and
+// the Moon on mean circular orbits in the equator, the Sun at the barycenter
+void meanSky(double jd, JPLEphems::Point point, double *pv) {
+    const double t = jd - 2451545.0;
+    double x = 0.0, y = 0.0;
+    if (point == JPLEphems::Earth || point == JPLEphems::Moon) {
+        x = cos(1.75347 + 0.0172021 * t);
+        y = sin(1.75347 + 0.0172021 * t);
+    }
+    if (point == JPLEphems::Moon) {
+        x += 0.00257 * cos(3.81034 + 0.229972 * t);
+        y += 0.00257 * sin(3.81034 + 0.229972 * t);
+    }
+    pv[0] = x;
+    pv[1] = y;
+    pv[2] = pv[3] = pv[4] = pv[5] = 0.0;
+}
+
+double angleBetween(const double *a, const double *b) {
+    const double cx = a[1] * b[2] - a[2] * b[1];
+    const double cy = a[2] * b[0] - a[0] * b[2];
+    const double cz = a[0] * b[1] - a[1] * b[0];
+    return atan2(sqrt(cx * cx + cy * cy + cz * cz), a[0] * b[0] + a[1] * b[1] + a[2] * b[2]);
+}
+
+// how moonPhases used to work the states out, a libm atan2, sqrt and cos at a time
+void libmPhases(const std::vector<JPLEphems::State> &moon, const std::vector<JPLEphems::State> &sun, PhaseSeries &out) {
+    static const double COS_ɛ = cos(static_cast<double>(OBLIQUITY_J2000));
+    static const double SIN_ɛ = sin(static_cast<double>(OBLIQUITY_J2000));
+    out.resize(moon.size());
+    for (std::size_t i = 0; i < moon.size(); ++i) {
+        const double *m = moon[i].pv, *s = sun[i].pv;
+        const double toEarth[3] = {-m[0], -m[1], -m[2]}, toSun[3] = {s[0] - m[0], s[1] - m[1], s[2] - m[2]};
+        out.phaseAngle[i] = angleBetween(toEarth, toSun);
+        out.illuminated[i] = 0.5 * (1.0 + cos(out.phaseAngle[i]));
+        out.elongation[i] = angleBetween(m, s);
+        double Δλ = atan2(COS_ɛ * m[1] + SIN_ɛ * m[2], m[0]) - atan2(COS_ɛ * s[1] + SIN_ɛ * s[2], s[0]);
+        if (Δλ < 0.0) {
+            Δλ += 2.0 * M_PI;
+        }
+        out.age[i] = Δλ * (SYNODIC_MONTH_JD / (2.0 * M_PI));
+    }
+}
+
+}
+
+BENCHMARK(phase_series) {
+    JPLEphems ephems;
+    ephems.init("mean sky", &meanSky, 149597870.7);
+    // an hour apart, a bit over a century
+    std::vector<jd_clock::time_point> jds(SAMPLES);
+    std::vector<double> epochs(SAMPLES);
+    for (std::size_t i = 0; i < SAMPLES; ++i) {
+        epochs[i] = 2451545.0 + static_cast<double>(i) / 24.0;
+        jds[i] = jd_clock::time_point(jd_clock::duration(epochs[i]));
+    }
+
+    // what the stand-in costs on its own, to take off the figure below
+    std::vector<JPLEphems::State> moon(SAMPLES), sun(SAMPLES);
+    bench::run("get_moon_sun from the mean sky", SAMPLES, [&]() {
+        ephems.get_moon_sun(epochs.data(), SAMPLES, moon.data(), sun.data());
+        bench::keep(moon);
+    });
+
+    PhaseSeries series;
+    bench::run("get_moon_sun + libm per epoch, 1M sorted epochs", SAMPLES, [&]() {
+        ephems.get_moon_sun(epochs.data(), SAMPLES, moon.data(), sun.data());
+        libmPhases(moon, sun, series);
+        bench::keep(series);
+    });
+    for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::AVX2, SimdLevel::AVX512}) {
+        if (level <= detectedSimdLevel()) {
+            bench::run(std::string("moonPhases, 1M sorted epochs, ") + name(level), SAMPLES, [&]() {
+                moonPhases(ephems, jds, series, level);
+                bench::keep(series);
+            });
+        }
+    }
+
+    std::vector<jd_clock::time_point> shuffled(SAMPLES);
+    for (std::size_t i = 0; i < SAMPLES; ++i) {
+        shuffled[i] = jds[(i * 7919) % SAMPLES];
+    }
+    bench::run("moonPhases, 1M shuffled epochs", SAMPLES, [&]() {
+        moonPhases(ephems, shuffled, series);
+        bench::keep(series);
+    });
+}
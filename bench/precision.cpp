@@ -0,0 +1,106 @@
+/**
+ * precision.cpp benchmarks
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#include "bench.hpp"
+#include "../src/astro.hpp"
+
+#include <algorithm>
+#include <vector>
+
+namespace {
+
+using namespace github::paulyc;
+
+static constexpr std::size_t SAMPLES = 20000;
+static constexpr long double CENTURY_JD = 36525.0l;
+
+// Stand-in for the ephemeris, which isn't here to bench against: mean circular
+// orbits of the Sun and the Moon (with the Moon's inclination and regressing
+// node) in the ecliptic, rotated to the equator and precessed, all in policy P.
+// Days from J2000 run up to a century, so the arguments get as large as the
+// real ones do.
+template <typename P>
+MoonSunGeometry<P> toyGeometry(real_t<P> t) {
+    typedef real_t<P> real;
+    typedef typename P::matrix matrix;
+    const real λ_sun = real(4.89506300986l) + real(0.0172027916955l) * t;
+    const real λ_moon = real(3.81034102697l) + real(0.229971502687l) * t;
+    const real Ω = real(2.18243919661l) - real(0.000924220705l) * t;
+    const real p = real(6.1e-12l) * t;
+    const matrix precess = matrix::template R_seq<3, 1, 3>(-p, real(0.5l) * p, -p);
+    const matrix equator = precess.mul(matrix::R_1(real(-OBLIQUITY_J2000)));
+    const matrix moonOrbit = equator.mul(matrix::template R_seq<3, 1>(-Ω, real(-0.0898041713l)));
+    const real u = λ_moon - Ω;
+    const vec3<real> moon = moonOrbit.mul(vec3<real> {{real(0.00256955529l) * mmm::cos(u), real(0.00256955529l) * mmm::sin(u), real(0)}});
+    const vec3<real> sun = equator.mul(vec3<real> {{mmm::cos(λ_sun), mmm::sin(λ_sun), real(0)}});
+    return moonSunGeometry<P>(typename P::cartesian {{moon.raw[0], moon.raw[1], moon.raw[2]}},
+                              typename P::cartesian {{sun.raw[0], sun.raw[1], sun.raw[2]}});
+}
+
+template <typename P>
+real_t<P> epoch(std::size_t i) {
+    return real_t<P>(CENTURY_JD * static_cast<long double>(i) / SAMPLES);
+}
+
+// the new moon after t0, by min_x over the elongation in days from t0
+template <typename P>
+long double newMoon(long double t0) {
+    typedef real_t<P> real;
+    const std::optional<real> u = min_x<P>([t0](real u) { return toyGeometry<P>(real(t0) + u).elongation; },
+                                           real(0), real(29.6l), real(1e-12l));
+    return u ? t0 + static_cast<long double>(*u) : -1.0l;
+}
+
+template <typename P>
+void report(const std::vector<__float128> &reference, const std::vector<long double> &referenceNewMoons) {
+    std::vector<long double> elongations(SAMPLES);
+    bench::run(std::string(P::name) + " pipeline", SAMPLES, [&]() {
+        for (std::size_t i = 0; i < SAMPLES; ++i) {
+            elongations[i] = static_cast<long double>(toyGeometry<P>(epoch<P>(i)).elongation);
+        }
+    });
+    long double worst = 0.0l;
+    for (std::size_t i = 0; i < SAMPLES; ++i) {
+        worst = std::max(worst, fabsl(elongations[i] - static_cast<long double>(reference[i])));
+    }
+    long double worstNewMoon = 0.0l;
+    for (std::size_t k = 0; k < referenceNewMoons.size(); ++k) {
+        worstNewMoon = std::max(worstNewMoon, fabsl(newMoon<P>(k * 1000.0l) - referenceNewMoons[k]));
+    }
+    std::cout << "  " << P::name << " (" << P::digits << " bit mantissa): max elongation error "
+              << worst << " rad, max new moon error " << worstNewMoon * 86400.0l << " s\n";
+}
+
+}
+
+// the same templates instantiated on each policy, timed, and checked against __float128
+BENCHMARK(precision_policies) {
+    std::vector<__float128> reference(SAMPLES);
+    for (std::size_t i = 0; i < SAMPLES; ++i) {
+        reference[i] = toyGeometry<quad_precision>(epoch<quad_precision>(i)).elongation;
+    }
+    std::vector<long double> referenceNewMoons(36);
+    for (std::size_t k = 0; k < referenceNewMoons.size(); ++k) {
+        referenceNewMoons[k] = newMoon<quad_precision>(k * 1000.0l);
+    }
+    report<double_precision>(reference, referenceNewMoons);
+    report<extended_precision>(reference, referenceNewMoons);
+    report<quad_precision>(reference, referenceNewMoons);
+}
@@ -0,0 +1,111 @@
+/**
+ * quaternion.cpp benchmarks
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#include "bench.hpp"
+#include "../src/quaternion.hpp"
+#include "../src/frames.hpp"
+
+namespace {
+
+using namespace github::paulyc;
+
+static constexpr std::size_t SAMPLES = 100000;
+
+}
+
+BENCHMARK(quaternion_compose) {
+    // a precession-nutation-like chain of five elementary rotations
+    const long double θ[5] = {0.01l, 0.4l, -0.02l, 0.00004l, -0.4l};
+    const quaternion<double> qs[5] = {
+        quaternion<double>::R_3(θ[0]), quaternion<double>::R_1(θ[1]), quaternion<double>::R_3(θ[2]),
+        quaternion<double>::R_1(θ[3]), quaternion<double>::R_1(θ[4])};
+    mat3x3<double> ms[5];
+    for (int i = 0; i < 5; ++i) {
+        ms[i] = qs[i].matrix();
+    }
+    bench::run("quaternion<double> 5-rotation chain", SAMPLES, [&]() {
+        quaternion<double> acc = quaternion<double>::identity();
+        for (std::size_t i = 0; i < SAMPLES; ++i) {
+            acc = qs[i % 5].mul(acc);
+            if (i % 5 == 4) {
+                bench::keep(acc);
+                acc = quaternion<double>::identity();
+            }
+        }
+    });
+    bench::run("mat3x3<double> 5-rotation chain", SAMPLES, [&]() {
+        mat3x3<double> acc = mat3x3<double>::identity();
+        for (std::size_t i = 0; i < SAMPLES; ++i) {
+            acc = ms[i % 5].mul(acc);
+            if (i % 5 == 4) {
+                bench::keep(acc);
+                acc = mat3x3<double>::identity();
+            }
+        }
+    });
+}
+
+BENCHMARK(quaternion_batch_rotate) {
+    std::vector<cartesian3dvec> aos;
+    for (std::size_t i = 0; i < SAMPLES; ++i) {
+        aos.push_back(cartesian3dvec {{cosl(i * 0.001l), sinl(i * 0.001l), 0.1l}});
+    }
+    const Vec3BatchD in {std::span<const cartesian3dvec>(aos)};
+    Vec3BatchD out = in;
+    const quaternion<double> q = quaternion<double>::R_3(0.3l).mul(quaternion<double>::R_1(0.4l));
+    bench::run("quaternion<double>::mul per vector", SAMPLES, [&]() {
+        for (std::size_t i = 0; i < SAMPLES; ++i) {
+            bench::keep(q.mul(aos[i]));
+        }
+    });
+    for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::AVX2, SimdLevel::AVX512}) {
+        if (level <= detectedSimdLevel()) {
+            bench::run(std::string("batch::rotate, ") + name(level), SAMPLES, [&]() {
+                batch::rotate(q, in, out, level);
+                bench::keep(out);
+            });
+        }
+    }
+}
+
+BENCHMARK(quaternion_slerped_npb) {
+    FrameRotation frames;
+    SlerpedRotation<long double> slerped([&](long double jd) {
+        return quaternion<long double>::fromMatrix(frames.npb(jd));
+    });
+    const long double jd0 = jd_clock::JD2000_EPOCH_JD + 7300.0l;
+    auto jd = [&](std::size_t i) { return jd0 + 365.25l * i / SAMPLES; };
+    bench::run("FrameRotation::npbInterpolated", SAMPLES, [&]() {
+        for (std::size_t i = 0; i < SAMPLES; ++i) {
+            bench::keep(frames.npbInterpolated(jd(i)));
+        }
+    });
+    bench::run("SlerpedRotation::at, 1 day nodes", SAMPLES, [&]() {
+        for (std::size_t i = 0; i < SAMPLES; ++i) {
+            bench::keep(slerped.at(jd(i)));
+        }
+    });
+    long double worst = 0.0l;
+    for (std::size_t i = 0; i < SAMPLES; i += 97) {
+        const quaternion<long double> exact = quaternion<long double>::fromMatrix(frames.npb(jd(i)));
+        worst = std::max(worst, quaternion<long double>::angle(exact, slerped.at(jd(i))));
+    }
+    std::cout << "  slerp max error vs exact npb: " << worst * 206264806.247l << " mas" << std::endl;
+}
@@ -0,0 +1,78 @@
+/**
+ * tetrabiblos.cpp benchmarks
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#include "bench.hpp"
+#include "../src/tetrabiblos.hpp"
+
+namespace {
+
+using namespace github::paulyc;
+using namespace github::paulyc::tetrabiblos;
+using std::chrono::system_clock;
+
+static constexpr std::size_t SAMPLES = 1000000;
+
+jd_clock::time_point at(long double jd) {
+    return jd_clock::time_point(jd_clock::duration(jd));
+}
+
+}
+
+// mean new moons and equal signs over a century stand in for the ephemeris
+// search; what's timed is the conversion once they're cached
+BENCHMARK(tetrabiblos_dates) {
+    static constexpr long double SYNODIC = 29.530588853l;
+    static constexpr long double SIGN = 365.24219l / 12.0l;
+    const long double from = 2451000.0l, to = from + 100 * 365.25l;
+    std::vector<jd_clock::time_point> newMoons;
+    std::vector<PlanetEvent> ingresses;
+    for (long double jd = 2459198.18l - 1300 * SYNODIC; jd < to; jd += SYNODIC) {
+        if (jd >= from) {
+            newMoons.push_back(at(jd));
+        }
+    }
+    for (int k = -300; 2459205.42l + k * SIGN < to; ++k) {
+        const long double jd = 2459205.42l + k * SIGN;
+        const int sign = ((9 + k) % 12 + 12) % 12;
+        if (jd >= from) {
+            ingresses.push_back(PlanetEvent {JPLEphems::Sun, PlanetEvent::Ingress, at(jd), sign * MMM_PI / 6.0l, sign});
+        }
+    }
+    Calendar calendar;
+    calendar.insert(at(from), at(to), newMoons, ingresses);
+
+    std::vector<system_clock::time_point> sorted, scattered;
+    for (std::size_t i = 0; i < SAMPLES; ++i) {
+        sorted.push_back(jd_clock::to_system_clock(at(from + 500.0l + (to - from - 600.0l) * i / SAMPLES)));
+    }
+    for (std::size_t i = 0; i < SAMPLES; ++i) {
+        scattered.push_back(sorted[(i * 7919) % SAMPLES]);
+    }
+    std::vector<Date> out(SAMPLES);
+    bench::run("Calendar::dates, sorted over a century", SAMPLES, [&]() {
+        calendar.dates(sorted, out);
+        bench::keep(out);
+    });
+    bench::run("Calendar::dates, scattered", SAMPLES, [&]() {
+        calendar.dates(scattered, out);
+        bench::keep(out);
+    });
+    std::cout << "  " << calendar.months() << " months cached" << std::endl;
+}
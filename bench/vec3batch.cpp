@@ -0,0 +1,114 @@
+/**
+ * vec3batch.cpp benchmarks
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#include "bench.hpp"
+#include "../src/vec3batch.hpp"
+#include "../src/astro.hpp"
+
+namespace {
+
+using namespace github::paulyc;
+
+// big enough not to sit in cache
+static constexpr std::size_t SAMPLES = 4000000;
+
+struct Series {
+    std::vector<cartesian3dvec> aos_a, aos_b;
+    Vec3BatchD a, b;
+    std::vector<double> out;
+
+    Series() : out(SAMPLES) {
+        for (std::size_t i = 0; i < SAMPLES; ++i) {
+            aos_a.push_back(cartesian3dvec {{cosl(i * 0.001l), sinl(i * 0.001l), 0.1l}});
+            aos_b.push_back(cartesian3dvec {{sinl(i * 0.002l), 1.0l, cosl(i * 0.002l)}});
+        }
+        a = Vec3BatchD(std::span<const cartesian3dvec>(aos_a));
+        b = Vec3BatchD(std::span<const cartesian3dvec>(aos_b));
+    }
+};
+
+template <typename Kernel>
+void levels(const char *what, Kernel &&kernel) {
+    for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::AVX2, SimdLevel::AVX512}) {
+        if (level <= detectedSimdLevel()) {
+            bench::run(std::string("Vec3Batch<double> ") + what + ", " + name(level), SAMPLES, [&]() {
+                kernel(level);
+            });
+        }
+    }
+}
+
+}
+
+BENCHMARK(vec3batch_dot_mag) {
+    Series s;
+    bench::run("cartesian3dvec dotP", SAMPLES, [&]() {
+        for (std::size_t i = 0; i < SAMPLES; ++i) {
+            s.out[i] = s.aos_a[i].dotP(s.aos_b[i]);
+        }
+        bench::keep(s.out);
+    });
+    levels("dot", [&](SimdLevel level) {
+        batch::dot(s.a, s.b, s.out, level);
+        bench::keep(s.out);
+    });
+    bench::run("cartesian3dvec mag", SAMPLES, [&]() {
+        for (std::size_t i = 0; i < SAMPLES; ++i) {
+            s.out[i] = s.aos_a[i].mag();
+        }
+        bench::keep(s.out);
+    });
+    levels("mag", [&](SimdLevel level) {
+        batch::mag(s.a, s.out, level);
+        bench::keep(s.out);
+    });
+}
+
+BENCHMARK(vec3batch_cross_normalize) {
+    Series s;
+    Vec3BatchD out;
+    levels("cross", [&](SimdLevel level) {
+        batch::cross(s.a, s.b, out, level);
+        bench::keep(out.z);
+    });
+    levels("normalize", [&](SimdLevel level) {
+        batch::normalize(s.a, out, level);
+        bench::keep(out.z);
+    });
+}
+
+BENCHMARK(vec3batch_angle_sph) {
+    Series s;
+    Vec3BatchD sph;
+    bench::run("elongation(cartesian3dvec)", SAMPLES, [&]() {
+        for (std::size_t i = 0; i < SAMPLES; ++i) {
+            s.out[i] = elongation(s.aos_a[i], s.aos_b[i]);
+        }
+        bench::keep(s.out);
+    });
+    levels("angle", [&](SimdLevel level) {
+        batch::angle(s.a, s.b, s.out, level);
+        bench::keep(s.out);
+    });
+    levels("cart2sph", [&](SimdLevel level) {
+        batch::cart2sph(s.a, sph, level);
+        bench::keep(sph.z);
+    });
+}
@@ -0,0 +1,118 @@
+/**
+ * vmath.cpp benchmarks
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#include <cmath>
+
+#include "bench.hpp"
+#include "../src/vmath.hpp"
+
+namespace {
+
+using namespace github::paulyc;
+
+static constexpr std::size_t SAMPLES = 1000000;
+
+struct Series {
+    std::vector<double> x, y, u, out, out2;
+
+    Series() : out(SAMPLES), out2(SAMPLES) {
+        for (std::size_t i = 0; i < SAMPLES; ++i) {
+            x.push_back(std::cos(i * 0.001) * 100.0);
+            y.push_back(std::sin(i * 0.0007) * 50.0);
+            u.push_back(std::sin(i * 0.0013));
+        }
+    }
+};
+
+template <typename Kernel>
+void levels(const std::string &what, Kernel &&kernel) {
+    for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::AVX2, SimdLevel::AVX512}) {
+        if (level <= detectedSimdLevel()) {
+            bench::run("vmath::" + what + ", " + name(level), SAMPLES, [&]() {
+                kernel(level);
+            });
+        }
+    }
+}
+
+}
+
+BENCHMARK(vmath_sincos) {
+    Series s;
+    bench::run("sinl", SAMPLES, [&]() {
+        for (std::size_t i = 0; i < SAMPLES; ++i) {
+            s.out[i] = sinl(s.x[i]);
+        }
+        bench::keep(s.out);
+    });
+    bench::run("std::sin and std::cos", SAMPLES, [&]() {
+        for (std::size_t i = 0; i < SAMPLES; ++i) {
+            s.out[i] = std::sin(s.x[i]);
+            s.out2[i] = std::cos(s.x[i]);
+        }
+        bench::keep(s.out);
+        bench::keep(s.out2);
+    });
+    levels("sincos", [&](SimdLevel level) {
+        vmath::sincos(s.x, s.out, s.out2, level);
+        bench::keep(s.out);
+        bench::keep(s.out2);
+    });
+}
+
+BENCHMARK(vmath_atan2) {
+    Series s;
+    bench::run("atan2l", SAMPLES, [&]() {
+        for (std::size_t i = 0; i < SAMPLES; ++i) {
+            s.out[i] = atan2l(s.y[i], s.x[i]);
+        }
+        bench::keep(s.out);
+    });
+    bench::run("std::atan2", SAMPLES, [&]() {
+        for (std::size_t i = 0; i < SAMPLES; ++i) {
+            s.out[i] = std::atan2(s.y[i], s.x[i]);
+        }
+        bench::keep(s.out);
+    });
+    levels("atan2", [&](SimdLevel level) {
+        vmath::atan2(s.y, s.x, s.out, level);
+        bench::keep(s.out);
+    });
+}
+
+BENCHMARK(vmath_acos) {
+    Series s;
+    bench::run("acosl", SAMPLES, [&]() {
+        for (std::size_t i = 0; i < SAMPLES; ++i) {
+            s.out[i] = acosl(s.u[i]);
+        }
+        bench::keep(s.out);
+    });
+    bench::run("std::acos", SAMPLES, [&]() {
+        for (std::size_t i = 0; i < SAMPLES; ++i) {
+            s.out[i] = std::acos(s.u[i]);
+        }
+        bench::keep(s.out);
+    });
+    levels("acos", [&](SimdLevel level) {
+        vmath::acos(s.u, s.out, level);
+        bench::keep(s.out);
+    });
+}
@@ -0,0 +1,144 @@
+/**
+ * apparent.cpp
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#include "apparent.hpp"
+
+#include <limits>
+
+namespace github {
+namespace paulyc {
+
+namespace {
+
+static constexpr long double SPEED_OF_LIGHT_KM_S = 299792.458l;
+static constexpr long double ARCSEC = MMM_PI / 648000.0l;
+static constexpr long double LIGHT_TIME_TOLERANCE_JD = 1e-12l;
+static constexpr int LIGHT_TIME_MAX_ITER = 4;
+
+cartesian3dvec scaled(const cartesian3dvec &v, long double s) {
+    return {{v.x() * s, v.y() * s, v.z() * s}};
+}
+
+}
+
+ApparentPlace::ApparentPlace(JPLEphems &ephems) :
+    _ephems(ephems),
+    _c_au_per_day(SPEED_OF_LIGHT_KM_S * jd_clock::SECONDS_PER_JDAY / ephems.au_km()),
+    _earth_jd(std::numeric_limits<double>::quiet_NaN()),
+    _earth_pos({{0.0l, 0.0l, 0.0l}}),
+    _earth_vel({{0.0l, 0.0l, 0.0l}}),
+    _nutation({std::numeric_limits<long double>::quiet_NaN(), 0.0l, 0.0l})
+{
+    for (long double &τ : _light_time) {
+        τ = 0.0l;
+    }
+}
+
+long double ApparentPlace::precessionInLongitude(long double jd) {
+    const long double T = (jd - jd_clock::JD2000_EPOCH_JD) / 36525.0l;
+    return ARCSEC * T * (5028.796195l + T * (1.1054348l + T * (0.00007964l + T * (-0.000023857l + T * -0.0000000383l))));
+}
+
+long double ApparentPlace::precessionRate(long double jd) {
+    const long double T = (jd - jd_clock::JD2000_EPOCH_JD) / 36525.0l;
+    return ARCSEC * (5028.796195l + T * (2.2108696l + T * (0.00023892l + T * (-0.000095428l + T * -0.0000001915l)))) / 36525.0l;
+}
+
+void ApparentPlace::earthAt(double jd) {
+    if (jd != _earth_jd) {
+        const JPLEphems::State earth = _ephems.get_state(jd, JPLEphems::SolarSystemBarycenter, JPLEphems::Earth, true);
+        _earth_pos = earth.position();
+        _earth_vel = earth.velocity();
+        _earth_jd = jd;
+    }
+}
+
+long double ApparentPlace::nutationInLongitude(double jd) {
+    if (!(fabsl(jd - _nutation.jd) <= NUTATION_CACHE_JD)) {
+        const JPLEphems::NutationState ns = _ephems.get_nutations(jd);
+        _nutation = {jd, ns.nutationInLongitude(), ns.nutationInLongitudeRate()};
+    }
+    return _nutation.Δψ + _nutation.dΔψ * (jd - _nutation.jd);
+}
+
+cartesian3dvec ApparentPlace::ecliptic(JPLEphems::Point body, const jd_clock::time_point &jd, unsigned corrections) {
+    const double t = static_cast<double>(jd.time_since_epoch().count());
+    earthAt(t);
+
+    // geocentric vector to where the body was when the light left it
+    long double τ = (corrections & LightTime) ? _light_time[body] : 0.0l;
+    cartesian3dvec p = _ephems.get_state(t - static_cast<double>(τ), JPLEphems::SolarSystemBarycenter, body).position().sum(scaled(_earth_pos, -1.0l));
+    if (corrections & LightTime) {
+        for (int i = 0; i < LIGHT_TIME_MAX_ITER; ++i) {
+            const long double τ_next = p.mag() / _c_au_per_day;
+            const bool converged = fabsl(τ_next - τ) < LIGHT_TIME_TOLERANCE_JD;
+            τ = τ_next;
+            if (converged) {
+                break;
+            }
+            p = _ephems.get_state(t - static_cast<double>(τ), JPLEphems::SolarSystemBarycenter, body).position().sum(scaled(_earth_pos, -1.0l));
+        }
+    }
+
+    if (corrections & LightTime) {
+        _light_time[body] = τ;
+    }
+
+    // annual aberration, relativistic form from the Explanatory Supplement (3.252-3)
+    if (corrections & Aberration) {
+        const long double r = p.mag();
+        const cartesian3dvec u = scaled(p, 1.0l / r);
+        const cartesian3dvec V = scaled(_earth_vel, 1.0l / _c_au_per_day);
+        const long double β_inv = sqrtl(1.0l - V.dotP(V));
+        const long double uV = u.dotP(V);
+        const cartesian3dvec a = scaled(u, β_inv).sum(scaled(V, 1.0l + uV / (1.0l + β_inv)));
+        p = scaled(a, r / (1.0l + uV));
+    }
+
+    cartesian3dvec e = equatorialToEcliptic(p);
+
+    // precession and nutation in longitude are both a turn about the ecliptic pole;
+    // the small tilt of the ecliptic itself (~47"/century) is not modelled here
+    long double Δλ = 0.0l;
+    if (corrections & Precession) {
+        Δλ += precessionInLongitude(t);
+    }
+    if (corrections & Nutation) {
+        Δλ += nutationInLongitude(t);
+    }
+    if (Δλ != 0.0l) {
+        const vec3q_t q = mat3x3q_t::R_3(-Δλ).mul(e);
+        e = cartesian3dvec {{q.raw[0], q.raw[1], q.raw[2]}};
+    }
+    return e;
+}
+
+std::pair<long double, long double> ApparentPlace::eclipticLonLat(JPLEphems::Point body, const jd_clock::time_point &jd, unsigned corrections) {
+    const cartesian3dvec e = ecliptic(body, jd, corrections);
+    long double λ = atan2l(e.y(), e.x());
+    if (λ < 0.0l) {
+        λ += MMM_2_PI;
+    }
+    const long double β = atan2l(e.z(), sqrtl(e.x() * e.x() + e.y() * e.y()));
+    return {λ, β};
+}
+
+}
+}
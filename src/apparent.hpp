@@ -0,0 +1,93 @@
+/**
+ * apparent.hpp
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#ifndef PAULYC_APPARENT_HPP
+#define PAULYC_APPARENT_HPP
+
+#include "astro.hpp"
+
+#include <utility>
+
+namespace github {
+namespace paulyc {
+
+// Geocentric apparent places from the ephemeris: light-time, annual aberration,
+// precession and nutation, each switchable per query so throughput-sensitive
+// callers can ask for just the geometric vector.
+//
+// The slowly varying parts are cached across nearby epochs: the Earth's state is
+// reused for every body asked about at the same epoch, the light-time iteration
+// restarts from the previous result for that body (so it usually converges on
+// the first ephemeris call), and the nutation angles are read once per
+// NUTATION_CACHE_JD and carried forward with their rates from the ephemeris.
+class ApparentPlace
+{
+public:
+    enum Correction {
+        Geometric  = 0,
+        LightTime  = 1 << 0,
+        Aberration = 1 << 1,
+        Precession = 1 << 2,
+        Nutation   = 1 << 3,
+
+        Apparent = LightTime | Aberration | Precession | Nutation,
+    };
+
+    // linear extrapolation with the nutation rates stays under 0.01" over this
+    static constexpr long double NUTATION_CACHE_JD = 0.5l;
+
+    explicit ApparentPlace(JPLEphems &ephems);
+
+    // geocentric ecliptic position in au, referred to the true ecliptic and equinox of date
+    // with Precession|Nutation, to the J2000 ecliptic without
+    cartesian3dvec ecliptic(JPLEphems::Point body, const jd_clock::time_point &jd, unsigned corrections = Apparent);
+
+    // ecliptic {longitude in [0, 2π), latitude} in radians
+    std::pair<long double, long double> eclipticLonLat(JPLEphems::Point body, const jd_clock::time_point &jd, unsigned corrections = Apparent);
+
+    // general precession in longitude from J2000 (IAU 2006), radians
+    static long double precessionInLongitude(long double jd);
+    // and its rate, radians per day
+    static long double precessionRate(long double jd);
+
+private:
+    struct NutationCache {
+        long double jd;
+        long double Δψ;
+        long double dΔψ;
+    };
+
+    void earthAt(double jd);
+    long double nutationInLongitude(double jd);
+
+    JPLEphems &_ephems;
+    long double _c_au_per_day;
+
+    double _earth_jd;
+    cartesian3dvec _earth_pos, _earth_vel;
+
+    long double _light_time[JPLEphems::TT_TDB + 1];
+    NutationCache _nutation;
+};
+
+}
+}
+
+#endif /* PAULYC_APPARENT_HPP */
@@ -0,0 +1,301 @@
+/**
+ * aspects.cpp
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#include "aspects.hpp"
+#include "parallel.hpp"
+#include "solvers.hpp"
+
+#include <algorithm>
+
+namespace github {
+namespace paulyc {
+
+namespace {
+
+static constexpr double STEP_JD = 0.5;
+static constexpr double TOLERANCE_JD = 1e-8;
+// one parallel task's worth of time
+static constexpr double WINDOW_JD = 64.0;
+
+static const double COS_ɛ = cos(static_cast<double>(OBLIQUITY_J2000));
+static const double SIN_ɛ = sin(static_cast<double>(OBLIQUITY_J2000));
+
+struct Target {
+    Aspect::Kind kind;
+    double θ;
+};
+
+static const Target TARGETS[] = {
+    {Aspect::Conjunction, 0.0},
+    {Aspect::Sextile, M_PI / 3.0},
+    {Aspect::Sextile, -M_PI / 3.0},
+    {Aspect::Square, M_PI / 2.0},
+    {Aspect::Square, -M_PI / 2.0},
+    {Aspect::Trine, 2.0 * M_PI / 3.0},
+    {Aspect::Trine, -2.0 * M_PI / 3.0},
+    {Aspect::Opposition, M_PI},
+};
+
+struct Pair {
+    std::size_t i;
+    std::size_t j;
+};
+
+// J2000 ecliptic longitude and its rate from a geocentric equatorial state
+struct LonRate {
+    double λ;
+    double dλ;
+};
+
+LonRate lonRate(const JPLEphems::State &s) {
+    const double x = s.pv[0];
+    const double y = COS_ɛ * s.pv[1] + SIN_ɛ * s.pv[2];
+    const double vx = s.pv[3];
+    const double vy = COS_ɛ * s.pv[4] + SIN_ɛ * s.pv[5];
+    return LonRate {atan2(y, x), (x * vy - y * vx) / (x * x + y * y)};
+}
+
+std::vector<Pair> allPairs() {
+    std::vector<Pair> pairs;
+    for (std::size_t i = 0; i < Aspect::NBODIES; ++i) {
+        for (std::size_t j = i + 1; j < Aspect::NBODIES; ++j) {
+            pairs.push_back(Pair {i, j});
+        }
+    }
+    return pairs;
+}
+
+class Searcher
+{
+public:
+    Searcher(JPLEphems &ephems, const std::vector<Pair> &pairs, unsigned kinds) :
+        _ephems(ephems), _pairs(pairs), _kinds(kinds)
+    {
+        // only evaluate the bodies these pairs need
+        bool needed[Aspect::NBODIES] = {false};
+        for (const Pair &p : _pairs) {
+            needed[p.i] = needed[p.j] = true;
+        }
+        for (std::size_t k = 0; k < Aspect::NBODIES; ++k) {
+            _slot[k] = _bodies.size();
+            if (needed[k]) {
+                _bodies.push_back(Aspect::BODIES[k]);
+            }
+        }
+    }
+
+    void run(double from, double to, std::vector<Aspect> &out) {
+        std::vector<LonRate> prev(_bodies.size()), next(_bodies.size());
+        sample(from, prev.data());
+        for (double t0 = from; t0 < to; ) {
+            const double t1 = std::min(t0 + STEP_JD, to);
+            sample(t1, next.data());
+            for (const Pair &p : _pairs) {
+                const LonRate &a0 = prev[_slot[p.i]], &b0 = prev[_slot[p.j]];
+                const LonRate &a1 = next[_slot[p.i]], &b1 = next[_slot[p.j]];
+                const double d0 = wrapAngle(a0.λ - b0.λ);
+                const double Δd = wrapAngle(a1.λ - b1.λ - d0);
+                const double dd0 = a0.dλ - b0.dλ;
+                const double dd1 = a1.dλ - b1.dλ;
+                for (const Target &target : TARGETS) {
+                    if (_kinds & target.kind) {
+                        const double g0 = wrapAngle(d0 - target.θ);
+                        solveStep(p, target, t0, t1, g0, dd0, g0 + Δd, dd1, out);
+                    }
+                }
+            }
+            std::swap(prev, next);
+            t0 = t1;
+        }
+    }
+
+private:
+    void sample(double jd, LonRate *out) {
+        JPLEphems::State states[Aspect::NBODIES];
+        _ephems.get_geocentric(jd, _bodies.data(), _bodies.size(), states, true);
+        for (std::size_t k = 0; k < _bodies.size(); ++k) {
+            out[k] = lonRate(states[k]);
+        }
+    }
+
+    // g = separation - θ and its rate, from just the two bodies
+    std::pair<double, double> offset(const Pair &p, const Target &target, double jd) {
+        const JPLEphems::Point bodies[2] = {Aspect::BODIES[p.i], Aspect::BODIES[p.j]};
+        JPLEphems::State states[2];
+        _ephems.get_geocentric(jd, bodies, 2, states, true);
+        const LonRate a = lonRate(states[0]), b = lonRate(states[1]);
+        return {wrapAngle(a.λ - b.λ - target.θ), a.dλ - b.dλ};
+    }
+
+    void solve(const Pair &p, const Target &target, double ta, double tb, double ga, double gb, std::vector<Aspect> &out) {
+        auto g = [this, &p, &target](double jd) {
+            return offset(p, target, jd);
+        };
+        const SolverResult<double> jd = newton_root(g, ta, tb, ga, gb, TOLERANCE_JD);
+        if (jd) {
+            out.push_back(Aspect {
+                Aspect::BODIES[p.i], Aspect::BODIES[p.j], target.kind,
+                jd_clock::time_point(jd_clock::duration(jd.x)),
+                wrapAngle(jd.fx + target.θ)});
+        }
+    }
+
+    // g over the step as the cubic Hermite through both ends; a sign change is one
+    // crossing, and when the rate turns around inside the step the turning point
+    // can hide two of them
+    void solveStep(const Pair &p, const Target &target, double t0, double t1, double g0, double dg0, double g1, double dg1, std::vector<Aspect> &out) {
+        if ((g0 < 0.0) != (g1 < 0.0)) {
+            solve(p, target, t0, t1, g0, g1, out);
+            return;
+        } else if ((dg0 < 0.0) == (dg1 < 0.0)) {
+            return;
+        }
+        const double h = t1 - t0;
+        const double a = 2.0 * g0 + h * dg0 - 2.0 * g1 + h * dg1;
+        const double b = -3.0 * g0 - 2.0 * h * dg0 + 3.0 * g1 - h * dg1;
+        const double c = h * dg0;
+        // the one root of g' = 3as² + 2bs + c in (0, 1)
+        double s;
+        if (fabs(a) < 1e-300) {
+            s = -c / (2.0 * b);
+        } else {
+            const double disc = sqrt(std::max(0.0, b * b - 3.0 * a * c));
+            s = (-b + disc) / (3.0 * a);
+            if (!(s > 0.0 && s < 1.0)) {
+                s = (-b - disc) / (3.0 * a);
+            }
+        }
+        if (!(s > 0.0 && s < 1.0)) {
+            return;
+        }
+        const double gs = ((a * s + b) * s + c) * s + g0;
+        if ((gs < 0.0) != (g0 < 0.0)) {
+            const double ts = t0 + s * h;
+            solve(p, target, t0, ts, g0, gs, out);
+            solve(p, target, ts, t1, gs, g1, out);
+        }
+    }
+
+    JPLEphems &_ephems;
+    std::vector<Pair> _pairs;
+    unsigned _kinds;
+    std::vector<JPLEphems::Point> _bodies;
+    std::size_t _slot[Aspect::NBODIES];
+};
+
+void sortAspects(std::vector<Aspect> &aspects) {
+    std::sort(aspects.begin(), aspects.end(), [](const Aspect &x, const Aspect &y) {
+        if (x.jd != y.jd) {
+            return x.jd < y.jd;
+        } else if (x.a != y.a) {
+            return x.a < y.a;
+        }
+        return x.b < y.b;
+    });
+}
+
+}
+
+int Aspect::degrees(Kind kind) {
+    switch (kind) {
+    case Conjunction: return 0;
+    case Sextile: return 60;
+    case Square: return 90;
+    case Trine: return 120;
+    case Opposition: return 180;
+    default: return -1;
+    }
+}
+
+const char* Aspect::name(Kind kind) {
+    switch (kind) {
+    case Conjunction: return "conjunction";
+    case Sextile: return "sextile";
+    case Square: return "square";
+    case Trine: return "trine";
+    case Opposition: return "opposition";
+    default: return "unknown";
+    }
+}
+
+const char* Aspect::name(JPLEphems::Point body) {
+    switch (body) {
+    case JPLEphems::Mercury: return "Mercury";
+    case JPLEphems::Venus: return "Venus";
+    case JPLEphems::Earth: return "Earth";
+    case JPLEphems::Mars: return "Mars";
+    case JPLEphems::Jupiter: return "Jupiter";
+    case JPLEphems::Saturn: return "Saturn";
+    case JPLEphems::Uranus: return "Uranus";
+    case JPLEphems::Neptune: return "Neptune";
+    case JPLEphems::Pluto: return "Pluto";
+    case JPLEphems::Moon: return "Moon";
+    case JPLEphems::Sun: return "Sun";
+    default: return "unknown";
+    }
+}
+
+std::vector<Aspect> findAspects(JPLEphems &ephems, const jd_clock::time_point &from, const jd_clock::time_point &to, unsigned kinds) {
+    std::vector<Aspect> aspects;
+    Searcher(ephems, allPairs(), kinds).run(static_cast<double>(from.time_since_epoch().count()), static_cast<double>(to.time_since_epoch().count()), aspects);
+    sortAspects(aspects);
+    return aspects;
+}
+
+std::vector<Aspect> findAspects(const std::string &ephemeris, const jd_clock::time_point &from, const jd_clock::time_point &to, unsigned threads, unsigned kinds) {
+    const double jd_from = static_cast<double>(from.time_since_epoch().count());
+    const double jd_to = static_cast<double>(to.time_since_epoch().count());
+    threads = std::max(1u, threads);
+
+    const std::size_t windows = std::max<std::size_t>(1, static_cast<std::size_t>(ceil((jd_to - jd_from) / WINDOW_JD)));
+    const std::vector<Pair> pairs = allPairs();
+    const std::size_t groups = std::min(pairs.size(), std::max<std::size_t>(1, (threads + windows - 1) / windows));
+    std::vector<std::vector<Pair>> pairGroups(groups);
+    for (std::size_t k = 0; k < pairs.size(); ++k) {
+        pairGroups[k % groups].push_back(pairs[k]);
+    }
+
+    const std::size_t tasks = windows * groups;
+    std::vector<std::vector<Aspect>> results(tasks);
+    parallelEphemerisTasks(ephemeris, tasks, threads, [&](JPLEphems &ephems, std::size_t task) {
+        const std::size_t window = task / groups;
+        const double t0 = jd_from + static_cast<double>(window) * WINDOW_JD;
+        const double t1 = std::min(jd_to, t0 + WINDOW_JD);
+        Searcher(ephems, pairGroups[task % groups], kinds).run(t0, t1, results[task]);
+    });
+
+    std::vector<Aspect> aspects;
+    for (const std::vector<Aspect> &r : results) {
+        aspects.insert(aspects.end(), r.begin(), r.end());
+    }
+    sortAspects(aspects);
+    return aspects;
+}
+
+std::ostream& operator<<(std::ostream &os, const Aspect &aspect) {
+    using ::operator<<;
+    jd_clock::time_point jd = aspect.jd;
+    os << jd_clock::to_system_clock(jd) << ' ' << Aspect::name(aspect.a) << ' ' << Aspect::name(aspect.kind)
+       << ' ' << Aspect::name(aspect.b) << " separation " << aspect.separation * 180.0l / MMM_PI;
+    return os;
+}
+
+}
+}
@@ -0,0 +1,82 @@
+/**
+ * aspects.hpp
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#ifndef PAULYC_ASPECTS_HPP
+#define PAULYC_ASPECTS_HPP
+
+#include "astro.hpp"
+
+#include <string>
+#include <vector>
+
+namespace github {
+namespace paulyc {
+
+struct Aspect {
+    enum Kind {
+        Conjunction = 1 << 0,
+        Sextile     = 1 << 1,
+        Square      = 1 << 2,
+        Trine       = 1 << 3,
+        Opposition  = 1 << 4,
+
+        All = Conjunction | Sextile | Square | Trine | Opposition,
+    };
+
+    // the ten classical bodies, 45 pairs between them
+    static constexpr JPLEphems::Point BODIES[] = {
+        JPLEphems::Sun, JPLEphems::Moon, JPLEphems::Mercury, JPLEphems::Venus, JPLEphems::Mars,
+        JPLEphems::Jupiter, JPLEphems::Saturn, JPLEphems::Uranus, JPLEphems::Neptune, JPLEphems::Pluto,
+    };
+    static constexpr std::size_t NBODIES = sizeof(BODIES) / sizeof(BODIES[0]);
+
+    JPLEphems::Point a;
+    JPLEphems::Point b;
+    Kind kind;
+    jd_clock::time_point jd;
+    // ecliptic longitude of a minus that of b at the event, radians in (-π, π]
+    long double separation;
+
+    // aspect angle in degrees
+    static int degrees(Kind kind);
+    static const char* name(Kind kind);
+    static const char* name(JPLEphems::Point body);
+};
+
+// Every aspect between every pair of the ten bodies in [from, to), in time order.
+// Geocentric geometric longitudes on the J2000 ecliptic, which give the same
+// differences as the ecliptic of date to well under an arcsecond.
+//
+// The range is sampled every half day with one shared ephemeris evaluation for
+// all ten bodies (velocities included), each pair's separation is modelled as a
+// cubic Hermite over the step so crossings either side of a turnaround aren't
+// lost, and each crossing is then solved to ~1ms with Newton on the two bodies.
+std::vector<Aspect> findAspects(JPLEphems &ephems, const jd_clock::time_point &from, const jd_clock::time_point &to, unsigned kinds = Aspect::All);
+
+// Same, split into time windows (and groups of pairs when there are more threads
+// than windows) over `threads` workers, each with its own handle on the ephemeris.
+std::vector<Aspect> findAspects(const std::string &ephemeris, const jd_clock::time_point &from, const jd_clock::time_point &to, unsigned threads, unsigned kinds = Aspect::All);
+
+std::ostream& operator<<(std::ostream &os, const Aspect &aspect);
+
+}
+}
+
+#endif /* PAULYC_ASPECTS_HPP */
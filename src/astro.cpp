@@ -19,173 +19,111 @@
  **/
 
 #include "astro.hpp"
+#include "solvers.hpp"
 
 typedef std::function<long double(JPLEphems&, const jd_clock::time_point&)> f_type;
 
-struct result {
-    double jd_now;
-    cartesian3dvec moonpos;
-    long double moonR;
-    cartesian3dvec sunpos;
-    long double sunR ;
-    JPLEphems::NutationState ns;
-    long double α_moon;
-    long double δ_moon;
-    long double α_sun;
-    long double δ_sun;
-    long double dα;
-    long double Δψ;
-    long double Δɛ;
-    long double arg;
-    long double sphDistance;
-    spherical3dvec sphMoonpos, sphSunpos;
-};
-std::ostream &operator<<(std::ostream &os, const result &res) {
-    os << "arg " << res.arg << " α_moon " << res.α_moon << " α_sun " << res.α_sun << " dα " << res.dα;
-    return os;
+mmm::dual<long double> moonSunElongation(JPLEphems &ephems, const jd_clock::time_point &jd) {
+    typedef mmm::dual<long double> dual_t;
+    const split_jd_clock::time_point t = split_jd_clock::from_jd(jd);
+    const JPLEphems::State moon = ephems.get_state(t, JPLEphems::Earth, JPLEphems::Moon, true);
+    const JPLEphems::State sun = ephems.get_state(t, JPLEphems::Earth, JPLEphems::Sun, true);
+    const basic_cartesian3dvec<dual_t> m {{dual_t(moon.pv[0], moon.pv[3]), dual_t(moon.pv[1], moon.pv[4]), dual_t(moon.pv[2], moon.pv[5])}};
+    const basic_cartesian3dvec<dual_t> s {{dual_t(sun.pv[0], sun.pv[3]), dual_t(sun.pv[1], sun.pv[4]), dual_t(sun.pv[2], sun.pv[5])}};
+    return elongation(m, s);
 }
 
-void moonSunAngle(JPLEphems &ephems, const jd_clock::time_point &jd, result &res) {
-    res.jd_now = static_cast<double>(jd_clock::duration(jd.time_since_epoch()).count());
-    res.moonpos = ephems.get_state(res.jd_now, JPLEphems::EarthMoonBarycenter, JPLEphems::Moon).position();
-    res.moonR = res.moonpos.mag();
-    res.sunpos = ephems.get_state(res.jd_now, JPLEphems::Earth, JPLEphems::Sun).position();
-    res.sunR = res.sunpos.mag();
-    res.ns = ephems.get_nutations(res.jd_now);
-    res.sphMoonpos = spacexfrm3d::cart2sph(res.moonpos);
-    res.sphSunpos = spacexfrm3d::cart2sph(res.sunpos);
-    res.sphDistance = res.sphMoonpos.normalDistance(res.sphSunpos);
-    res.δ_moon = asinq(res.moonpos.z());
-    res.α_moon = asinq(res.moonpos.y() / cosq(res.δ_moon));
-    //res.α_moon = atanq(res.moonpos.y()/res.moonpos.x());// asinq(moonpos.y() / (moonR*cosq(δ_moon)));
-    //res.δ_moon = atanq(res.moonpos.z()/(res.moonpos.y()*sinq(res.α_moon)));
-
-    res.δ_sun = asinq(res.sunpos.z());
-    res.α_sun = asinq(res.sunpos.y() / cosq(res.δ_sun));
-    //res.α_sun = atanq(res.sunpos.y()/res.sunpos.x());//asinq(sunpos.y() / (moonR*cosq(δ_sun)));
-    //res.δ_sun = atanq(res.sunpos.z()/(res.sunpos.y()*sinq(res.α_sun)));
-
-    res.dα = res.α_moon - res.α_sun;
-
-    res.Δψ = res.ns.nutationInLongitude();
-    res.Δɛ = res.ns.nutationInObliquity();
-    res.arg = res.moonpos.angle(res.sunpos);
-
-#if 0
-    const long double ɛ_0 = 0.40904635907; //23.43663 deg in radians
-    const long double ɛ = ɛ_0;// + Δɛ;
-
-    const long double Δα_moon = (cosq(ɛ)  + sinq(ɛ)*sinq(α_moon)*tanq(δ_moon)) * Δψ - cosq(α_moon)*tan(δ_moon)*Δɛ;
-    const long double Δδ_moon = cosq(α_moon)*sinq(ɛ)*Δψ + sinq(α_moon)*Δɛ;
-    const long double Δα_sun = (cosq(ɛ)  + sinq(ɛ)*sinq(α_sun)*tanq(δ_sun)) * Δψ - cosq(α_sun)*tan(δ_sun)*Δɛ;
-    const long double Δδ_sun = cosq(α_sun)*sinq(ɛ)*Δψ + sinq(α_sun)*Δɛ;
-    const long double arg = (α_moon - Δα_moon) - (α_sun - Δα_sun);
-    JPLEphems::State ls = ephems.get_librations(jd_now);
-#endif
+template <typename P>
+MoonSunGeometry<P> moonSunGeometry(JPLEphems &ephems, const jd_clock::time_point &jd) {
+    typedef github::paulyc::real_t<P> real;
+    const split_jd_clock::time_point t = split_jd_clock::from_jd(jd);
+    auto in = [](const cartesian3dvec &v) {
+        return typename P::cartesian {{static_cast<real>(v.x()), static_cast<real>(v.y()), static_cast<real>(v.z())}};
+    };
+    return moonSunGeometry<P>(in(ephems.get_state(t, JPLEphems::Earth, JPLEphems::Moon).position()),
+                              in(ephems.get_state(t, JPLEphems::Earth, JPLEphems::Sun).position()));
 }
 
-inline int signum(long double x) {
-    if (x > 1e-9q) {
-        return 1;
-    } else if (x < -1e-9q) {
-        return -1;
-    } else {
-        return 0;
-    }
-}
-std::chrono::system_clock::time_point minFinder(JPLEphems &ephems, jd_clock::time_point &jd) {
-    std::chrono::system_clock::time_point mintp = std::chrono::system_clock::now();
-    long double minangle = MMM_2_PI;
-    result res;
-    moonSunAngle(ephems, jd, res);
-    long double arg0 = res.sphDistance, α_sun_0 = res.α_sun, d_α_sun0 = 0.0, d2_α_sun0 = 0.0;
-    long double d_arg, d_α_sun, d2_α_sun, d3_α_sun;
-    int sign_d_arg = 0, sign_α_sun = 0, sign_d_α_sun = 0, sign_d2_α_sun = 2, sign_d3_α_sun = 0;
-    for (int i = 0; i < 29*24*60; ++i) {
-        int flags = 0, sign;
-        jd += jd_clock::duration(60.0l/jd_clock::SECONDS_PER_JDAY);
+template MoonSunGeometry<github::paulyc::double_precision> moonSunGeometry<github::paulyc::double_precision>(JPLEphems &, const jd_clock::time_point &);
+template MoonSunGeometry<github::paulyc::extended_precision> moonSunGeometry<github::paulyc::extended_precision>(JPLEphems &, const jd_clock::time_point &);
+template MoonSunGeometry<github::paulyc::quad_precision> moonSunGeometry<github::paulyc::quad_precision>(JPLEphems &, const jd_clock::time_point &);
 
-        // WIP should really use sphAngle but have to get the math right
-        moonSunAngle(ephems, jd, res);
-        //std::cout << jd_clock::to_system_clock(jd) << " sphDistance: " << res.sphDistance << std::endl;
+// Steps a day at a time through the month after jd, reporting the equinox and
+// solstice crossings of α_sun and the full moon on the way, until the next new
+// moon, where jd is left. Each crossing is bracketed by the daily samples and
+// solved with the solvers in solvers.hpp: roots of α_sun and of the exact
+// elongation rate by Brent's method, the extrema of α_sun by Brent minimization.
+std::chrono::system_clock::time_point minFinder(JPLEphems &ephems, jd_clock::time_point &jd) {
+    using github::paulyc::SolverResult;
+    using github::paulyc::brent_root;
+    using github::paulyc::brent_min;
+    static constexpr long double STEP_JD = 1.0l;
+    static constexpr long double SPAN_JD = 30.0l;
+    static constexpr long double TOLERANCE_JD = 1e-8l;
+    auto at = [](long double t) {
+        return jd_clock::time_point(jd_clock::duration(t));
+    };
+    auto α_sun = [&ephems, &at](long double t) {
+        return moonSunGeometry<github::paulyc::default_precision>(ephems, at(t)).α_sun;
+    };
+    auto elongationRate = [&ephems, &at](long double t) {
+        return moonSunElongation(ephems, at(t)).d;
+    };
 
-        sign = signum(res.α_sun);
-        if (sign_α_sun == 0) {
-            sign_α_sun = sign;
-        } else if (sign != 0 && sign_α_sun != sign) {
-            sign_α_sun = sign;
-            flags |= 4;
-        }
-        d_α_sun = res.α_sun - α_sun_0;
-        α_sun_0 = res.α_sun;
-        sign = signum(d_α_sun);
-        if (sign_d_α_sun == 0) {
-            sign_d_α_sun = sign;
-        } else if (sign != 0 && sign_d_α_sun != sign) {
-            sign_d_α_sun = sign;
-            flags |= 1;
-        }
+    std::chrono::system_clock::time_point mintp = std::chrono::system_clock::now();
+    const long double start = jd.time_since_epoch().count();
+    long double t0 = start;
+    long double a0 = α_sun(t0), r0 = elongationRate(t0), da0 = 0.0l;
+    int evaluations = 2;
+    for (long double t1 = t0 + STEP_JD; t1 <= start + SPAN_JD; t1 += STEP_JD) {
+        const long double a1 = α_sun(t1), r1 = elongationRate(t1), da1 = a1 - a0;
+        evaluations += 2;
 
-        // trying to find cross quarters but doesnt seem to work might need d3_alpha
-        // dont think enough float128 has enough accuracy to calculate it like this
-        d2_α_sun = d_α_sun - d_α_sun0;
-        d_α_sun0 = d_α_sun;
-        sign = signum(d2_α_sun);
-        if (sign_d2_α_sun == 2) {
-            sign_d2_α_sun = 0;
-        } else if (sign_d2_α_sun == 0) {
-            sign_d2_α_sun = sign;
-        } else if (sign != 0 && sign_d2_α_sun != sign) {
-            sign_d2_α_sun = sign;
-            flags |= 2;
+        if ((a0 < 0.0l) != (a1 < 0.0l)) {
+            const SolverResult<long double> root = brent_root(α_sun, t0, t1, a0, a1, TOLERANCE_JD);
+            evaluations += root.evaluations;
+            if (root) {
+                jd_clock::time_point tp = at(root.x);
+                std::cout << jd_clock::to_system_clock(tp) << " zero crossing α_sun (equinox ref J2000) " << root.fx << '\n';
+            }
         }
 
-/*
-        if (sign_d2_α_sun != 0) {
-            d3_α_sun = d2_α_sun - d2_α_sun0;
-            d2_α_sun0 = d2_α_sun;
-            sign = signum(d3_α_sun);
-            if (sign_d3_α_sun == 2) {
-                sign_d3_α_sun = 0;
-            } else if (sign_d3_α_sun == 0) {
-                sign_d3_α_sun = sign;
-            } else if (sign != 0 && sign_d3_α_sun != sign) {
-                sign_d3_α_sun = sign;
-                flags |= 16;
+        // α_sun turned around somewhere in the last two steps; minimize in
+        // days from t0 so the tolerance isn't swamped by the size of a julian date
+        if (t0 > start && (da0 < 0.0l) != (da1 < 0.0l)) {
+            const long double sign = da0 > 0.0l ? -1.0l : 1.0l;
+            auto g = [&α_sun, sign, t0](long double u) {
+                return sign * α_sun(t0 + u);
+            };
+            const SolverResult<long double> ext = brent_min(g, -STEP_JD, STEP_JD, TOLERANCE_JD);
+            evaluations += ext.evaluations;
+            if (ext) {
+                jd_clock::time_point tp = at(t0 + ext.x);
+                std::cout << jd_clock::to_system_clock(tp) << " zero crossing d_α_sun (solstice ref J2000) α_sun " << sign * ext.fx << '\n';
             }
         }
-*/
-        d_arg = res.sphDistance - arg0;
-        arg0 = res.sphDistance;
-        sign = signum(d_arg);
-        if (sign_d_arg == 0) {
-            sign_d_arg = sign;
-        } else if (sign != 0 && sign_d_arg != sign) {
-            sign_d_arg = sign;
-            flags |= 8;
-        }
 
-        if (flags & 1) {
-            std::cout << jd_clock::to_system_clock(jd) << " zero crossing d_α_sun (solstice ref J2000) " << d_α_sun << " α_sun " << res.α_sun << std::endl;
-        }
-        if (flags & 2) {
-            //std::cout << jd_clock::to_system_clock(jd) << " zero crossing d2_α_sun " << d2_α_sun << " d_α_sun " << d_α_sun << std::endl;
-        }
-        if (flags & 4) {
-            std::cout << jd_clock::to_system_clock(jd) << " zero crossing α_sun (equinox ref J2000) " << res.α_sun << std::endl;
-        }
-        if (flags & 16) {
-            std::cout << jd_clock::to_system_clock(jd) << " zero crossing d3_α_sun " << d3_α_sun << " d2 " << d2_α_sun << std::endl;
-        }
-        if (flags & 8) {
-            mintp = jd_clock::to_system_clock(jd);
-            std::cout << mintp << " zero crossing d_arg " << (sign_d_arg > 0 ? " [new moon] " : " [full moon] ") << d_arg << " d " << res.sphDistance << std::endl;
-            std::cout << mintp << " α_sun " << res.α_sun << " d_α_sun " << d_α_sun << " d2_α_sun " << d2_α_sun << std::endl;
-            if (sign_d_arg > 0) {
-                return mintp;
+        // the elongation has a minimum at new moon and a maximum at full moon
+        if ((r0 < 0.0l) != (r1 < 0.0l)) {
+            const SolverResult<long double> root = brent_root(elongationRate, t0, t1, r0, r1, TOLERANCE_JD);
+            evaluations += root.evaluations;
+            if (root) {
+                jd_clock::time_point tp = at(root.x);
+                mintp = jd_clock::to_system_clock(tp);
+                if (r0 < 0.0l) {
+                    std::cout << mintp << " zero crossing d_arg [new moon] after " << evaluations << " evaluations\n";
+                    jd = tp;
+                    return mintp;
+                }
+                std::cout << mintp << " zero crossing d_arg [full moon]\n";
             }
         }
+
+        t0 = t1;
+        a0 = a1;
+        r0 = r1;
+        da0 = da1;
     }
-    std::cout << " none found " << mintp << std::endl;
+    std::cout << " none found " << mintp << '\n';
     return mintp;
 };
@@ -23,6 +23,7 @@
 
 #include "lalgebra.hpp"
 #include "calculus.hpp"
+#include "precision.hpp"
 #include "jd_clock.hpp"
 #include "ephemshelper.hpp"
 
@@ -31,7 +32,95 @@
 
 typedef std::function<long double(JPLEphems&, const jd_clock::time_point&)> f_type;
 
-long double moonSunAngle(JPLEphems &ephems, const jd_clock::time_point &jd);
+// mean obliquity of the ecliptic at J2000.0, IAU 2006 value of 84381.406 arcseconds
+static constexpr long double OBLIQUITY_J2000 = 0.409092600600582871l;
+
+// rotate an ICRF/J2000 equatorial vector (as returned by the ephemeris) into J2000 ecliptic coordinates
+template <typename T>
+basic_cartesian3dvec<T> equatorialToEcliptic(const basic_cartesian3dvec<T> &v) {
+    static const mat3x3<T> xfrm = mat3x3<T>::R_1(T(OBLIQUITY_J2000));
+    const vec3<T> q = xfrm.mul(v);
+    return basic_cartesian3dvec<T> {{q.raw[0], q.raw[1], q.raw[2]}};
+}
+
+// angle between two directions as atan2(|a×b|, a·b), which unlike acos of the
+// normalized dot product keeps its precision near 0 and π; with dual number
+// components the rate (and second derivative) comes out with it
+template <typename T>
+T elongation(const basic_cartesian3dvec<T> &a, const basic_cartesian3dvec<T> &b) {
+    return mmm::atan2(a.crossP(b).mag(), a.dotP(b));
+}
+
+// an angle to (-π, π]
+template <typename T>
+T wrapAngle(T a) {
+    a = mmm::fmod(a, T(MMM_2_PI));
+    if (a <= -T(MMM_PI)) {
+        a += T(MMM_2_PI);
+    } else if (a > T(MMM_PI)) {
+        a -= T(MMM_2_PI);
+    }
+    return a;
+}
+
+// geocentric elongation of the Moon from the Sun in radians, with its exact rate in
+// radians/day propagated from the ephemeris velocities instead of differenced
+mmm::dual<long double> moonSunElongation(JPLEphems &ephems, const jd_clock::time_point &jd);
+
+// the Moon and Sun seen from the geocentre at one instant, in the precision of policy P
+template <typename P>
+struct MoonSunGeometry {
+    typedef github::paulyc::real_t<P> real;
+    // geocentric equatorial J2000, AU; both from the Earth's centre
+    typename P::cartesian moonpos;
+    typename P::cartesian sunpos;
+    real moonR;
+    real sunR;
+    // radians; α is folded into [-π/2, π/2], so α_sun crosses zero at both
+    // equinoxes and turns around at the solstices, which is what minFinder brackets
+    real α_moon;
+    real δ_moon;
+    real α_sun;
+    real δ_sun;
+    real dα;
+    real elongation;
+    // chord between the two directions on the unit sphere
+    real sphDistance;
+};
+
+template <typename P>
+MoonSunGeometry<P> moonSunGeometry(const typename P::cartesian &moonpos, const typename P::cartesian &sunpos) {
+    typedef github::paulyc::real_t<P> real;
+    MoonSunGeometry<P> g;
+    g.moonpos = moonpos;
+    g.sunpos = sunpos;
+    g.moonR = moonpos.mag();
+    g.sunR = sunpos.mag();
+    auto radec = [](const typename P::cartesian &u, real &α, real &δ) {
+        const real ρ = mmm::sqrt(u.x() * u.x() + u.y() * u.y());
+        α = mmm::asin(u.y() / ρ);
+        δ = mmm::atan2(u.z(), ρ);
+    };
+    radec(moonpos, g.α_moon, g.δ_moon);
+    radec(sunpos, g.α_sun, g.δ_sun);
+    g.dα = g.α_moon - g.α_sun;
+    g.elongation = elongation(moonpos, sunpos);
+    g.sphDistance = P::xfrm::cart2sph(moonpos).normalDistance(P::xfrm::cart2sph(sunpos));
+    return g;
+}
+
+// the same from the ephemeris, Moon and Sun both relative to the Earth (the
+// Moon used to be taken from the Earth-Moon barycenter, same direction but
+// moonR ~4700 km short); the positions are doubles, so past double precision
+// the policy only changes how they're worked with
+template <typename P>
+MoonSunGeometry<P> moonSunGeometry(JPLEphems &ephems, const jd_clock::time_point &jd);
+
+template <typename P = github::paulyc::default_precision>
+github::paulyc::real_t<P> moonSunAngle(JPLEphems &ephems, const jd_clock::time_point &jd) {
+    return moonSunGeometry<P>(ephems, jd).elongation;
+}
+
 std::chrono::system_clock::time_point minFinder(JPLEphems &ephems, jd_clock::time_point &jd);
 
 #endif /* PAULYC_ASTRO_HPP */
@@ -24,37 +24,22 @@ namespace github {
 namespace paulyc {
 
 // identity
-fun_1d_t id_op(fun_1d_t fun, const long double delta=FLT128_EPSILON) {
-    return [fun, delta](long double x) -> long double {
-        return fun(x);
-    };
+fun_1d_t id_op(fun_1d_t fun, const long double delta) {
+    return id_op<default_precision>(std::move(fun), delta);
 }
 
 //derivative
-fun_1d_t d_op(fun_1d_t fun, const long double delta=FLT128_EPSILON) {
-    const long double _2_delta_m1 = 0.5q / delta;
-    return [fun, delta, _2_delta_m1](long double x) -> long double {
-        return _2_delta_m1 * (fun(x+delta) - fun(x-delta));
-    };
+fun_1d_t d_op(fun_1d_t fun, const long double delta) {
+    return d_op<default_precision>(std::move(fun), delta);
 }
 
 //2nd derivative
-fun_1d_t d2_op(fun_1d_t fun, const long double delta=FLT128_EPSILON) {
-    const long double _2_delta_m1 = 0.5q / delta;
-    return d_op(d_op(fun, delta), delta);
+fun_1d_t d2_op(fun_1d_t fun, const long double delta) {
+    return d2_op<default_precision>(std::move(fun), delta);
 }
 
-std::optional<long double> min_x(fun_1d_t fun, const long double range_min, const long double range_max, const long double delta=FLT128_EPSILON) {
-    auto d_fun = d_op(fun, delta);
-    auto d2_fun = d_op(fun, delta);
-    // find d_fun zero crossing
-    int d_fun_sign = signbitq(d_fun(range_min));
-    for (long double x = range_min; x < range_max; x += delta) {
-        if (d_fun_sign != signbitq(d_fun(x)) && signbitq(d2_fun(x)) > 0) {
-            return x;
-        }
-    }
-    return std::nullopt;
+std::optional<long double> min_x(fun_1d_t fun, const long double range_min, const long double range_max, const long double delta) {
+    return min_x<default_precision>(std::move(fun), range_min, range_max, delta);
 }
 
 }
@@ -25,9 +25,13 @@
 #include <optional>
 #include <cstdint>
 #include <cmath>
+#include <type_traits>
+#include <utility>
 
 #include "quadmath.h"
 #include "lalgebra.hpp"
+#include "precision.hpp"
+#include "solvers.hpp"
 
 namespace github {
 namespace paulyc {
@@ -37,6 +41,10 @@ typedef std::function<long double(long double, long double)> fun_2d_t;
 typedef std::function<long double(long double, long double, long double)> fun_3d_t;
 typedef std::function<long double(long double, long double, long double, long double)> fun_4d_t;
 
+// delta is the central difference step and has no default: about cbrt(ε)·|x| for
+// the first derivative and ε^(1/4)·|x| for the second balance rounding against
+// truncation, far above ε itself, where the difference is all rounding
+
 // identity
 fun_1d_t id_op(fun_1d_t fun, const long double delta);
 
@@ -46,8 +54,126 @@ fun_1d_t d_op(fun_1d_t fun, const long double delta);
 //2nd derivative
 fun_1d_t d2_op(fun_1d_t fun, const long double delta);
 
+// a minimum of fun inside (range_min, range_max) to within delta, by Brent's method;
+// nullopt if it doesn't converge or the smallest value is at either end of the range
 std::optional<long double> min_x(fun_1d_t fun, const long double range_min, const long double range_max, const long double delta);
 
+// The operators above in the precision of policy P, eg. d_op<double_precision>(f, 1e-6)
+// or min_x<quad_precision>(...); the untemplated ones are P = default_precision.
+
+template <typename P>
+typename P::fun_1d id_op(typename P::fun_1d fun, const real_t<P>) {
+    return fun;
+}
+
+template <typename P>
+typename P::fun_1d d_op(typename P::fun_1d fun, const real_t<P> delta);
+
+template <typename P>
+typename P::fun_1d d2_op(typename P::fun_1d fun, const real_t<P> delta);
+
+template <typename P>
+std::optional<real_t<P>> min_x(typename P::fun_1d fun, const real_t<P> range_min, const real_t<P> range_max, const real_t<P> delta) {
+    const SolverResult<real_t<P>> min = brent_min(fun, range_min, range_max, delta);
+    if (!min || min.x - range_min <= delta || range_max - min.x <= delta) {
+        return std::nullopt;
+    }
+    return min.x;
+}
+
+// The same operators as templates over any callable. d_op(d_op(f)) above is two
+// layers of std::function, four indirect calls per sample that the compiler can't
+// see through; make_d_op<2>(f, δ) over a lambda is a plain struct, so nested
+// operators and whatever solver calls them inline down to the stencil itself.
+
+template <typename F>
+struct id_op_t {
+    F fun;
+
+    template <typename T>
+    T operator()(T x) const {
+        return fun(x);
+    }
+};
+
+// N-th derivative by the central difference over the N+1 points x + (N - 2k)δ,
+// k = 0..N, divided by (2δ)^N. For N = 1 that's d_op; for N = 2 it's d_op(d_op)
+// with the repeated middle sample taken once. Error O(δ²) for every N.
+template <unsigned N, typename F, typename D>
+struct d_op_t {
+    static_assert(N > 0, "0th derivative is id_op_t");
+
+    F fun;
+    D delta;
+    D scale;
+
+    d_op_t(F f, D d) : fun(std::move(f)), delta(d), scale(D(1)) {
+        for (unsigned i = 0; i < N; ++i) {
+            scale /= D(2) * d;
+        }
+    }
+
+    template <typename T>
+    T operator()(T x) const {
+        return stencil(x, std::make_integer_sequence<unsigned, N + 1>()) * T(scale);
+    }
+
+private:
+    static constexpr long double coefficient(unsigned k) {
+        long double c = 1.0l;
+        for (unsigned i = 0; i < k; ++i) {
+            c = c * (N - i) / (i + 1);
+        }
+        return k % 2 ? -c : c;
+    }
+
+    template <typename T, unsigned ... K>
+    T stencil(T x, std::integer_sequence<unsigned, K...>) const {
+        return (T(0) + ... + (T(coefficient(K)) * fun(x + T(static_cast<int>(N) - 2 * static_cast<int>(K)) * T(delta))));
+    }
+};
+
+// Richardson extrapolation of d_op_t: (4 D(δ/2) - D(δ)) / 3 cancels the δ² term,
+// leaving O(δ⁴) for twice the samples, so a larger δ (less cancellation) can be
+// used for the same truncation error.
+template <unsigned N, typename F, typename D>
+struct richardson_op_t {
+    d_op_t<N, F, D> coarse;
+    d_op_t<N, F, D> fine;
+
+    richardson_op_t(F f, D d) : coarse(f, d), fine(std::move(f), d / D(2)) {}
+
+    template <typename T>
+    T operator()(T x) const {
+        return (T(4) * fine(x) - coarse(x)) / T(3);
+    }
+};
+
+template <typename F>
+id_op_t<std::decay_t<F>> make_id_op(F &&fun) {
+    return id_op_t<std::decay_t<F>> {std::forward<F>(fun)};
+}
+
+template <unsigned N = 1, typename F, typename D>
+d_op_t<N, std::decay_t<F>, D> make_d_op(F &&fun, D delta) {
+    return d_op_t<N, std::decay_t<F>, D>(std::forward<F>(fun), delta);
+}
+
+template <unsigned N = 1, typename F, typename D>
+richardson_op_t<N, std::decay_t<F>, D> make_richardson_op(F &&fun, D delta) {
+    return richardson_op_t<N, std::decay_t<F>, D>(std::forward<F>(fun), delta);
+}
+
+template <typename P>
+typename P::fun_1d d_op(typename P::fun_1d fun, const real_t<P> delta) {
+    return make_d_op<1>(std::move(fun), delta);
+}
+
+template <typename P>
+typename P::fun_1d d2_op(typename P::fun_1d fun, const real_t<P> delta) {
+    return make_d_op<2>(std::move(fun), delta);
+}
+
 } /* namespace paulyc */
 } /* namespace github */
 
@@ -0,0 +1,320 @@
+/**
+ * chebyshev.hpp
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#ifndef PAULYC_CHEBYSHEV_HPP
+#define PAULYC_CHEBYSHEV_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <vector>
+
+#include "solvers.hpp"
+
+namespace github {
+namespace paulyc {
+
+// A finite Chebyshev series f(x) = Σ c_k T_k(u) on [a, b], u = (2x - a - b) / (b - a).
+// Built by interpolating at the Chebyshev points of the first kind, so for a smooth
+// function the coefficients fall off geometrically and the size of the last few
+// says how good the fit is.
+template <typename T = double>
+class ChebyshevSeries
+{
+public:
+    ChebyshevSeries(T a, T b, std::vector<T> coefficients) :
+        _a(a), _b(b), _c(std::move(coefficients))
+    {
+        if (_c.empty()) {
+            _c.push_back(T(0));
+        }
+    }
+
+    // interpolate f at n Chebyshev points of [a, b]
+    template <typename F>
+    static ChebyshevSeries fit(F &&f, T a, T b, std::size_t n) {
+        if (n == 0) {
+            throw std::runtime_error("ChebyshevSeries::fit needs at least one point");
+        }
+        std::vector<T> fx(n);
+        for (std::size_t k = 0; k < n; ++k) {
+            const T u = std::cos(T(M_PI) * (T(k) + T(0.5)) / T(n));
+            fx[k] = f(T(0.5) * (b + a) + T(0.5) * (b - a) * u);
+        }
+        std::vector<T> c(n);
+        for (std::size_t j = 0; j < n; ++j) {
+            T sum = T(0);
+            for (std::size_t k = 0; k < n; ++k) {
+                sum += fx[k] * std::cos(T(M_PI) * T(j) * (T(k) + T(0.5)) / T(n));
+            }
+            c[j] = (j == 0 ? T(1) : T(2)) * sum / T(n);
+        }
+        return ChebyshevSeries(a, b, std::move(c));
+    }
+
+    T a() const { return _a; }
+    T b() const { return _b; }
+    std::size_t degree() const { return _c.size() - 1; }
+    const std::vector<T>& coefficients() const { return _c; }
+
+    // Clenshaw's recurrence; extrapolates outside [a, b], badly
+    T operator()(T x) const {
+        const T u = (T(2) * x - _a - _b) / (_b - _a);
+        T b1 = T(0), b2 = T(0);
+        for (std::size_t k = _c.size() - 1; k > 0; --k) {
+            const T b0 = _c[k] + T(2) * u * b1 - b2;
+            b2 = b1;
+            b1 = b0;
+        }
+        return _c[0] + u * b1 - b2;
+    }
+
+    // d/dx, one degree lower
+    ChebyshevSeries derivative() const {
+        const std::size_t n = _c.size();
+        if (n == 1) {
+            return ChebyshevSeries(_a, _b, {T(0)});
+        }
+        // a'_{k-1} = a'_{k+1} + 2k c_k on the series with c_0 doubled, then halve a'_0
+        std::vector<T> d(n + 1, T(0));
+        for (std::size_t k = n - 1; k > 0; --k) {
+            d[k - 1] = d[k + 1] + T(2) * T(k) * _c[k];
+        }
+        d[0] *= T(0.5);
+        d.resize(n - 1);
+        const T scale = T(2) / (_b - _a);
+        for (T &dk : d) {
+            dk *= scale;
+        }
+        return ChebyshevSeries(_a, _b, std::move(d));
+    }
+
+    // the antiderivative that is zero at a, one degree higher
+    ChebyshevSeries integral() const {
+        const std::size_t n = _c.size();
+        auto primed = [this, n](std::size_t k) {
+            return k >= n ? T(0) : (k == 0 ? T(2) * _c[0] : _c[k]);
+        };
+        const T scale = T(0.5) * (_b - _a);
+        std::vector<T> C(n + 1, T(0));
+        T at_a = T(0);
+        for (std::size_t k = 1; k <= n; ++k) {
+            C[k] = scale * (primed(k - 1) - primed(k + 1)) / (T(2) * T(k));
+            at_a += k % 2 ? -C[k] : C[k];
+        }
+        C[0] = -at_a;
+        return ChebyshevSeries(_a, _b, std::move(C));
+    }
+
+    // the same polynomial re-expanded on [lo, hi]
+    ChebyshevSeries restrict(T lo, T hi) const {
+        return fit(*this, lo, hi, _c.size());
+    }
+
+    // All roots in [a, b], ascending, each to within xtol. Recursive subdivision:
+    // an interval is dropped as soon as |c_0| > Σ|c_k| proves the series can't reach
+    // zero there, and once its derivative is bounded away from zero the same way it's
+    // monotone and any sign change is solved with Brent's method. A double root that
+    // never changes sign is only found if a subdivision point lands on it.
+    std::vector<T> roots(T xtol) const {
+        std::vector<T> out;
+        rootsIn(*this, xtol, 0, out);
+        std::sort(out.begin(), out.end());
+        out.erase(std::unique(out.begin(), out.end(), [xtol](T x, T y) { return std::fabs(x - y) <= xtol; }), out.end());
+        return out;
+    }
+
+private:
+    static constexpr int MAX_ROOT_DEPTH = 40;
+
+    static bool boundedAwayFromZero(const std::vector<T> &c) {
+        T tail = T(0);
+        for (std::size_t k = 1; k < c.size(); ++k) {
+            tail += std::fabs(c[k]);
+        }
+        return std::fabs(c[0]) > tail * (T(1) + T(64) * std::numeric_limits<T>::epsilon());
+    }
+
+    static void rootsIn(const ChebyshevSeries &s, T xtol, int depth, std::vector<T> &out) {
+        if (boundedAwayFromZero(s._c)) {
+            return;
+        }
+        const T fa = s(s._a), fb = s(s._b);
+        if (fa == T(0)) {
+            out.push_back(s._a);
+        }
+        if (fb == T(0)) {
+            out.push_back(s._b);
+        }
+        if (s.degree() <= 1 || depth >= MAX_ROOT_DEPTH || s._b - s._a <= xtol || boundedAwayFromZero(s.derivative()._c)) {
+            if ((fa < T(0)) != (fb < T(0)) && fa != T(0) && fb != T(0)) {
+                const SolverResult<T> root = brent_root(s, s._a, s._b, fa, fb, xtol);
+                out.push_back(root.x);
+            }
+            return;
+        }
+        const T m = T(0.5) * (s._a + s._b);
+        rootsIn(s.restrict(s._a, m), xtol, depth + 1, out);
+        rootsIn(s.restrict(m, s._b), xtol, depth + 1, out);
+    }
+
+    T _a;
+    T _b;
+    std::vector<T> _c;
+};
+
+// A piecewise Chebyshev approximation of f on [a, b] to an absolute tolerance.
+// Each piece is fitted at `degree + 1` points; when the last few coefficients
+// aren't below the tolerance the piece is split in half and each half fitted
+// again, so the expensive function is sampled only where it needs to be and the
+// result is then evaluated, differentiated, integrated or searched for roots as
+// often as needed for the price of a few multiply-adds.
+template <typename T = double>
+class ChebyshevApproximation
+{
+public:
+    static constexpr std::size_t DEFAULT_DEGREE = 24;
+    static constexpr int MAX_DEPTH = 30;
+
+    template <typename F>
+    ChebyshevApproximation(F &&f, T a, T b, T tol, std::size_t degree = DEFAULT_DEGREE) :
+        _evaluations(0), _converged(true)
+    {
+        if (!(b > a)) {
+            throw std::runtime_error("ChebyshevApproximation needs a < b");
+        }
+        build(f, a, b, tol, degree, 0);
+        _integral = antiderivative(_pieces);
+    }
+
+    T a() const { return _pieces.front().a(); }
+    T b() const { return _pieces.back().b(); }
+    const std::vector<ChebyshevSeries<T>>& pieces() const { return _pieces; }
+    // how many times the fit called f
+    std::size_t evaluations() const { return _evaluations; }
+    // false if some piece hit MAX_DEPTH before meeting the tolerance
+    bool converged() const { return _converged; }
+
+    T operator()(T x) const {
+        return piece(x)(x);
+    }
+
+    ChebyshevApproximation derivative() const {
+        ChebyshevApproximation d(*this);
+        for (ChebyshevSeries<T> &s : d._pieces) {
+            s = s.derivative();
+        }
+        d._integral = antiderivative(d._pieces);
+        return d;
+    }
+
+    // the antiderivative that is zero at a(), continuous across pieces
+    ChebyshevApproximation integral() const {
+        ChebyshevApproximation in(*this);
+        in._pieces = _integral;
+        in._integral = antiderivative(in._pieces);
+        return in;
+    }
+
+    // ∫ f from x0 to x1 inside [a, b], off the antiderivative built with the fit
+    T integrate(T x0, T x1) const {
+        return pieceOf(_integral, x1)(x1) - pieceOf(_integral, x0)(x0);
+    }
+
+    std::vector<T> roots(T xtol) const {
+        std::vector<T> out;
+        for (const ChebyshevSeries<T> &s : _pieces) {
+            const std::vector<T> r = s.roots(xtol);
+            for (T x : r) {
+                // a root on a shared endpoint turns up in both pieces
+                if (out.empty() || x - out.back() > xtol) {
+                    out.push_back(x);
+                }
+            }
+        }
+        return out;
+    }
+
+private:
+    template <typename F>
+    void build(F &f, T a, T b, T tol, std::size_t degree, int depth) {
+        auto counted = [this, &f](T x) {
+            ++_evaluations;
+            return f(x);
+        };
+        ChebyshevSeries<T> s = ChebyshevSeries<T>::fit(counted, a, b, degree + 1);
+        const std::vector<T> &c = s.coefficients();
+        T tail = T(0);
+        for (std::size_t k = c.size() - std::min<std::size_t>(3, c.size()); k < c.size(); ++k) {
+            tail = std::max(tail, std::fabs(c[k]));
+        }
+        if (tail > tol && depth < MAX_DEPTH) {
+            const T m = T(0.5) * (a + b);
+            build(f, a, m, tol, degree, depth + 1);
+            build(f, m, b, tol, degree, depth + 1);
+            return;
+        }
+        _converged = _converged && tail <= tol;
+        // drop trailing terms that together stay under a tenth of the tolerance
+        std::vector<T> trimmed(c);
+        T dropped = T(0);
+        while (trimmed.size() > 1 && dropped + std::fabs(trimmed.back()) <= T(0.1) * tol) {
+            dropped += std::fabs(trimmed.back());
+            trimmed.pop_back();
+        }
+        _pieces.emplace_back(a, b, std::move(trimmed));
+    }
+
+    static std::vector<ChebyshevSeries<T>> antiderivative(const std::vector<ChebyshevSeries<T>> &pieces) {
+        std::vector<ChebyshevSeries<T>> out;
+        out.reserve(pieces.size());
+        T offset = T(0);
+        for (const ChebyshevSeries<T> &s : pieces) {
+            std::vector<T> c = s.integral().coefficients();
+            c[0] += offset;
+            out.emplace_back(s.a(), s.b(), std::move(c));
+            offset = out.back()(s.b());
+        }
+        return out;
+    }
+
+    static const ChebyshevSeries<T>& pieceOf(const std::vector<ChebyshevSeries<T>> &pieces, T x) {
+        auto it = std::upper_bound(pieces.begin(), pieces.end(), x, [](T v, const ChebyshevSeries<T> &s) {
+            return v < s.b();
+        });
+        return it == pieces.end() ? pieces.back() : *it;
+    }
+
+    const ChebyshevSeries<T>& piece(T x) const {
+        return pieceOf(_pieces, x);
+    }
+
+    std::vector<ChebyshevSeries<T>> _pieces;
+    // the antiderivative, zero at a(); integrate() reads it without allocating
+    std::vector<ChebyshevSeries<T>> _integral;
+    std::size_t _evaluations;
+    bool _converged;
+};
+
+} /* namespace paulyc */
+} /* namespace github */
+
+#endif /* PAULYC_CHEBYSHEV_HPP */
@@ -0,0 +1,444 @@
+/**
+ * ddouble.hpp
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#ifndef PAULYC_DDOUBLE_HPP
+#define PAULYC_DDOUBLE_HPP
+
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <ostream>
+#include <type_traits>
+
+#include "quadmath.h"
+#include "mmm.hpp"
+
+/*
+ * Double-double: the unevaluated sum hi + lo of two doubles, |lo| <= ulp(hi)/2,
+ * for 106 bits of mantissa (about 32 digits) over double's exponent range.
+ * Everything is built from the error-free transformations two_sum and two_prod
+ * (Dekker, Knuth; the algorithms are those of Hida, Li and Bailey's QD library),
+ * so each operation is a few to a few dozen plain double operations instead of
+ * a call into libquadmath's software binary128.
+ *
+ * It relies on IEEE double rounding of every operation as written: don't build
+ * it with -ffast-math or for x87.
+ */
+namespace mmm {
+
+namespace ddouble_detail {
+
+// s + e = a + b exactly, given |a| >= |b|
+constexpr double quick_two_sum(double a, double b, double &e) {
+    const double s = a + b;
+    e = b - (s - a);
+    return s;
+}
+
+// s + e = a + b exactly
+constexpr double two_sum(double a, double b, double &e) {
+    const double s = a + b;
+    const double bb = s - a;
+    e = (a - (s - bb)) + (b - bb);
+    return s;
+}
+
+// p + e = a b exactly
+constexpr double two_prod(double a, double b, double &e) {
+    const double p = a * b;
+#ifdef __FMA__
+    e = __builtin_fma(a, b, -p);
+#else
+    // Dekker's product: split each factor into halves whose products are exact
+    constexpr double SPLIT = 134217729.0; // 2^27 + 1
+    const double ta = SPLIT * a, ah = ta - (ta - a), al = a - ah;
+    const double tb = SPLIT * b, bh = tb - (tb - b), bl = b - bh;
+    e = ((ah * bh - p) + ah * bl + al * bh) + al * bl;
+#endif
+    return p;
+}
+
+}
+
+struct ddouble
+{
+    double hi;
+    double lo;
+
+    constexpr ddouble() : hi(0.0), lo(0.0) {}
+    constexpr ddouble(double x) : hi(x), lo(0.0) {}
+    // exact: the 64 bit long double mantissa fits in two doubles
+    constexpr ddouble(long double x) : hi(static_cast<double>(x)), lo(x - x == 0 ? static_cast<double>(x - static_cast<double>(x)) : 0.0) {}
+    // rounded to 106 bits
+    constexpr ddouble(__float128 x) : hi(static_cast<double>(x)), lo(x - x == 0 ? static_cast<double>(x - static_cast<double>(x)) : 0.0) {}
+    template <typename I, typename = std::enable_if_t<std::is_integral_v<I>>>
+    constexpr ddouble(I n) : ddouble(static_cast<long double>(n)) {}
+    // the parts as given, which must already be normalized
+    constexpr ddouble(double h, double l) : hi(h), lo(l) {}
+
+    explicit constexpr operator double() const { return hi + lo; }
+    explicit constexpr operator long double() const { return static_cast<long double>(hi) + lo; }
+    explicit constexpr operator __float128() const { return static_cast<__float128>(hi) + lo; }
+};
+
+template <typename S>
+using if_ddouble_scalar_t = std::enable_if_t<is_scalar_v<S>, ddouble>;
+
+// arithmetic
+
+constexpr ddouble operator-(const ddouble &a) {
+    return ddouble(-a.hi, -a.lo);
+}
+
+constexpr ddouble operator+(const ddouble &a, const ddouble &b) {
+    using namespace ddouble_detail;
+    double s2 = 0.0, t2 = 0.0;
+    double s1 = two_sum(a.hi, b.hi, s2);
+    const double t1 = two_sum(a.lo, b.lo, t2);
+    s2 += t1;
+    s1 = quick_two_sum(s1, s2, s2);
+    s2 += t2;
+    s1 = quick_two_sum(s1, s2, s2);
+    return ddouble(s1, s2);
+}
+
+constexpr ddouble operator+(const ddouble &a, double b) {
+    using namespace ddouble_detail;
+    double e = 0.0;
+    const double s = two_sum(a.hi, b, e);
+    e += a.lo;
+    const double h = quick_two_sum(s, e, e);
+    return ddouble(h, e);
+}
+
+constexpr ddouble operator+(double a, const ddouble &b) {
+    return b + a;
+}
+
+constexpr ddouble operator-(const ddouble &a, const ddouble &b) {
+    return a + -b;
+}
+
+constexpr ddouble operator-(const ddouble &a, double b) {
+    return a + -b;
+}
+
+constexpr ddouble operator-(double a, const ddouble &b) {
+    return -b + a;
+}
+
+constexpr ddouble operator*(const ddouble &a, const ddouble &b) {
+    using namespace ddouble_detail;
+    double e = 0.0;
+    const double p = two_prod(a.hi, b.hi, e);
+    e += a.hi * b.lo + a.lo * b.hi;
+    const double h = quick_two_sum(p, e, e);
+    return ddouble(h, e);
+}
+
+constexpr ddouble operator*(const ddouble &a, double b) {
+    using namespace ddouble_detail;
+    double e = 0.0;
+    const double p = two_prod(a.hi, b, e);
+    e += a.lo * b;
+    const double h = quick_two_sum(p, e, e);
+    return ddouble(h, e);
+}
+
+constexpr ddouble operator*(double a, const ddouble &b) {
+    return b * a;
+}
+
+// long division, three quotient digits
+constexpr ddouble operator/(const ddouble &a, const ddouble &b) {
+    using namespace ddouble_detail;
+    const double q1 = a.hi / b.hi;
+    ddouble r = a - b * q1;
+    const double q2 = r.hi / b.hi;
+    r = r - b * q2;
+    const double q3 = r.hi / b.hi;
+    double e = 0.0;
+    const double h = quick_two_sum(q1, q2, e);
+    return ddouble(h, e) + q3;
+}
+
+constexpr ddouble operator/(const ddouble &a, double b) {
+    using namespace ddouble_detail;
+    const double q1 = a.hi / b;
+    double p2 = 0.0, e = 0.0;
+    const double p1 = two_prod(q1, b, p2);
+    const double s = two_sum(a.hi, -p1, e);
+    e -= p2;
+    e += a.lo;
+    const double q2 = (s + e) / b;
+    const double h = quick_two_sum(q1, q2, e);
+    return ddouble(h, e);
+}
+
+constexpr ddouble operator/(double a, const ddouble &b) {
+    return ddouble(a) / b;
+}
+
+// with the other scalars, converted first
+
+template <typename S> constexpr if_ddouble_scalar_t<S> operator+(const ddouble &a, S b) { return a + ddouble(b); }
+template <typename S> constexpr if_ddouble_scalar_t<S> operator+(S a, const ddouble &b) { return ddouble(a) + b; }
+template <typename S> constexpr if_ddouble_scalar_t<S> operator-(const ddouble &a, S b) { return a - ddouble(b); }
+template <typename S> constexpr if_ddouble_scalar_t<S> operator-(S a, const ddouble &b) { return ddouble(a) - b; }
+template <typename S> constexpr if_ddouble_scalar_t<S> operator*(const ddouble &a, S b) { return a * ddouble(b); }
+template <typename S> constexpr if_ddouble_scalar_t<S> operator*(S a, const ddouble &b) { return ddouble(a) * b; }
+template <typename S> constexpr if_ddouble_scalar_t<S> operator/(const ddouble &a, S b) { return a / ddouble(b); }
+template <typename S> constexpr if_ddouble_scalar_t<S> operator/(S a, const ddouble &b) { return ddouble(a) / b; }
+
+constexpr ddouble &operator+=(ddouble &a, const ddouble &b) { return a = a + b; }
+constexpr ddouble &operator-=(ddouble &a, const ddouble &b) { return a = a - b; }
+constexpr ddouble &operator*=(ddouble &a, const ddouble &b) { return a = a * b; }
+constexpr ddouble &operator/=(ddouble &a, const ddouble &b) { return a = a / b; }
+
+// comparisons, lexicographic on the normalized parts
+
+constexpr bool operator==(const ddouble &a, const ddouble &b) { return a.hi == b.hi && a.lo == b.lo; }
+constexpr bool operator!=(const ddouble &a, const ddouble &b) { return !(a == b); }
+constexpr bool operator<(const ddouble &a, const ddouble &b) { return a.hi < b.hi || (a.hi == b.hi && a.lo < b.lo); }
+constexpr bool operator>(const ddouble &a, const ddouble &b) { return b < a; }
+constexpr bool operator<=(const ddouble &a, const ddouble &b) { return a.hi < b.hi || (a.hi == b.hi && a.lo <= b.lo); }
+constexpr bool operator>=(const ddouble &a, const ddouble &b) { return b <= a; }
+
+#define MMM_DDOUBLE_COMPARISON(op) \
+    template <typename S> constexpr std::enable_if_t<is_scalar_v<S>, bool> operator op(const ddouble &a, S b) { return a op ddouble(b); } \
+    template <typename S> constexpr std::enable_if_t<is_scalar_v<S>, bool> operator op(S a, const ddouble &b) { return ddouble(a) op b; }
+
+MMM_DDOUBLE_COMPARISON(<)
+MMM_DDOUBLE_COMPARISON(>)
+MMM_DDOUBLE_COMPARISON(<=)
+MMM_DDOUBLE_COMPARISON(>=)
+MMM_DDOUBLE_COMPARISON(==)
+MMM_DDOUBLE_COMPARISON(!=)
+
+#undef MMM_DDOUBLE_COMPARISON
+
+namespace ddouble_detail {
+
+// π/2 in three parts, for reducing arguments
+constexpr double PIO2_1 = 0x1.921fb54442d18p+0;
+constexpr double PIO2_2 = 0x1.1a62633145c07p-54;
+constexpr double PIO2_3 = -0x1.f1976b7ed8fbcp-110;
+
+// Taylor coefficients (-1)^k / (2k+1)! and (-1)^k / (2k)!, enough terms that
+// the first one dropped is below 2^-106 for |t| <= π/4
+struct taylor_coefficients {
+    static constexpr int SIN_TERMS = 14;
+    static constexpr int COS_TERMS = 15;
+    ddouble sin[SIN_TERMS];
+    ddouble cos[COS_TERMS];
+
+    constexpr taylor_coefficients() : sin(), cos() {
+        __float128 f = 1;
+        for (int n = 0; n <= 2 * (COS_TERMS - 1); ++n) {
+            if (n > 0) {
+                f /= n;
+            }
+            const __float128 c = (n / 2) % 2 ? -f : f;
+            if (n % 2) {
+                sin[n / 2] = ddouble(c);
+            } else {
+                cos[n / 2] = ddouble(c);
+            }
+        }
+    }
+};
+
+inline constexpr taylor_coefficients TAYLOR {};
+
+// Horner in t² over c, in double from term `split` on, where the terms are
+// below 2^-53 of the sum for |t| <= π/4, and in double-double for the rest
+template <int N>
+inline ddouble horner(const ddouble (&c)[N], int split, const ddouble &t2) {
+    double tail = c[N - 1].hi;
+    for (int k = N - 2; k >= split; --k) {
+        tail = tail * t2.hi + c[k].hi;
+    }
+    ddouble p(tail);
+    for (int k = split - 1; k >= 0; --k) {
+        p = p * t2 + c[k];
+    }
+    return p;
+}
+
+// sin t and cos t for |t| <= π/4
+inline ddouble sin_reduced(const ddouble &t) {
+    return horner(TAYLOR.sin, 8, t * t) * t;
+}
+
+inline ddouble cos_reduced(const ddouble &t) {
+    return horner(TAYLOR.cos, 9, t * t);
+}
+
+// x = j π/2 + t, |t| <= π/4 (a little over, from rounding j), returning j mod 4.
+// Cody-Waite with π/2 to 159 bits, so t keeps full precision while
+// |j| is well under 2^53; the absolute error is about |x| 2^-159.
+inline int reduce(const ddouble &x, ddouble &t) {
+    const double j = std::nearbyint(x.hi * 0x1.45f306dc9c883p-1);
+    double e = 0.0;
+    const double p = two_prod(j, PIO2_1, e);
+    t = ((x - ddouble(p, e)) - ddouble(j) * PIO2_2) - ddouble(j) * PIO2_3;
+    return static_cast<int>(static_cast<long long>(std::fmod(j, 4.0))) & 3;
+}
+
+}
+
+// functions
+
+inline ddouble fabs(const ddouble &a) {
+    return a.hi < 0.0 ? -a : a;
+}
+
+inline ddouble floor(const ddouble &a) {
+    double hi = std::floor(a.hi), lo = 0.0;
+    if (hi == a.hi) {
+        lo = std::floor(a.lo);
+        hi = ddouble_detail::quick_two_sum(hi, lo, lo);
+    }
+    return ddouble(hi, lo);
+}
+
+inline ddouble fmod(const ddouble &a, const ddouble &b) {
+    const ddouble q = a / b;
+    return a - b * (q.hi < 0.0 ? -floor(-q) : floor(q));
+}
+
+// one Newton step on the double square root (Karp's trick)
+inline ddouble sqrt(const ddouble &a) {
+    if (!(a.hi > 0.0)) {
+        return ddouble(std::sqrt(a.hi));
+    }
+    const double x = 1.0 / std::sqrt(a.hi);
+    const double ax = a.hi * x;
+    double e = 0.0;
+    const double s = ddouble_detail::two_prod(ax, ax, e);
+    const double correction = (a - ddouble(s, e)).hi * (x * 0.5);
+    const double h = ddouble_detail::two_sum(ax, correction, e);
+    return ddouble(h, e);
+}
+
+inline void sincos(const ddouble &x, ddouble &s, ddouble &c) {
+    ddouble t;
+    const int quadrant = ddouble_detail::reduce(x, t);
+    const ddouble st = ddouble_detail::sin_reduced(t), ct = ddouble_detail::cos_reduced(t);
+    switch (quadrant) {
+    case 0: s = st; c = ct; break;
+    case 1: s = ct; c = -st; break;
+    case 2: s = -st; c = -ct; break;
+    default: s = -ct; c = st; break;
+    }
+}
+
+// only the one series each needs
+inline ddouble sin(const ddouble &x) {
+    ddouble t;
+    const int quadrant = ddouble_detail::reduce(x, t);
+    const ddouble r = quadrant % 2 ? ddouble_detail::cos_reduced(t) : ddouble_detail::sin_reduced(t);
+    return quadrant < 2 ? r : -r;
+}
+
+inline ddouble cos(const ddouble &x) {
+    ddouble t;
+    const int quadrant = ddouble_detail::reduce(x, t);
+    const ddouble r = quadrant % 2 ? ddouble_detail::sin_reduced(t) : ddouble_detail::cos_reduced(t);
+    return quadrant == 0 || quadrant == 3 ? r : -r;
+}
+
+inline ddouble tan(const ddouble &x) {
+    ddouble s, c;
+    sincos(x, s, c);
+    return s / c;
+}
+
+// the double atan2 z, corrected: tan(θ - z) = (y cos z - x sin z) / (x cos z + y sin z),
+// and θ - z is so small (an ulp of z) that it equals its tangent to 2^-106 and only
+// the numerator has to be formed in double-double
+inline ddouble atan2(const ddouble &y, const ddouble &x) {
+    static constexpr ddouble PI = ddouble(0x1.921fb54442d18p+1, 0x1.1a62633145c07p-53);
+    // infinities and NaNs would poison the correction; the double answer is all there is
+    if (!std::isfinite(x.hi) || !std::isfinite(y.hi)) {
+        return ddouble(std::atan2(y.hi, x.hi));
+    }
+    if (x.hi == 0.0 && y.hi == 0.0) {
+        return std::signbit(x.hi) ? (std::signbit(y.hi) ? -PI : PI) : y;
+    }
+    if (y.hi == 0.0) {
+        return x.hi > 0.0 ? y : (std::signbit(y.hi) ? -PI : PI);
+    }
+    if (x.hi == 0.0) {
+        return y.hi > 0.0 ? PI / 2.0 : -PI / 2.0;
+    }
+    const double z = std::atan2(y.hi, x.hi);
+    ddouble s, c;
+    sincos(ddouble(z), s, c);
+    const ddouble num = y * c - x * s;
+    const double den = x.hi * c.hi + y.hi * s.hi;
+    return ddouble(z) + num.hi / den;
+}
+
+inline ddouble atan(const ddouble &a) {
+    return atan2(a, ddouble(1.0));
+}
+
+inline ddouble asin(const ddouble &a) {
+    return atan2(a, sqrt((1.0 - a) * (1.0 + a)));
+}
+
+inline ddouble acos(const ddouble &a) {
+    return atan2(sqrt((1.0 - a) * (1.0 + a)), a);
+}
+
+// to long double's 64 bits, honouring the stream's format flags
+inline std::ostream &operator<<(std::ostream &os, const ddouble &x) {
+    return os << static_cast<long double>(x);
+}
+
+}
+
+template <>
+struct std::numeric_limits<mmm::ddouble> {
+    static constexpr bool is_specialized = true;
+    static constexpr bool is_signed = true;
+    static constexpr bool is_integer = false;
+    static constexpr bool is_exact = false;
+    static constexpr bool has_infinity = true;
+    static constexpr bool has_quiet_NaN = true;
+    static constexpr int radix = 2;
+    static constexpr int digits = 106;
+    static constexpr int digits10 = 31;
+    static constexpr int max_digits10 = 33;
+    // lo has to stay normal for the full 106 bits
+    static constexpr mmm::ddouble min() noexcept { return mmm::ddouble(0x1p-969); }
+    static constexpr mmm::ddouble max() noexcept { return mmm::ddouble(0x1.fffffffffffffp+1023, 0x1.fffffffffffffp+969); }
+    static constexpr mmm::ddouble lowest() noexcept { return -max(); }
+    static constexpr mmm::ddouble epsilon() noexcept { return mmm::ddouble(0x1p-104); }
+    static constexpr mmm::ddouble infinity() noexcept { return mmm::ddouble(std::numeric_limits<double>::infinity()); }
+    static constexpr mmm::ddouble quiet_NaN() noexcept { return mmm::ddouble(std::numeric_limits<double>::quiet_NaN()); }
+};
+
+// so std::chrono::duration<mmm::ddouble> converts like the floating point durations
+template <>
+struct std::chrono::treat_as_floating_point<mmm::ddouble> : std::true_type {};
+
+#endif /* PAULYC_DDOUBLE_HPP */
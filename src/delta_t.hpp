@@ -0,0 +1,162 @@
+/**
+ * delta_t.hpp
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#ifndef PAULYC_DELTA_T_HPP
+#define PAULYC_DELTA_T_HPP
+
+#include <algorithm>
+#include <array>
+#include <span>
+#include <stdexcept>
+
+/*
+ * ΔT = TT - UT1 in seconds.
+ *
+ * The model is Espenak & Meeus' piecewise polynomials (NASA Five Millennium Canon
+ * of Solar Eclipses, 2006) over -500..2150, and Morrison & Stephenson's long-term
+ * parabola -20 + 32u² outside that, which is what Espenak & Meeus use there too.
+ *
+ * Picking the right one of fourteen polynomials is a chain of data dependent
+ * branches, so instead the polynomials are tabulated once a year at compile time
+ * and evaluated with a Catmull-Rom cubic through the four surrounding years; the
+ * index is clamped rather than tested and the parabola is blended in with a
+ * select, so a lookup is a handful of loads and multiplies whatever the date.
+ * Away from the joins between polynomials the table reproduces them to ~0.01s,
+ * far inside their own uncertainty.
+ */
+struct delta_t
+{
+    static constexpr int FIRST_YEAR = -500;
+    static constexpr int LAST_YEAR = 2150;
+    static constexpr std::size_t TABLE_SIZE = LAST_YEAR - FIRST_YEAR + 1;
+
+    // Morrison & Stephenson (2004), for the distant past and future
+    static constexpr double long_term(double year) {
+        const double u = (year - 1820.0) / 100.0;
+        return -20.0 + 32.0 * u * u;
+    }
+
+    // Espenak & Meeus, year as a decimal year
+    static constexpr double polynomial(double y) {
+        if (y < -500.0) {
+            return long_term(y);
+        } else if (y < 500.0) {
+            const double u = y / 100.0;
+            return 10583.6 + u * (-1014.41 + u * (33.78311 + u * (-5.952053 + u * (-0.1798452 + u * (0.022174192 + u * 0.0090316521)))));
+        } else if (y < 1600.0) {
+            const double u = (y - 1000.0) / 100.0;
+            return 1574.2 + u * (-556.01 + u * (71.23472 + u * (0.319781 + u * (-0.8503463 + u * (-0.005050998 + u * 0.0083572073)))));
+        } else if (y < 1700.0) {
+            const double t = y - 1600.0;
+            return 120.0 + t * (-0.9808 + t * (-0.01532 + t / 7129.0));
+        } else if (y < 1800.0) {
+            const double t = y - 1700.0;
+            return 8.83 + t * (0.1603 + t * (-0.0059285 + t * (0.00013336 - t / 1174000.0)));
+        } else if (y < 1860.0) {
+            const double t = y - 1800.0;
+            return 13.72 + t * (-0.332447 + t * (0.0068612 + t * (0.0041116 + t * (-0.00037436 + t * (0.0000121272 + t * (-0.0000001699 + t * 0.000000000875))))));
+        } else if (y < 1900.0) {
+            const double t = y - 1860.0;
+            return 7.62 + t * (0.5737 + t * (-0.251754 + t * (0.01680668 + t * (-0.0004473624 + t / 233174.0))));
+        } else if (y < 1920.0) {
+            const double t = y - 1900.0;
+            return -2.79 + t * (1.494119 + t * (-0.0598939 + t * (0.0061966 + t * -0.000197)));
+        } else if (y < 1941.0) {
+            const double t = y - 1920.0;
+            return 21.20 + t * (0.84493 + t * (-0.076100 + t * 0.0020936));
+        } else if (y < 1961.0) {
+            const double t = y - 1950.0;
+            return 29.07 + t * (0.407 + t * (-1.0 / 233.0 + t / 2547.0));
+        } else if (y < 1986.0) {
+            const double t = y - 1975.0;
+            return 45.45 + t * (1.067 + t * (-1.0 / 260.0 - t / 718.0));
+        } else if (y < 2005.0) {
+            const double t = y - 2000.0;
+            return 63.86 + t * (0.3345 + t * (-0.060374 + t * (0.0017275 + t * (0.000651814 + t * 0.00002373599))));
+        } else if (y < 2050.0) {
+            const double t = y - 2000.0;
+            return 62.92 + t * (0.32217 + t * 0.005589);
+        } else if (y < 2150.0) {
+            return long_term(y) - 0.5628 * (2150.0 - y);
+        } else {
+            return long_term(y);
+        }
+    }
+
+    // polynomial() at each whole year FIRST_YEAR..LAST_YEAR, built at compile time,
+    // with a quadratically extrapolated year either side so the end intervals
+    // have the four points the spline needs
+    static const std::array<double, TABLE_SIZE + 2> TABLE;
+
+    // ΔT in seconds at a decimal year
+    static double seconds(double year) {
+        constexpr long last = static_cast<long>(TABLE_SIZE) - 1;
+        const double x = year - FIRST_YEAR;
+        const double xc = std::min(std::max(x, 0.0), static_cast<double>(last));
+        const long i = std::min(static_cast<long>(xc), last - 1);
+        const double t = xc - static_cast<double>(i);
+        const double p0 = TABLE[i];
+        const double p1 = TABLE[i + 1];
+        const double p2 = TABLE[i + 2];
+        const double p3 = TABLE[i + 3];
+        const double spline = p1 + 0.5 * t * ((p2 - p0) + t * ((2.0 * p0 - 5.0 * p1 + 4.0 * p2 - p3) + t * (3.0 * (p1 - p2) + p3 - p0)));
+        return (x >= 0.0 && x <= static_cast<double>(last)) ? spline : long_term(year);
+    }
+
+    // decimal year of a julian date, good enough for ΔT
+    static constexpr double year(double jd) {
+        return 2000.0 + (jd - 2451545.0) / 365.25;
+    }
+
+    static double seconds_at_jd(double jd) {
+        return seconds(year(jd));
+    }
+
+    // batched, for scans converting many epochs at once
+    static void seconds(std::span<const double> years, std::span<double> out) {
+        if (out.size() < years.size()) {
+            throw std::runtime_error("delta_t::seconds output span too small");
+        }
+        for (std::size_t i = 0; i < years.size(); ++i) {
+            out[i] = seconds(years[i]);
+        }
+    }
+
+    static void seconds_at_jd(std::span<const double> jds, std::span<double> out) {
+        if (out.size() < jds.size()) {
+            throw std::runtime_error("delta_t::seconds_at_jd output span too small");
+        }
+        for (std::size_t i = 0; i < jds.size(); ++i) {
+            out[i] = seconds(year(jds[i]));
+        }
+    }
+};
+
+inline constexpr std::array<double, delta_t::TABLE_SIZE + 2> delta_t::TABLE = []() {
+    std::array<double, TABLE_SIZE + 2> table {};
+    for (std::size_t i = 0; i < TABLE_SIZE; ++i) {
+        table[i + 1] = polynomial(static_cast<double>(FIRST_YEAR) + static_cast<double>(i));
+    }
+    table[0] = 3.0 * (table[1] - table[2]) + table[3];
+    table[TABLE_SIZE + 1] = 3.0 * (table[TABLE_SIZE] - table[TABLE_SIZE - 1]) + table[TABLE_SIZE - 2];
+    return table;
+}();
+
+#endif /* PAULYC_DELTA_T_HPP */
@@ -21,12 +21,17 @@
 #ifndef PAULYC_EPHEMSHELPER_HPP
 #define PAULYC_EPHEMSHELPER_HPP
 
+#include <array>
 #include <cstdint>
+#include <functional>
+#include <span>
+#include <string>
 
 #include "jpl_int.h"
 #include "jpleph.h"
 #include "lalgebra.hpp"
 #include "jd_clock.hpp"
+#include "split_jd_clock.hpp"
 
 class JPLEphems
 {
@@ -82,6 +87,10 @@ public:
             return static_cast<long double>(pv[3]);
         }
     };
+    // barycentric state of a point at a TDB julian date in au and au/day, or for
+    // Nutations {Δψ, Δε, dΔψ/dt, dΔε/dt} in radians and radians per day
+    typedef std::function<void(double, Point, double *)> source_fun;
+
     JPLEphems() : _ephdata(nullptr) {}
     ~JPLEphems()
     {
@@ -93,23 +102,111 @@ public:
 
     void init(const std::string &filename)
     {
+        _filename = filename;
         _ephdata = static_cast<jpl_eph_data*>(jpl_init_ephemeris(filename.c_str(), _names, _values));
         if (_ephdata == nullptr) {
             throw std::runtime_error("jpl_init_ephemeris returned code %d"_fmt.format(jpl_init_error_code()));
         }
     }
-    bool initialized() const { return _ephdata != nullptr; }
-    State get_state(double jdt, Point center, Point ref)
+    // states from a function instead of a file, so the searches can be tried
+    // against a made-up sky; `name` stands in for the filename
+    void init(const std::string &name, source_fun source, double au_km)
     {
-        State result;
-		if (!initialized()) {
-			throw std::runtime_error("try calling JPLEphems::init() first");
-		}
-        int res = jpl_pleph(_ephdata, jdt, ref, center, result.pv, 0);
+        _filename = name;
+        _source = std::move(source);
+        _au_km = au_km;
+    }
+    bool initialized() const { return _ephdata != nullptr || _source; }
+    // the ephemeris handle caches records so it can't be shared between threads,
+    // parallel searches open their own JPLEphems from this
+    const std::string& filename() const { return _filename; }
+    // kilometers per au as defined by the ephemeris, get_state() positions are in au and au/day
+    double au_km() const
+    {
+        if (!initialized()) {
+            throw std::runtime_error("try calling JPLEphems::init() first");
+        } else if (_source) {
+            return _au_km;
+        }
+        return jpl_get_double(_ephdata, JPL_EPHEM_AU_IN_KM);
+    }
+    // velocity is only interpolated (pv[3..5]) when asked for, it roughly doubles the cost
+    State get_state(double jdt, Point center, Point ref, bool velocity = false)
+    {
+        const double et2[2] = {jdt, 0.0};
+        return get_state(et2, center, ref, velocity);
+    }
+
+    // the day and the fraction go to the reader separately, so the epoch keeps
+    // its nanoseconds where a double julian date rounds to ~40µs
+    State get_state(const split_jd_clock::time_point &jdt, Point center, Point ref, bool velocity = false)
+    {
+        return get_state(jdt.epoch().data(), center, ref, velocity);
+    }
+
+    // Batch path: geocentric Moon and Sun for n epochs with one jpl_state() pass per epoch.
+    // Two get_state() calls would interpolate the Earth-Moon barycenter and the Moon twice
+    // over, and ascending epochs keep hitting the record already in the cache.
+    void get_moon_sun(const double *jdts, std::size_t n, State *moon, State *sun, bool velocity = false)
+    {
+        get_moon_sun(n, [jdts](std::size_t i) { return std::array<double, 2> {jdts[i], 0.0}; }, moon, sun, velocity);
+    }
+
+    void get_moon_sun(std::span<const split_jd_clock::time_point> jdts, State *moon, State *sun, bool velocity = false)
+    {
+        get_moon_sun(jdts.size(), [jdts](std::size_t i) { return jdts[i].epoch(); }, moon, sun, velocity);
+    }
+
+    // Geocentric states of several bodies (planets, Moon, Sun) at one epoch from a single
+    // jpl_state() pass, so a search over many bodies interpolates each of them, and the
+    // Earth, once per epoch instead of once per get_state() call.
+    void get_geocentric(double jdt, const Point *bodies, std::size_t n, State *out, bool velocity = false)
+    {
+        if (!initialized()) {
+            throw std::runtime_error("try calling JPLEphems::init() first");
+        }
+        if (_source) {
+            for (std::size_t i = 0; i < n; ++i) {
+                out[i] = sourceState(jdt, Earth, bodies[i], velocity);
+            }
+            return;
+        }
+        const int quantities = velocity ? 2 : 1;
+        const double earth_frac = 1.0 / (1.0 + jpl_get_double(_ephdata, JPL_EPHEM_EARTH_MOON_RATIO));
+        int list[14] = {0};
+        list[2] = quantities; // earth-moon barycenter
+        list[9] = quantities; // geocentric moon
+        for (std::size_t i = 0; i < n; ++i) {
+            if (bodies[i] == Earth || bodies[i] > Sun) {
+                throw std::runtime_error("get_geocentric() takes planets, the Moon and the Sun, not point %d"_fmt.format(bodies[i]));
+            } else if (bodies[i] < Moon) {
+                list[bodies[i] - 1] = quantities;
+            }
+        }
+        double pv[13][6];
+        double nut[4];
+        // heliocentric
+        int res = jpl_state(_ephdata, jdt, list, pv, nut, 0);
         if (res != 0) {
-            throw std::runtime_error("jpl_pleph returned code %d"_fmt.format(res));
+            throw std::runtime_error("jpl_state returned code %d"_fmt.format(res));
+        }
+        double earth[6];
+        for (int k = 0; k < 6; ++k) {
+            earth[k] = k < 3 * quantities ? pv[2][k] - pv[9][k] * earth_frac : 0.0;
+        }
+        for (std::size_t i = 0; i < n; ++i) {
+            for (int k = 0; k < 6; ++k) {
+                if (k >= 3 * quantities) {
+                    out[i].pv[k] = 0.0;
+                } else if (bodies[i] == Moon) {
+                    out[i].pv[k] = pv[9][k];
+                } else if (bodies[i] == Sun) {
+                    out[i].pv[k] = -earth[k];
+                } else {
+                    out[i].pv[k] = pv[bodies[i] - 1][k] - earth[k];
+                }
+            }
         }
-        return result;
     }
 /*
     OBLIQUITY OF THE ECLIPTIC, NUTATION AND LATITUDES
@@ -150,7 +247,11 @@ public:
         NutationState result;
         if (!initialized()) {
             throw std::runtime_error("try calling JPLEphems::init() first"_fmt.format());
-		}
+		} else if (_source) {
+            result.pv[4] = result.pv[5] = 0.0;
+            _source(jdt, Nutations, result.pv);
+            return result;
+        }
 
         int res = jpl_pleph(_ephdata, jdt, Nutations, 0, result.pv, 0);
         if (res != 0) {
@@ -164,6 +265,9 @@ public:
         State result;
         if (!initialized()) {
             throw std::runtime_error("try calling JPLEphems::init() first"_fmt.format());
+        } else if (_source) {
+            _source(jdt, Librations, result.pv);
+            return result;
         }
         int res = jpl_pleph(_ephdata, jdt, Librations, 0, result.pv, 0);
         if (res != 0) {
@@ -171,10 +275,106 @@ public:
         }
         return result;
     }
+
+    // TDB - TT at the geocenter in seconds, from the ephemeris' own time series where
+    // it has one (DE430t, DE432t, DE440t) and the analytic series otherwise; plugs
+    // into the timescales conversions as
+    //     timescales::convert(jd, UTC, TDB, [&](double jd) { return ephems.tdb_minus_tt(jd); })
+    double tdb_minus_tt(double jdt)
+    {
+        double rrd[6];
+        if (!initialized()) {
+            throw std::runtime_error("try calling JPLEphems::init() first");
+        } else if (_source) {
+            return timescales::tdb_minus_tt(jdt);
+        }
+        int res = jpl_pleph(_ephdata, jdt, TT_TDB, 0, rrd, 0);
+        if (res == JPL_EPH_QUANTITY_NOT_IN_EPHEMERIS) {
+            return timescales::tdb_minus_tt(jdt);
+        } else if (res != 0) {
+            throw std::runtime_error("jpl_pleph returned code %d"_fmt.format(res));
+        }
+        return -rrd[0];
+    }
 private:
+    template <typename Epochs>
+    void get_moon_sun(std::size_t n, Epochs &&epoch, State *moon, State *sun, bool velocity)
+    {
+        if (!initialized()) {
+            throw std::runtime_error("try calling JPLEphems::init() first");
+        }
+        if (_source) {
+            for (std::size_t i = 0; i < n; ++i) {
+                const std::array<double, 2> et2 = epoch(i);
+                moon[i] = sourceState(et2[0] + et2[1], Earth, Moon, velocity);
+                sun[i] = sourceState(et2[0] + et2[1], Earth, Sun, velocity);
+            }
+            return;
+        }
+        const int quantities = velocity ? 2 : 1;
+        const double earth_frac = 1.0 / (1.0 + jpl_get_double(_ephdata, JPL_EPHEM_EARTH_MOON_RATIO));
+        int list[14] = {0};
+        list[2] = quantities; // earth-moon barycenter
+        list[9] = quantities; // geocentric moon
+        double pv[13][6];
+        double nut[4];
+        for (std::size_t i = 0; i < n; ++i) {
+            // heliocentric, so the sun is just minus the earth
+            const std::array<double, 2> et2 = epoch(i);
+            int res = jpl_state2(_ephdata, et2.data(), list, pv, nut, 0);
+            if (res != 0) {
+                throw std::runtime_error("jpl_state returned code %d"_fmt.format(res));
+            }
+            for (int k = 0; k < 6; ++k) {
+                if (k < 3 * quantities) {
+                    moon[i].pv[k] = pv[9][k];
+                    sun[i].pv[k] = pv[9][k] * earth_frac - pv[2][k];
+                } else {
+                    moon[i].pv[k] = 0.0;
+                    sun[i].pv[k] = 0.0;
+                }
+            }
+        }
+    }
+
+    State get_state(const double et2[2], Point center, Point ref, bool velocity)
+    {
+        State result;
+        if (!initialized()) {
+            throw std::runtime_error("try calling JPLEphems::init() first");
+        } else if (_source) {
+            return sourceState(et2[0] + et2[1], center, ref, velocity);
+        }
+        int res = jpl_pleph2(_ephdata, et2, ref, center, result.pv, velocity ? 1 : 0);
+        if (res != 0) {
+            throw std::runtime_error("jpl_pleph returned code %d"_fmt.format(res));
+        }
+        return result;
+    }
+
+    // ref relative to center, from the source
+    State sourceState(double jdt, Point center, Point ref, bool velocity) const
+    {
+        double c[6] = {0.0}, r[6] = {0.0};
+        if (center != SolarSystemBarycenter) {
+            _source(jdt, center, c);
+        }
+        if (ref != SolarSystemBarycenter) {
+            _source(jdt, ref, r);
+        }
+        State result;
+        for (int k = 0; k < 6; ++k) {
+            result.pv[k] = k < 3 || velocity ? r[k] - c[k] : 0.0;
+        }
+        return result;
+    }
+
     char _names[MAX_CONSTANTS][6];
     double _values[MAX_CONSTANTS];
     jpl_eph_data *_ephdata;
+    std::string _filename;
+    source_fun _source;
+    double _au_km = 0.0;
 };
 
 #endif /* PAULYC_EPHEMSHELPER_HPP */
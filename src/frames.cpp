@@ -0,0 +1,207 @@
+/**
+ * frames.cpp
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#include "frames.hpp"
+
+#include <limits>
+
+namespace github {
+namespace paulyc {
+
+namespace {
+
+static constexpr long double ARCSEC = MMM_PI / 648000.0l;
+static constexpr long double DEG = MMM_PI / 180.0l;
+
+inline long double centuries(long double jd) {
+    return (jd - jd_clock::JD2000_EPOCH_JD) / 36525.0l;
+}
+
+// fifth order polynomial in T with coefficients in arcseconds, to radians
+inline long double arcsecPoly(long double T, long double c0, long double c1, long double c2, long double c3, long double c4, long double c5) {
+    return ARCSEC * (c0 + T * (c1 + T * (c2 + T * (c3 + T * (c4 + T * c5)))));
+}
+
+// cubic Lagrange through nodes at u = -1, 0, 1, 2, as polynomial coefficients in u
+void fitNodes(const mat3x3q_t *m[4], double (&c)[4][3][3]) {
+    for (std::size_t i = 0; i < 3; ++i) {
+        for (std::size_t j = 0; j < 3; ++j) {
+            const long double y_1 = m[0]->elems[i][j], y0 = m[1]->elems[i][j], y1 = m[2]->elems[i][j], y2 = m[3]->elems[i][j];
+            c[0][i][j] = static_cast<double>(y0);
+            c[1][i][j] = static_cast<double>(-y_1 / 3.0l - y0 / 2.0l + y1 - y2 / 6.0l);
+            c[2][i][j] = static_cast<double>((y_1 + y1) / 2.0l - y0);
+            c[3][i][j] = static_cast<double>((y2 - y_1) / 6.0l + (y0 - y1) / 2.0l);
+        }
+    }
+}
+
+}
+
+FrameRotation::FrameRotation(nutation_fun nutation, long double step) :
+    _nutation(nutation),
+    _step(step),
+    _exact({std::numeric_limits<long double>::quiet_NaN(), mat3x3q_t(), mat3x3q_t()}),
+    _next_node(0)
+{
+    for (Node &n : _nodes) {
+        n.index = std::numeric_limits<long>::min();
+    }
+    _npb_interval.index = std::numeric_limits<long>::min();
+    _ecliptic_interval.index = std::numeric_limits<long>::min();
+}
+
+FrameRotation::FrameRotation(JPLEphems &ephems, long double step) :
+    FrameRotation([&ephems](double jd) -> std::pair<long double, long double> {
+        const JPLEphems::NutationState ns = ephems.get_nutations(jd);
+        return {ns.nutationInLongitude(), ns.nutationInObliquity()};
+    }, step)
+{
+}
+
+FrameRotation::FrameRotation(long double step) :
+    FrameRotation(nutationLeadingTerms, step)
+{
+}
+
+long double FrameRotation::meanObliquity(long double jd) {
+    return arcsecPoly(centuries(jd), 84381.406l, -46.836769l, -0.0001831l, 0.00200340l, -0.000000576l, -0.0000000434l);
+}
+
+std::pair<long double, long double> FrameRotation::nutationLeadingTerms(double jd) {
+    const long double T = centuries(jd);
+    // Delaunay arguments: mean elongation of the Moon, argument of latitude, longitude of the node
+    const long double D = DEG * (297.85019547l + 445267.1114469l * T);
+    const long double F = DEG * (93.27209062l + 483202.0175273l * T);
+    const long double Ω = DEG * (125.04455501l - 1934.1361849l * T);
+    const long double Δψ = -17.2064161l * sinl(Ω) - 1.3170907l * sinl(2.0l * (F - D + Ω)) - 0.2276413l * sinl(2.0l * (F + Ω)) + 0.2074554l * sinl(2.0l * Ω);
+    const long double Δɛ = 9.2052331l * cosl(Ω) + 0.5730336l * cosl(2.0l * (F - D + Ω)) + 0.0978459l * cosl(2.0l * (F + Ω)) - 0.0897492l * cosl(2.0l * Ω);
+    return {ARCSEC * Δψ, ARCSEC * Δɛ};
+}
+
+FrameRotation::Matrices FrameRotation::compute(long double jd) const {
+    const long double T = centuries(jd);
+    // Fukushima-Williams angles, frame bias included (IERS Conventions 2010, 5.40)
+    const long double γ = arcsecPoly(T, -0.052928l, 10.556378l, 0.4932044l, -0.00031238l, -0.000002788l, 0.0000000260l);
+    const long double φ = arcsecPoly(T, 84381.412819l, -46.811016l, 0.0511268l, 0.00053289l, -0.000000440l, -0.0000000176l);
+    const long double ψ = arcsecPoly(T, -0.041775l, 5038.481484l, 1.5584175l, -0.00018522l, -0.000026452l, -0.0000000148l);
+    const long double ɛ_A = meanObliquity(jd);
+    const auto [Δψ, Δɛ] = _nutation(static_cast<double>(jd));
+
+    // R_1(-(ɛ_A + Δɛ)) R_3(-(ψ + Δψ)) R_1(φ) R_3(γ), and the ecliptic one drops the leading R_1
+    const mat3x3q_t ecl = mat3x3q_t::R_seq<3, 1, 3>(-(ψ + Δψ), φ, γ);
+    return Matrices {jd, ecl.rotated(1, -(ɛ_A + Δɛ)), ecl};
+}
+
+const FrameRotation::Matrices& FrameRotation::exact(long double jd) {
+    if (jd != _exact.jd) {
+        _exact = compute(jd);
+    }
+    return _exact;
+}
+
+const FrameRotation::Matrices& FrameRotation::node(long index) {
+    for (const Node &n : _nodes) {
+        if (n.index == index) {
+            return n.m;
+        }
+    }
+    // round robin replacement works out as least recently computed for time ordered series
+    Node &n = _nodes[_next_node];
+    _next_node = (_next_node + 1) % NODES;
+    n.index = index;
+    n.m = compute(static_cast<long double>(index) * _step);
+    return n.m;
+}
+
+mat3x3<double> FrameRotation::interpolate(long double jd, mat3x3q_t Matrices::*which, Interval &interval) {
+    // double resolves ~40 µs of the epoch, more than enough to place it within the interval
+    const double x = static_cast<double>(jd) / static_cast<double>(_step);
+    const long k = static_cast<long>(floor(x));
+    if (k != interval.index) {
+        const mat3x3q_t *m[4] = {&(node(k - 1).*which), &(node(k).*which), &(node(k + 1).*which), &(node(k + 2).*which)};
+        fitNodes(m, interval.c);
+        interval.index = k;
+    }
+    const double u = x - static_cast<double>(k);
+    mat3x3<double> r;
+    for (std::size_t i = 0; i < 3; ++i) {
+        for (std::size_t j = 0; j < 3; ++j) {
+            r.elems[i][j] = interval.c[0][i][j] + u * (interval.c[1][i][j] + u * (interval.c[2][i][j] + u * interval.c[3][i][j]));
+        }
+    }
+    return r;
+}
+
+const mat3x3q_t& FrameRotation::npb(long double jd) {
+    return exact(jd).npb;
+}
+
+mat3x3q_t FrameRotation::npbInterpolated(long double jd) {
+    const mat3x3<double> m = interpolate(jd, &Matrices::npb, _npb_interval);
+    return mat3x3q_t({
+        {m.elems[0][0], m.elems[0][1], m.elems[0][2]},
+        {m.elems[1][0], m.elems[1][1], m.elems[1][2]},
+        {m.elems[2][0], m.elems[2][1], m.elems[2][2]},
+    });
+}
+
+const mat3x3q_t& FrameRotation::ecliptic(long double jd) {
+    return exact(jd).ecliptic;
+}
+
+mat3x3q_t FrameRotation::eclipticInterpolated(long double jd) {
+    const mat3x3<double> m = interpolate(jd, &Matrices::ecliptic, _ecliptic_interval);
+    return mat3x3q_t({
+        {m.elems[0][0], m.elems[0][1], m.elems[0][2]},
+        {m.elems[1][0], m.elems[1][1], m.elems[1][2]},
+        {m.elems[2][0], m.elems[2][1], m.elems[2][2]},
+    });
+}
+
+void FrameRotation::transform(std::span<const jd_clock::time_point> jds, std::span<const cartesian3dvec> in, std::span<cartesian3dvec> out, bool exact, bool inverse) {
+    for (std::size_t i = 0; i < jds.size(); ++i) {
+        const long double jd = jds[i].time_since_epoch().count();
+        if (exact) {
+            const mat3x3q_t &m = ecliptic(jd);
+            const vec3q_t q = inverse ? m.transposeMul(in[i]) : m.mul(in[i]);
+            out[i] = cartesian3dvec {{q.raw[0], q.raw[1], q.raw[2]}};
+        } else {
+            const mat3x3<double> m = interpolate(jd, &Matrices::ecliptic, _ecliptic_interval);
+            const double v[3] = {static_cast<double>(in[i].x()), static_cast<double>(in[i].y()), static_cast<double>(in[i].z())};
+            double r[3];
+            for (std::size_t k = 0; k < 3; ++k) {
+                r[k] = inverse ? m.elems[0][k] * v[0] + m.elems[1][k] * v[1] + m.elems[2][k] * v[2]
+                               : m.elems[k][0] * v[0] + m.elems[k][1] * v[1] + m.elems[k][2] * v[2];
+            }
+            out[i] = cartesian3dvec {{r[0], r[1], r[2]}};
+        }
+    }
+}
+
+void FrameRotation::toEclipticOfDate(std::span<const jd_clock::time_point> jds, std::span<const cartesian3dvec> in, std::span<cartesian3dvec> out, bool exact) {
+    transform(jds, in, out, exact, false);
+}
+
+void FrameRotation::fromEclipticOfDate(std::span<const jd_clock::time_point> jds, std::span<const cartesian3dvec> in, std::span<cartesian3dvec> out, bool exact) {
+    transform(jds, in, out, exact, true);
+}
+
+}
+}
@@ -0,0 +1,54 @@
+/**
+ * ingress.cpp
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#include "ingress.hpp"
+#include "iso8601.hpp"
+
+namespace github {
+namespace paulyc {
+
+LongitudeSample SolarIngresses::longitude(long double jd) {
+    const jd_clock::time_point t = jd_clock::time_point(jd_clock::duration(jd));
+    const long double λ = _apparent.eclipticLonLat(JPLEphems::Sun, t).first;
+    // aberration and light-time barely change the rate, and Newton only needs it roughly
+    const JPLEphems::State s = _ephems.get_state(static_cast<double>(jd), JPLEphems::Earth, JPLEphems::Sun, true);
+    const cartesian3dvec p = equatorialToEcliptic(s.position());
+    const cartesian3dvec v = equatorialToEcliptic(s.velocity());
+    const long double dλ = (p.x() * v.y() - p.y() * v.x()) / (p.x() * p.x() + p.y() * p.y()) + ApparentPlace::precessionRate(jd);
+    return LongitudeSample {λ, dλ};
+}
+
+std::vector<PlanetEvent> SolarIngresses::find(const jd_clock::time_point &from, const jd_clock::time_point &to) {
+    std::vector<PlanetEvent> out;
+    solveIngresses([this](long double jd) { return longitude(jd); }, JPLEphems::Sun,
+                   from.time_since_epoch().count(), to.time_since_epoch().count(), TOLERANCE_JD, out);
+    return out;
+}
+
+std::vector<PlanetEvent> SolarIngresses::year(int year) {
+    return find(newYear(year), newYear(year + 1));
+}
+
+jd_clock::time_point SolarIngresses::newYear(int year) {
+    return jd_clock::time_point(jd_clock::duration(jd_clock::UNIX_EPOCH_JD + iso8601::days_from_civil(year, 1, 1)));
+}
+
+}
+}
@@ -0,0 +1,116 @@
+/**
+ * ingress.hpp
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#ifndef PAULYC_INGRESS_HPP
+#define PAULYC_INGRESS_HPP
+
+#include "apparent.hpp"
+#include "solvers.hpp"
+#include "stations.hpp"
+
+#include <stdexcept>
+#include <vector>
+
+namespace github {
+namespace paulyc {
+
+// a longitude in [0, 2π) and its rate, radians per day
+struct LongitudeSample {
+    long double λ;
+    long double dλ;
+};
+
+/*
+ * Every crossing of a 30° boundary in [from, to) by a longitude that only ever
+ * increases, as the Sun's does, with sample(jd) returning a LongitudeSample.
+ *
+ * Each crossing is predicted from the last with the rate there, bracketed a
+ * couple of days either side of the prediction and solved with Newton on the
+ * rate, so a sign costs half a dozen samples rather than a scan through it.
+ */
+template <typename F>
+void solveIngresses(F &&sample, JPLEphems::Point body, long double from, long double to, long double xtol, std::vector<PlanetEvent> &out)
+{
+    static constexpr long double SIGN = MMM_PI / 6.0l;
+    static constexpr long double HALF_BRACKET_JD = 2.0l;
+
+    LongitudeSample s = sample(from);
+    long double jd = from;
+    for (long k = static_cast<long>(floorl(s.λ / SIGN)) + 1; ; ++k) {
+        const long double boundary = (k % 12) * SIGN;
+        const long double guess = jd + fmodl(boundary - s.λ + MMM_2_PI, MMM_2_PI) / s.dλ;
+        if (guess - HALF_BRACKET_JD >= to) {
+            break;
+        }
+        long double dλ = s.dλ;
+        auto g = [&](long double x) -> std::pair<long double, long double> {
+            const LongitudeSample t = sample(x);
+            dλ = t.dλ;
+            return {wrapAngle(t.λ - boundary), t.dλ};
+        };
+        auto f = [&](long double x) {
+            return g(x).first;
+        };
+        const Bracket<long double> br = bracket_root(f, std::max(jd, guess - HALF_BRACKET_JD), guess + HALF_BRACKET_JD);
+        const SolverResult<long double> root = br ? newton_root(g, br.a, br.b, br.fa, br.fb, xtol) : SolverResult<long double> {};
+        if (!root) {
+            throw std::runtime_error("solveIngresses no crossing of %ld near %Lf"_fmt.format(k % 12, guess));
+        }
+        if (root.x >= to) {
+            break;
+        }
+        const int sign = static_cast<int>(k % 12);
+        out.push_back(PlanetEvent {body, PlanetEvent::Ingress, jd_clock::time_point(jd_clock::duration(root.x)), sign * SIGN, sign});
+        jd = root.x;
+        s = LongitudeSample {boundary, dλ};
+    }
+}
+
+/*
+ * The Sun's ingresses by apparent geocentric longitude on the true ecliptic and
+ * equinox of date: light-time, aberration, precession and nutation through
+ * ApparentPlace, and the rate from the Earth to Sun velocity in the ephemeris
+ * plus that of the precession.
+ */
+class SolarIngresses
+{
+public:
+    static constexpr long double TOLERANCE_JD = 1e-8l;
+
+    explicit SolarIngresses(JPLEphems &ephems) : _ephems(ephems), _apparent(ephems) {}
+
+    LongitudeSample longitude(long double jd);
+    // in [from, to), in time order
+    std::vector<PlanetEvent> find(const jd_clock::time_point &from, const jd_clock::time_point &to);
+    // the twelve of a year, from newYear(year) to newYear(year + 1)
+    std::vector<PlanetEvent> year(int year);
+
+    // 0h UTC on 1 January, taken as TDB
+    static jd_clock::time_point newYear(int year);
+
+private:
+    JPLEphems &_ephems;
+    ApparentPlace _apparent;
+};
+
+}
+}
+
+#endif /* PAULYC_INGRESS_HPP */
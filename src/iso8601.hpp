@@ -0,0 +1,274 @@
+/**
+ * iso8601.hpp
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#ifndef PAULYC_ISO8601_HPP
+#define PAULYC_ISO8601_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <limits>
+#include <string_view>
+
+namespace github {
+namespace paulyc {
+
+/*
+ * UTC timestamps as YYYY-MM-DDTHH:MM:SS.mmmZ, formatted into and parsed from
+ * caller buffers with Howard Hinnant's days-from-civil arithmetic, so there is
+ * no gmtime() static buffer, no locale and no allocation, and any number of
+ * threads can format at once. Years outside 0000-9999 are written with a sign
+ * and at least six digits, as ISO 8601 expanded years.
+ */
+namespace iso8601 {
+
+// characters format() writes for years 0000-9999
+static constexpr std::size_t LENGTH = 24;
+// enough for any year a millisecond count reaches
+static constexpr std::size_t MAX_LENGTH = 40;
+
+struct civil_date
+{
+    std::int64_t year;
+    unsigned month;
+    unsigned day;
+};
+
+// days since 1970-01-01 of a proleptic Gregorian date
+constexpr std::int64_t days_from_civil(std::int64_t y, unsigned m, unsigned d) noexcept {
+    y -= m <= 2;
+    const std::int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const std::int64_t yoe = y - era * 400;
+    const std::int64_t doy = (153 * (m > 2 ? m - 3 : m + 9) + 2) / 5 + d - 1;
+    const std::int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+constexpr civil_date civil_from_days(std::int64_t z) noexcept {
+    z += 719468;
+    const std::int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    const std::int64_t doe = z - era * 146097;
+    const std::int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const std::int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const std::int64_t mp = (5 * doy + 2) / 153;
+    const unsigned d = static_cast<unsigned>(doy - (153 * mp + 2) / 5 + 1);
+    const unsigned m = static_cast<unsigned>(mp < 10 ? mp + 3 : mp - 9);
+    return {yoe + era * 400 + (m <= 2), m, d};
+}
+
+constexpr unsigned days_in_month(std::int64_t y, unsigned m) noexcept {
+    if (m == 2) {
+        return (y % 4 == 0 && (y % 100 != 0 || y % 400 == 0)) ? 29 : 28;
+    }
+    return m == 4 || m == 6 || m == 9 || m == 11 ? 30 : 31;
+}
+
+namespace detail {
+
+struct digit_pairs
+{
+    char pairs[200];
+    constexpr digit_pairs() : pairs() {
+        for (int i = 0; i < 100; ++i) {
+            pairs[2 * i] = static_cast<char>('0' + i / 10);
+            pairs[2 * i + 1] = static_cast<char>('0' + i % 10);
+        }
+    }
+};
+
+inline constexpr digit_pairs DIGIT_PAIRS;
+
+inline char* put2(char *out, unsigned v) noexcept {
+    out[0] = DIGIT_PAIRS.pairs[2 * v];
+    out[1] = DIGIT_PAIRS.pairs[2 * v + 1];
+    return out + 2;
+}
+
+inline char* put_year(char *out, std::int64_t y) noexcept {
+    if (y >= 0 && y <= 9999) {
+        return put2(put2(out, static_cast<unsigned>(y / 100)), static_cast<unsigned>(y % 100));
+    }
+    *out++ = y < 0 ? '-' : '+';
+    std::uint64_t u = y < 0 ? -static_cast<std::uint64_t>(y) : static_cast<std::uint64_t>(y);
+    char digits[20];
+    int n = 0;
+    do {
+        digits[n++] = static_cast<char>('0' + u % 10);
+        u /= 10;
+    } while (u != 0);
+    for (int pad = n; pad < 6; ++pad) {
+        *out++ = '0';
+    }
+    while (n > 0) {
+        *out++ = digits[--n];
+    }
+    return out;
+}
+
+// n digits at s, false unless they're all digits
+inline bool get(const char *s, int n, std::int64_t &v) noexcept {
+    v = 0;
+    for (int i = 0; i < n; ++i) {
+        if (s[i] < '0' || s[i] > '9') {
+            return false;
+        }
+        v = v * 10 + (s[i] - '0');
+    }
+    return true;
+}
+
+}
+
+// writes the timestamp, rounded down to the millisecond, at out (which needs
+// MAX_LENGTH chars, or LENGTH for years 0000-9999) and returns the end; no NUL
+template <typename Duration>
+char* format(std::chrono::sys_time<Duration> tp, char *out) noexcept {
+    using namespace std::chrono;
+    const std::int64_t ms = floor<milliseconds>(tp).time_since_epoch().count();
+    std::int64_t days = ms / 86400000;
+    std::int64_t rem = ms % 86400000;
+    if (rem < 0) {
+        rem += 86400000;
+        --days;
+    }
+    const civil_date date = civil_from_days(days);
+    const unsigned s = static_cast<unsigned>(rem / 1000);
+    const unsigned milli = static_cast<unsigned>(rem % 1000);
+    out = detail::put_year(out, date.year);
+    *out++ = '-';
+    out = detail::put2(out, date.month);
+    *out++ = '-';
+    out = detail::put2(out, date.day);
+    *out++ = 'T';
+    out = detail::put2(out, s / 3600);
+    *out++ = ':';
+    out = detail::put2(out, s / 60 % 60);
+    *out++ = ':';
+    out = detail::put2(out, s % 60);
+    *out++ = '.';
+    *out++ = static_cast<char>('0' + milli / 100);
+    out = detail::put2(out, milli % 100);
+    *out++ = 'Z';
+    return out;
+}
+
+/*
+ * Reads what format() writes, and a bit more: a space for the T, any number of
+ * fraction digits (rounded down to Duration, nanoseconds at best), and Z or a
+ * +hh:mm, +hhmm or +hh offset. Seconds may be 60 for a leap second, which then
+ * reads as the first second of the next minute. False, with out untouched, for
+ * anything else, including trailing characters and instants Duration can't hold.
+ */
+template <typename Duration>
+bool parse(std::string_view s, std::chrono::sys_time<Duration> &out) noexcept {
+    using namespace std::chrono;
+    const char *p = s.data(), *end = p + s.size();
+    auto left = [&]() { return end - p; };
+
+    int sign = 1;
+    int year_digits = 4;
+    if (left() > 0 && (*p == '+' || *p == '-')) {
+        sign = *p++ == '-' ? -1 : 1;
+        year_digits = 0;
+        while (year_digits < left() && p[year_digits] >= '0' && p[year_digits] <= '9') {
+            ++year_digits;
+        }
+        if (year_digits < 4 || year_digits > 12) {
+            return false;
+        }
+    }
+    std::int64_t y, mo, d, h, mi, sec;
+    if (left() < year_digits + 15 || !detail::get(p, year_digits, y)) {
+        return false;
+    }
+    p += year_digits;
+    if (p[0] != '-' || !detail::get(p + 1, 2, mo) || p[3] != '-' || !detail::get(p + 4, 2, d) ||
+        (p[6] != 'T' && p[6] != 't' && p[6] != ' ') ||
+        !detail::get(p + 7, 2, h) || p[9] != ':' || !detail::get(p + 10, 2, mi) || p[12] != ':' ||
+        !detail::get(p + 13, 2, sec)) {
+        return false;
+    }
+    p += 15;
+    y *= sign;
+    if (mo < 1 || mo > 12 || d < 1 || d > days_in_month(y, static_cast<unsigned>(mo)) || h > 23 || mi > 59 || sec > 60) {
+        return false;
+    }
+
+    std::int64_t ns = 0;
+    if (left() > 0 && (*p == '.' || *p == ',')) {
+        ++p;
+        int digits = 0;
+        for (; left() > 0 && *p >= '0' && *p <= '9'; ++p, ++digits) {
+            if (digits < 9) {
+                ns = ns * 10 + (*p - '0');
+            }
+        }
+        if (digits == 0) {
+            return false;
+        }
+        for (; digits < 9; ++digits) {
+            ns *= 10;
+        }
+    }
+
+    std::int64_t offset = 0;
+    if (left() == 1 && (*p == 'Z' || *p == 'z')) {
+        ++p;
+    } else if (left() >= 3 && (*p == '+' || *p == '-')) {
+        const int offset_sign = *p == '-' ? -1 : 1;
+        std::int64_t oh, om = 0;
+        if (!detail::get(p + 1, 2, oh)) {
+            return false;
+        }
+        p += 3;
+        if (left() == 3 && *p == ':' && detail::get(p + 1, 2, om)) {
+            p += 3;
+        } else if (left() == 2 && detail::get(p, 2, om)) {
+            p += 2;
+        }
+        if (oh > 23 || om > 59) {
+            return false;
+        }
+        offset = offset_sign * (oh * 3600 + om * 60);
+    }
+    if (p != end) {
+        return false;
+    }
+
+    // |days| Duration and the second count below can both hold, less a day for
+    // the time of day and the offset
+    typedef duration<long double, std::ratio<86400>> fractional_days;
+    static constexpr long double DURATION_DAYS = duration_cast<fractional_days>(Duration::max()).count();
+    static constexpr long double SECONDS_DAYS = std::numeric_limits<std::int64_t>::max() / 86400;
+    static constexpr long double MAX_DAYS = (DURATION_DAYS < SECONDS_DAYS ? DURATION_DAYS : SECONDS_DAYS) - 1;
+    const std::int64_t days = days_from_civil(y, static_cast<unsigned>(mo), static_cast<unsigned>(d));
+    if (static_cast<long double>(days < 0 ? -days : days) > MAX_DAYS) {
+        return false;
+    }
+    const sys_seconds whole {seconds(days * 86400 + h * 3600 + mi * 60 + sec - offset)};
+    out = time_point_cast<Duration>(whole) + duration_cast<Duration>(nanoseconds(ns));
+    return true;
+}
+
+}
+
+}
+}
+
+#endif /* PAULYC_ISO8601_HPP */
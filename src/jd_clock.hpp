@@ -31,12 +31,21 @@
 #include <iomanip>
 #include <cstring>
 
-struct jd_clock
+#include "delta_t.hpp"
+#include "timescales.hpp"
+#include "ddouble.hpp"
+#include "iso8601.hpp"
+
+// Julian days in TDB. Rep is long double for jd_clock; dd_jd_clock counts in
+// mmm::ddouble, whose 106 bits hold a date to about 1e-26 days, so long spans
+// can be accumulated in small steps without the sum drifting.
+template <typename Rep>
+struct basic_jd_clock
 {
-    typedef long double                         rep;
+    typedef Rep                                 rep;
     typedef std::ratio<86400>                   period;
     typedef std::chrono::duration<rep, period>  duration;
-    typedef std::chrono::time_point<jd_clock>   time_point;
+    typedef std::chrono::time_point<basic_jd_clock> time_point;
 
     /*
      * delta-T =
@@ -91,72 +100,73 @@ struct jd_clock
     static constexpr long double JD2000_EPOCH_JD = 2451545.0l;
     static constexpr long JD2000_EPOCH_JDS = 211813488000l;
     static constexpr long double JD2000_EPOCH_UNIXTIME = 946727935.816l;//946728000l;//
-    static constexpr long double UNIX_EPOCH_JD = JD2000_EPOCH_JD - JD2000_EPOCH_UNIXTIME/SECONDS_PER_JDAY;
+    // 1970-01-01T00:00:00 UTC; unix time counts UTC days of exactly 86400s
+    static constexpr long double UNIX_EPOCH_JD = 2440587.5l;
     static constexpr long double JD2000_DELTA_T = 63.83l;
     static constexpr long double DELTA_T_2018 = 68.97l;
-    static constexpr long double leap_seconds_since_unix_epoch = 27.0l;
 
     static time_point now() noexcept {
         return from_system_clock(std::chrono::system_clock::now());
     }
 
+    // keeps the sub-second part; split_jd_clock round trips it exactly
     static time_point from_system_clock(const std::chrono::system_clock::time_point &t) {
-        return from_time_t(std::chrono::system_clock::to_time_t(t));
+        const auto s = std::chrono::floor<std::chrono::seconds>(t);
+        const long double sub = std::chrono::duration<long double>(t - s).count();
+        return from_unix_seconds(rep(static_cast<long double>(s.time_since_epoch().count())) + rep(sub));
     }
 
+    // unix time is UTC, time points are TDB, the scale the ephemeris is indexed by
     static time_point from_time_t(std::time_t t) {
-        return time_point(duration(UNIX_EPOCH_JD + t/jd_clock::SECONDS_PER_JDAY));
+        return from_unix_seconds(rep(static_cast<long double>(t)));
     }
 
-    static std::time_t to_time_t(jd_clock::time_point &jd) {
-        return static_cast<std::time_t>((jd.time_since_epoch().count() - UNIX_EPOCH_JD) * SECONDS_PER_JDAY);
+    static time_point from_unix_seconds(rep seconds) {
+        const rep utc = rep(UNIX_EPOCH_JD) + seconds / rep(SECONDS_PER_JDAY);
+        return time_point(duration(timescales::convert(utc, timescales::UTC, timescales::TDB)));
     }
 
-    static std::chrono::system_clock::time_point to_system_clock(jd_clock::time_point &jd) {
-        return std::chrono::system_clock::from_time_t(to_time_t(jd));
+    static std::time_t to_time_t(time_point &jd) {
+        const rep utc = timescales::convert(jd.time_since_epoch().count(), timescales::TDB, timescales::UTC);
+        return static_cast<std::time_t>(llroundl(static_cast<long double>((utc - rep(UNIX_EPOCH_JD)) * rep(SECONDS_PER_JDAY))));
     }
 
-    struct YearDT {
-        double year;
-        double dt;
-    };
-
-    static constexpr jd_clock::YearDT DELTA_T_YR[] = {
-        {-500, 17190},
-        {0, 10580},
-        {500,5710},
-        {1000,1570},
-        {1500,200},
-        {1900,-6.64},
-        {2000,63.83},
-        {2018,68.97}
-    };
-
-    // probably broken
+    static time_point from_tdb(const tdb_jd_clock::time_point &tdb) {
+        return time_point(duration(rep(tdb.time_since_epoch().count())));
+    }
+
+    static tdb_jd_clock::time_point to_tdb(const time_point &jd) {
+        return tdb_jd_clock::time_point(tdb_jd_clock::duration(static_cast<long double>(jd.time_since_epoch().count())));
+    }
+
+    // to the nearest microsecond, as close as a long double date gets
+    static std::chrono::system_clock::time_point to_system_clock(const time_point &jd) {
+        const rep utc = timescales::convert(jd.time_since_epoch().count(), timescales::TDB, timescales::UTC);
+        const long double seconds = static_cast<long double>((utc - rep(UNIX_EPOCH_JD)) * rep(SECONDS_PER_JDAY));
+        const long double whole = floorl(seconds);
+        const std::chrono::microseconds sub(llroundl((seconds - whole) * 1e6l));
+        return std::chrono::system_clock::from_time_t(static_cast<std::time_t>(whole)) +
+            std::chrono::duration_cast<std::chrono::system_clock::duration>(sub);
+    }
+
+    // ΔT in seconds at a decimal year; see delta_t.hpp
     static double delta_t_lerp(double year) {
-        size_t point = 1;
-        while (point < sizeof(DELTA_T_YR) - 1 && year > DELTA_T_YR[point].year) {
-            ++point;
-        }
-        //std::cerr << "year " << year << std::endl;
-        const double slope = (DELTA_T_YR[point].dt - DELTA_T_YR[point-1].dt) / (DELTA_T_YR[point].year - DELTA_T_YR[point-1].year);
-        //std::cerr << "slope " << slope << std::endl;
-        const double dy = DELTA_T_YR[point].year - year;
-        //std::cerr << "dy " << dy << std::endl;
-        const double dt = DELTA_T_YR[point].dt - dy * slope;
-        //std::cerr << "dt " << dt << std::endl;
-        return dt;
+        return delta_t::seconds(year);
     }
 };
 
+typedef basic_jd_clock<long double> jd_clock;
+typedef basic_jd_clock<mmm::ddouble> dd_jd_clock;
+
+// UTC, ISO 8601 to the millisecond; thread-safe, see iso8601.hpp
 inline static std::ostream& operator<<(std::ostream &os, const std::chrono::system_clock::time_point &rhs)
 {
-    const std::time_t tt = std::chrono::system_clock::to_time_t(rhs);
-    os << std::put_time(std::gmtime(&tt),"%FT%T%z (%Z)");
-    return os;
+    char buf[github::paulyc::iso8601::MAX_LENGTH];
+    return os.write(buf, github::paulyc::iso8601::format(rhs, buf) - buf);
 }
 
-inline static std::ostream& operator<<(std::ostream &os, const jd_clock::time_point &rhs)
+template <typename Rep>
+inline static std::ostream& operator<<(std::ostream &os, const std::chrono::time_point<basic_jd_clock<Rep>> &rhs)
 {
     os << std::fixed << std::setw( 11 ) << std::setprecision( 6 )
        << std::setfill( '0' ) << rhs.time_since_epoch().count();
@@ -192,6 +192,16 @@ long DLL_FUNC jpl_get_long( const void *ephem, const int value)
 *****************************************************************************/
 int DLL_FUNC jpl_pleph( void *ephem, const double et, const int ntarg,
                       const int ncent, double rrd[], const int calc_velocity)
+{
+   const double et2[2] = { et, 0. };
+
+   return( jpl_pleph2( ephem, et2, ntarg, ncent, rrd, calc_velocity));
+}
+
+/* As jpl_pleph(),  with the epoch in two parts as for jpl_state2(). */
+
+int DLL_FUNC jpl_pleph2( void *ephem, const double et2[2], const int ntarg,
+                      const int ncent, double rrd[], const int calc_velocity)
 {
   struct jpl_eph_data *eph = (struct jpl_eph_data *)ephem;
   double pv[13][6];/* pv is the position/velocity array
@@ -232,7 +242,7 @@ int DLL_FUNC jpl_pleph( void *ephem, const double et, const int ntarg,
          if( eph->ipt[i + 11][1] > 0) /* quantity is in ephemeris */
             {
             list[i + 10] = list_val;
-            rval = jpl_state( ephem, et, list, pv, rrd, 0);
+            rval = jpl_state2( ephem, et2, list, pv, rrd, 0);
             }
          else          /*  quantity doesn't exist in the ephemeris file  */
             rval = JPL_EPH_QUANTITY_NOT_IN_EPHEMERIS;
@@ -258,7 +268,7 @@ int DLL_FUNC jpl_pleph( void *ephem, const double et, const int ntarg,
 
 /*   make call to state   */
 
-   rval = jpl_state( eph, et, list, pv, rrd, 1);
+   rval = jpl_state2( eph, et2, list, pv, rrd, 1);
    /* Solar System barycentric Sun state goes to pv[10][] */
    if( ntarg == 11 || ncent == 11)
       for( i = 0; i < 6; i++)
@@ -539,7 +549,7 @@ static int dimension( const int idx)
 }
 
 /*****************************************************************************
-**                        jpl_state(ephem,et2,list,pv,nut,bary)             **
+**      jpl_state(ephem,et,list,pv,nut,bary), jpl_state2(ephem,et2,...)     **
 ******************************************************************************
 ** This subroutine reads and interpolates the jpl planetary ephemeris file  **
 **                                                                          **
@@ -621,24 +631,43 @@ static int dimension( const int idx)
 *****************************************************************************/
 int DLL_FUNC jpl_state( void *ephem, const double et, const int list[14],
                           double pv[][6], double nut[4], const int bary)
+{
+   const double et2[2] = { et, 0. };
+
+   return( jpl_state2( ephem, et2, list, pv, nut, bary));
+}
+
+int DLL_FUNC jpl_state2( void *ephem, const double et2[2], const int list[14],
+                          double pv[][6], double nut[4], const int bary)
 {
    struct jpl_eph_data *eph = (struct jpl_eph_data *)ephem;
    unsigned i, j, n_intervals;
    uint32_t nr;
    double *buf = eph->cache;
    double t[2];
-   const double block_loc = (et - eph->ephem_start) / eph->ephem_step;
+         /* et2[0] - ephem_start is exact for whole or half days,  and only */
+         /* the small remainder within the record meets et2[1],  so the     */
+         /* fraction keeps its full precision                               */
+   const double whole = et2[0] - eph->ephem_start;
+   const double block_loc = (whole + et2[1]) / eph->ephem_step;
+   double offset;
    bool recompute_pvsun;
    const double aufac = 1.0 / eph->au;
 
 /*   error return for epoch out of range  */
-   if( et < eph->ephem_start || et > eph->ephem_end)
+   if( block_loc < 0. || et2[0] + et2[1] > eph->ephem_end)
       return( JPL_EPH_OUTSIDE_RANGE);
 
 /*   calculate record # and relative time in interval   */
 
    nr = (uint32_t)block_loc;
-   t[0] = block_loc - (double)nr;
+   offset = (whole - (double)nr * eph->ephem_step) + et2[1];
+   if( offset < 0. && nr)
+      {
+      nr--;
+      offset += eph->ephem_step;
+      }
+   t[0] = offset / eph->ephem_step;
    if( !t[0] && nr)
       {
       t[0] = 1.;
@@ -661,10 +690,11 @@ int DLL_FUNC jpl_state( void *ephem, const double et, const int list[14],
       }
    t[1] = eph->ephem_step;
 
-   if( eph->pvsun_t != et)   /* If several calls are made for the same et, */
-      {                      /* don't recompute pvsun each time... only on */
-      recompute_pvsun = true;   /* the first run through.                     */
-      eph->pvsun_t = et;
+   if( eph->pvsun_t[0] != et2[0] || eph->pvsun_t[1] != et2[1])
+      {                      /* If several calls are made for the same et, */
+      recompute_pvsun = true;   /* don't recompute pvsun each time... only on */
+      eph->pvsun_t[0] = et2[0]; /* the first run through.                     */
+      eph->pvsun_t[1] = et2[1];
       }
    else
       recompute_pvsun = false;
@@ -786,7 +816,8 @@ void * DLL_FUNC jpl_init_ephemeris( const char *ephemeris_filename,
    temp_data.ncon        = get32bits( header + 24);
    temp_data.au          = get_double( header + 28);
    temp_data.emrat       = get_double( header + 36);
-   temp_data.pvsun_t = -1e+80;   /* a time we can't use anyway */
+   temp_data.pvsun_t[0] = -1e+80;   /* a time we can't use anyway */
+   temp_data.pvsun_t[1] = 0.;
    for( i = 0; i < 40; i++)
       temp_data.ipt[i / 3][i % 3] = get32bits( header + 44 + i * 4);
 
@@ -58,6 +58,10 @@ int DLL_FUNC jpl_state( void *ephem, const double et, const int list[14],
                           double pv[][6], double nut[4], const int bary);
 int DLL_FUNC jpl_pleph( void *ephem, const double et, const int ntarg,
                       const int ncent, double rrd[], const int calc_velocity);
+int DLL_FUNC jpl_state2( void *ephem, const double et2[2], const int list[14],
+                          double pv[][6], double nut[4], const int bary);
+int DLL_FUNC jpl_pleph2( void *ephem, const double et2[2], const int ntarg,
+                      const int ncent, double rrd[], const int calc_velocity);
 double DLL_FUNC jpl_get_double( const void *ephem, const int value);
 long DLL_FUNC jpl_get_long( const void *ephem, const int value);
 int DLL_FUNC make_sub_ephem( void *ephem, const char *sub_filename,
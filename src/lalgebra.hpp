@@ -27,8 +27,13 @@
 #include <string>
 #include <cstdint>
 #include <cmath>
+#include <tuple>
+#include <type_traits>
+#include <utility>
 
 #include "quadmath.h"
+#include "mmm.hpp"
+#include "ddouble.hpp"
 
 // TODO find the sinq/cosq on clang quadmath.h not available idk
 
@@ -124,12 +129,12 @@ struct Nvec
     // for this we'll make an exception since the alternative is merely
     // unreadable rather than entirely opaque
 
-    T operator[](std::size_t i) const {
+    constexpr T operator[](std::size_t i) const {
         return this->data[i];
     }
 
 
-    Nvec& addacc(const Nvec &that) {
+    constexpr Nvec& addacc(const Nvec &that) {
         for (std::size_t i = 0; i < N; ++i) {
             this->data[i] += that.data[i];
         }
@@ -137,14 +142,14 @@ struct Nvec
     }
 
     constexpr Nvec negate() const {
-        Nvec difference;
+        T negation[N];
         for (std::size_t i = 0; i < N; ++i) {
-            difference[i] = -this->data[i];
+            negation[i] = -this->data[i];
         }
-        return difference;
+        return Nvec(negation);
     }
 
-    T dotP(const Nvec &that) const {
+    constexpr T dotP(const Nvec &that) const {
         T product = T(0);
         for (std::size_t i = 0; i < N; ++i) {
             product += this->data[i] * that.data[i];
@@ -153,11 +158,16 @@ struct Nvec
     }
 
     T mag() const {
-        return sqrtl(dotP(*this));
+        return mmm::sqrt(dotP(*this));
     }
 
-    Nvec<3,T> crossP(const Nvec<3,T> &) const {
-
+    constexpr Nvec crossP(const Nvec &that) const requires (N == 3) {
+        const T product[3] = {
+            data[1] * that.data[2] - data[2] * that.data[1],
+            data[2] * that.data[0] - data[0] * that.data[2],
+            data[0] * that.data[1] - data[1] * that.data[0],
+        };
+        return Nvec(product);
     }
 };
 
@@ -165,7 +175,7 @@ template <typename T>
 struct Nvec<0, T>
 {
     constexpr T dotP(const Nvec<0,T> &) const {
-        return T(0.0q);
+        return T(0);
     }
 };
 
@@ -191,9 +201,9 @@ struct NxMmatrix
         for (auto r = 0; r < M; ++r) {
             for (auto c = 0; c < N; ++c) {
                 if (r == c) {
-                    this->rows[r][c] = 1.0q;
+                    this->rows[r][c] = T(1);
                 } else {
-                    this->rows[r][c] = 0.0q;
+                    this->rows[r][c] = T(0);
                 }
             }
         }
@@ -209,14 +219,12 @@ struct NxMmatrix
     }*/
 
 
-    constexpr NxMmatrix(std::initializer_list<RowT> rows)
+    constexpr NxMmatrix(const T (&rows)[M][N])
     {
-        std::size_t r = 0;
-        for (auto rw: rows) {
+        for (std::size_t r = 0; r < M; ++r) {
             for (std::size_t c = 0; c < N; ++c) {
-                this->rows[r][c] = rw[c];
+                this->rows[r][c] = rows[r][c];
             }
-            ++r;
         }
     }
 
@@ -226,6 +234,16 @@ struct NxMmatrix
     NxMmatrix(NxMmatrix&&) = default;
     NxMmatrix& operator=(NxMmatrix&&) = default;
 
+    static constexpr NxMmatrix identity() requires (N == M) {
+        T id[M][N];
+        for (std::size_t r = 0; r < M; ++r) {
+            for (std::size_t c = 0; c < N; ++c) {
+                id[r][c] = r == c ? T(1) : T(0);
+            }
+        }
+        return NxMmatrix(id);
+    }
+
     // operator overloading is one of the Seven Deadly Sins: Vanity, but
     // for this we'll make an exception since the alternative is merely
     // unreadable rather than entirely opaque
@@ -238,35 +256,51 @@ struct NxMmatrix
     //    return this->row(r);
     //}
 
-    constexpr Nvec<M> row(std::size_t r) const {
-        return Nvec<M>(this->rows[r]);
+    // a row has one element per column, and vice versa
+    constexpr Nvec<N, T> row(std::size_t r) const {
+        return Nvec<N, T>(this->rows[r]);
     }
 
-    constexpr Nvec<N> col(std::size_t c) const {
-        T colvec[N];
-        for (auto r = 0; r < M; ++r) {
+    constexpr Nvec<M, T> col(std::size_t c) const {
+        T colvec[M];
+        for (std::size_t r = 0; r < M; ++r) {
             colvec[r] = this->rows[r][c];
         }
-        return Nvec<N>(colvec);
+        return Nvec<M, T>(colvec);
     }
 
-    constexpr Nvec<M> mul(const Nvec<M> &v) const {
+    constexpr Nvec<M, T> mul(const Nvec<N, T> &v) const {
         T product[M];
-        for (int r = 0; r < M; ++r) {
+        for (std::size_t r = 0; r < M; ++r) {
             product[r] = this->row(r).dotP(v);
         }
-        return Nvec<M>(product);
+        return Nvec<M, T>(product);
     }
 
-    // rows in m must be equal to cols in *this but let's keep it simple
-    NxMmatrix mul(const NxMmatrix &that) const {
-        RowT product[M];
-        for (auto r = 0; r < M; ++r) {
-            for (auto c = 0; c < N; ++c) {
-                product[r][c] = this->row(r).dotP(that.col(c));
+    // (M rows x N cols) (N rows x P cols) = (M rows x P cols)
+    template <std::size_t P>
+    constexpr NxMmatrix<P, M, T> mul(const NxMmatrix<P, N, T> &that) const {
+        T product[M][P];
+        for (std::size_t r = 0; r < M; ++r) {
+            for (std::size_t c = 0; c < P; ++c) {
+                T sum = T(0);
+                for (std::size_t k = 0; k < N; ++k) {
+                    sum += this->rows[r][k] * that.rows[k][c];
+                }
+                product[r][c] = sum;
+            }
+        }
+        return NxMmatrix<P, M, T>(product);
+    }
+
+    constexpr NxMmatrix<M, N, T> transpose() const {
+        T t[N][M];
+        for (std::size_t r = 0; r < M; ++r) {
+            for (std::size_t c = 0; c < N; ++c) {
+                t[c][r] = this->rows[r][c];
             }
         }
-        return NxMmatrix(product);
+        return NxMmatrix<M, N, T>(t);
     }
 };
 
@@ -296,8 +330,15 @@ struct vec3
     T dotP(const vec3<T> &v) const {
         return raw[0] * v.raw[0] + raw[1] * v.raw[1] + raw[2] * v.raw[2];
     }
+    vec3<T> crossP(const vec3<T> &v) const {
+        return {
+            raw[1] * v.raw[2] - raw[2] * v.raw[1],
+            raw[2] * v.raw[0] - raw[0] * v.raw[2],
+            raw[0] * v.raw[1] - raw[1] * v.raw[0],
+        };
+    }
     T mag() const {
-        return sqrtl(dotP(*this));
+        return mmm::sqrt(dotP(*this));
     }
 };
 typedef vec3<double> vec3d_t;
@@ -312,7 +353,7 @@ struct mat3x3
     constexpr mat3x3() {
         for (std::size_t i = 0; i < 3; ++i) {
             for (std::size_t j = 0; j < 3; ++j) {
-                elems[i][j] = T(0.0q);
+                elems[i][j] = T(0);
             }
         }
     }
@@ -340,9 +381,19 @@ struct mat3x3
         return *this;
     }
 
+    static constexpr mat3x3 identity() {
+        return {{
+            {T(1), T(0), T(0)},
+            {T(0), T(1), T(0)},
+            {T(0), T(0), T(1)},
+            }};
+    }
+
     // https://gssc.esa.int/navipedia/index.php/Transformation_between_Terrestrial_Frames
     // ????
-    vec3q_t mul(const vec3q_t &v) const {
+    // U may differ from T, eg. a long double rotation applied to dual number vectors
+    template <typename U>
+    constexpr vec3<U> mul(const vec3<U> &v) const {
         return {
             elems[0][0] * v.raw[0] + elems[0][1] * v.raw[1] + elems[0][2] * v.raw[2],
             elems[1][0] * v.raw[0] + elems[1][1] * v.raw[1] + elems[1][2] * v.raw[2],
@@ -350,42 +401,108 @@ struct mat3x3
         };
     }
 
-    static constexpr mat3x3 R_0(long double α, long double θ_1, long double θ_2, long double θ_3) {
+    // transpose().mul(v) without the transpose: for a rotation, the inverse rotation of v
+    template <typename U>
+    constexpr vec3<U> transposeMul(const vec3<U> &v) const {
+        return {
+            elems[0][0] * v.raw[0] + elems[1][0] * v.raw[1] + elems[2][0] * v.raw[2],
+            elems[0][1] * v.raw[0] + elems[1][1] * v.raw[1] + elems[2][1] * v.raw[2],
+            elems[0][2] * v.raw[0] + elems[1][2] * v.raw[1] + elems[2][2] * v.raw[2],
+        };
+    }
+
+    constexpr mat3x3 mul(const mat3x3 &that) const {
+        const T (&a)[3][3] = elems;
+        const T (&b)[3][3] = that.elems;
+        return {{
+            {a[0][0] * b[0][0] + a[0][1] * b[1][0] + a[0][2] * b[2][0],
+             a[0][0] * b[0][1] + a[0][1] * b[1][1] + a[0][2] * b[2][1],
+             a[0][0] * b[0][2] + a[0][1] * b[1][2] + a[0][2] * b[2][2]},
+            {a[1][0] * b[0][0] + a[1][1] * b[1][0] + a[1][2] * b[2][0],
+             a[1][0] * b[0][1] + a[1][1] * b[1][1] + a[1][2] * b[2][1],
+             a[1][0] * b[0][2] + a[1][1] * b[1][2] + a[1][2] * b[2][2]},
+            {a[2][0] * b[0][0] + a[2][1] * b[1][0] + a[2][2] * b[2][0],
+             a[2][0] * b[0][1] + a[2][1] * b[1][1] + a[2][2] * b[2][1],
+             a[2][0] * b[0][2] + a[2][1] * b[1][2] + a[2][2] * b[2][2]},
+            }};
+    }
+
+    // the inverse, as long as this is a rotation
+    constexpr mat3x3 transpose() const {
+        return {{
+            {elems[0][0], elems[1][0], elems[2][0]},
+            {elems[0][1], elems[1][1], elems[2][1]},
+            {elems[0][2], elems[1][2], elems[2][2]},
+            }};
+    }
+
+    // R_axis(θ).mul(*this) for axis 1, 2 or 3. The rotation only mixes two rows,
+    // so this is 12 multiplications rather than a full product's 27.
+    mat3x3 rotated(int axis, T θ) const {
+        // axis 1 mixes rows 1 and 2, axis 2 rows 2 and 0, axis 3 rows 0 and 1
+        const std::size_t i = axis % 3, j = (axis + 1) % 3;
+        const T s = mmm::sin(θ), c = mmm::cos(θ);
+        mat3x3 m(*this);
+        for (std::size_t k = 0; k < 3; ++k) {
+            m.elems[i][k] = c * elems[i][k] + s * elems[j][k];
+            m.elems[j][k] = c * elems[j][k] - s * elems[i][k];
+        }
+        return m;
+    }
+
+    // R_a(θ_a) R_b(θ_b) ... R_z(θ_z) as one matrix, eg. R_seq<1, 3, 1>(ε, -ψ, -ε)
+    // for R_1(ε) R_3(-ψ) R_1(-ε), applying the rotations right to left with rotated()
+    // instead of multiplying out the full matrices
+    template <int... Axes, typename... Angles>
+    static mat3x3 R_seq(Angles... θs) {
+        static_assert(sizeof...(Axes) == sizeof...(Angles) && sizeof...(Axes) > 0, "one angle per axis");
+        static_assert(((Axes >= 1 && Axes <= 3) && ...), "axes are 1, 2 or 3");
+        constexpr int axes[] = {Axes...};
+        const T angles[] = {static_cast<T>(θs)...};
+        constexpr std::size_t last = sizeof...(Axes) - 1;
+        mat3x3 m = axes[last] == 1 ? R_1(angles[last]) : axes[last] == 2 ? R_2(angles[last]) : R_3(angles[last]);
+        for (std::size_t k = last; k-- > 0;) {
+            m = m.rotated(axes[k], angles[k]);
+        }
+        return m;
+    }
+
+    static constexpr mat3x3 R_0(T α, T θ_1, T θ_2, T θ_3) {
         //const mat3x3 r_1 = R_1(θ_1);
         //const mat3x3 r_2 = R_2(θ_2);
         //const mat3x3 r_3 = R_3(θ_3);
-        return {
+        return {{
             {   α, -θ_3,  θ_2},
             { θ_3,    α, -θ_1},
             {-θ_2,  θ_1,    α},
-            };
+            }};
         }
-    static constexpr mat3x3 R_1(long double θ) {
-        const long double sin_θ = sinl(θ);
-        const long double cos_θ = cosl(θ);
-        return {
-            {1.0q,   0.0q,  0.0q},
-            {0.0q,  cos_θ, sin_θ},
-            {0.0q, -sin_θ, cos_θ},
-            };
+    static constexpr mat3x3 R_1(T θ) {
+        const T sin_θ = mmm::sin(θ);
+        const T cos_θ = mmm::cos(θ);
+        return {{
+            {T(1),   T(0),  T(0)},
+            {T(0),  cos_θ, sin_θ},
+            {T(0), -sin_θ, cos_θ},
+            }};
         }
-    static constexpr mat3x3 R_2(long double θ) {
-        const long double sin_θ = sinl(θ);
-        const long double cos_θ = cosl(θ);
-        return {
-            {cos_θ, 0.0q, -sin_θ},
-            { 0.0q, 1.0q,   0.0q},
-            {sin_θ, 0.0q,  cos_θ},
-            };
+    static constexpr mat3x3 R_2(T θ) {
+        const T sin_θ = mmm::sin(θ);
+        const T cos_θ = mmm::cos(θ);
+        return {{
+            {cos_θ, T(0), -sin_θ},
+            { T(0), T(1),   T(0)},
+            {sin_θ, T(0),  cos_θ},
+            }};
         }
-    static constexpr mat3x3 R_3(long double θ) {
-        const long double sin_θ = sinl(θ);
-        const long double cos_θ = cosl(θ);
-        return {
-            { cos_θ, sin_θ, 0.0q},
-            {-sin_θ, cos_θ, 0.0q},
-            {  0.0q,  0.0q, 1.0q},
-            };
+    static constexpr mat3x3 R_3(T θ) {
+        const T sin_θ = mmm::sin(θ);
+        const T cos_θ = mmm::cos(θ);
+        return {{
+            { cos_θ, sin_θ, T(0)},
+            {-sin_θ, cos_θ, T(0)},
+            {  T(0),  T(0), T(1)},
+            }};
     }
 };
 
@@ -456,53 +573,59 @@ struct spacexfrm2d : public spacexfrm<cartesian2dvec, cylindrical2dvec, mat3x3q_
 	}
 };
 
-struct cartesian3dvec : public vec3q_t
+template <typename T>
+struct basic_cartesian3dvec : public vec3<T>
 {
+    typedef T TT;
 	constexpr TT x() const { return this->raw[0]; }
 	constexpr TT y() const { return this->raw[1]; }
 	constexpr TT z() const { return this->raw[2]; }
 	TT mag() const {
-		return sqrtl(dotP(*this));
+		return mmm::sqrt(this->dotP(*this));
 	}
 	TT phase() const {
-		return atanl(y()/x());
+		return mmm::atan(y()/x());
 	}
     TT normalPhase() const {
         const TT phase = this->phase();
         if (phase < 0) {
-            return phase + MMM_2_PI;
+            return phase + TT(MMM_2_PI);
         } else {
             return phase;
         }
     }
-	cartesian3dvec sum(const cartesian3dvec &v) const {
+	basic_cartesian3dvec sum(const basic_cartesian3dvec &v) const {
         return {{x()+v.x(), y()+v.y(), z()+v.z()}};
 	}
-	cartesian3dvec normalize() const {
+	basic_cartesian3dvec normalize() const {
 		const TT mag = this->mag();
         return {{x()/mag, y()/mag, z()/mag}};
 	}
-	TT angle(const cartesian3dvec &v) const {
-		return acosl(dotP(v)/(mag() * v.mag()));
+	TT angle(const basic_cartesian3dvec &v) const {
+		return mmm::acos(this->dotP(v)/(mag() * v.mag()));
 	}
 };
 
-struct spherical3dvec : public vec3q_t
+typedef basic_cartesian3dvec<long double> cartesian3dvec;
+
+template <typename T>
+struct basic_spherical3dvec : public vec3<T>
 {
+    typedef T TT;
     constexpr TT r() const { return this->raw[0]; }
     constexpr TT θ() const { return this->raw[1]; }
     constexpr TT ø() const { return this->raw[2]; }
     constexpr TT mag() const {
         return r();
     }
-    spherical3dvec sum(const spherical3dvec &v) const {
+    basic_spherical3dvec sum(const basic_spherical3dvec &v) const {
         return {this->r() + v.r(), this->θ() + v.θ(), this->ø() + v.ø()};
     }
-    spherical3dvec diff(const spherical3dvec &v) const {
+    basic_spherical3dvec diff(const basic_spherical3dvec &v) const {
         return {this->r() - v.r(), this->θ() - v.θ(), this->ø() - v.ø()};
     }
-    constexpr spherical3dvec normalize() const {
-        return {1.0q, θ(), ø()};
+    constexpr basic_spherical3dvec normalize() const {
+        return {TT(1), θ(), ø()};
     }
     // not really such a thing in spherical coordinates, but there is
     // if we ignore z and pretend it's cylindrical, which is generally
@@ -513,134 +636,331 @@ struct spherical3dvec : public vec3q_t
     constexpr TT normalPhase() const {
         const TT phase = θ();
         if (phase < 0) {
-            return phase + MMM_2_PI;
+            return phase + TT(MMM_2_PI);
         } else {
             return phase;
         }
     }
-    spherical3dvec normalDiff(const spherical3dvec &v) const {
+    basic_spherical3dvec normalDiff(const basic_spherical3dvec &v) const {
         return this->normalize().diff(v.normalize());
     }
-    TT normalDistance(const spherical3dvec &v) const {
-        const spherical3dvec normalThis = this->normalize();
-        const spherical3dvec normalV = v.normalize();
-        return sqrtl(2.0q - 2.0q * (sinl(this->θ()) * sinl(v.θ()) * cosl(this->ø() - v.ø()) + cosl(this->θ()) * cosl(v.θ())));
+    TT normalDistance(const basic_spherical3dvec &v) const {
+        return mmm::sqrt(TT(2) - TT(2) * (mmm::sin(this->θ()) * mmm::sin(v.θ()) * mmm::cos(this->ø() - v.ø()) + mmm::cos(this->θ()) * mmm::cos(v.θ())));
     }
     // ignoring ø for now keep it simple see above
-    TT angle(const spherical3dvec &v) const {
-        const TT diff = fmodl(phase() - v.phase(), MMM_2_PI);
-        if (diff < 0.0q) {
-            return diff + MMM_2_PI;
+    TT angle(const basic_spherical3dvec &v) const {
+        const TT diff = mmm::fmod(phase() - v.phase(), TT(MMM_2_PI));
+        if (diff < TT(0)) {
+            return diff + TT(MMM_2_PI);
         } else {
             return diff;
         }
     }
 };
 
-struct spacexfrm3d : public spacexfrm<cartesian3dvec, spherical3dvec, mat3x3q_t>
+typedef basic_spherical3dvec<long double> spherical3dvec;
+
+template <typename T>
+struct basic_spacexfrm3d : public spacexfrm<basic_cartesian3dvec<T>, basic_spherical3dvec<T>, mat3x3<T>>
 {
-    static spherical3dvec cart2sph(const cartesian3dvec &p) {
-        return spherical3dvec {{p.mag(), atan2l(sqrtl(p.x()*p.x()+p.y()*p.y()), p.z()), atan2l(p.y(), p.x())}};
+    static basic_spherical3dvec<T> cart2sph(const basic_cartesian3dvec<T> &p) {
+        return basic_spherical3dvec<T> {{p.mag(), mmm::atan2(mmm::sqrt(p.x()*p.x()+p.y()*p.y()), p.z()), mmm::atan2(p.y(), p.x())}};
     }
-    static cylindrical2dvec cart2cyl(const cartesian3dvec &v) {
-        const spherical3dvec sph = cart2sph(v);
+    static cylindrical2dvec cart2cyl(const basic_cartesian3dvec<T> &v) {
+        const basic_spherical3dvec<T> sph = cart2sph(v);
         return cylindrical2dvec {{sph.θ(), sph.ø()}};
     }
-    static cartesian3dvec sph2cart(const spherical3dvec &p) {
-        const long double sin_θ = sinl(p.θ());
-        const long double cos_θ = cosl(p.θ());
-        const long double sin_ø = sinl(p.ø());
-        const long double cos_ø = cosl(p.ø());
+    static basic_cartesian3dvec<T> sph2cart(const basic_spherical3dvec<T> &p) {
+        const T sin_θ = mmm::sin(p.θ());
+        const T cos_θ = mmm::cos(p.θ());
+        const T sin_ø = mmm::sin(p.ø());
+        const T cos_ø = mmm::cos(p.ø());
         // https://www.web-formulas.com/Math_Formulas/Linear_Algebra_Transform_from_Cartesian_to_Spherical_Coordinate.aspx
-        const long double m[3][3] = {
+        const T m[3][3] = {
             {sin_θ*cos_ø, cos_θ*cos_ø, -sin_ø,},
             {sin_θ*sin_ø, cos_θ*sin_ø,  cos_ø,},
-            {      cos_θ,      -sin_θ,   0.0q,},
+            {      cos_θ,      -sin_θ,   T(0),},
             };
-        mat3x3q_t xfrm(m);
-        const vec3q_t q = xfrm.mul(p);
-        return cartesian3dvec {{q.raw[0], q.raw[1], q.raw[2]}};
+        mat3x3<T> xfrm(m);
+        const vec3<T> q = xfrm.mul(p);
+        return basic_cartesian3dvec<T> {{q.raw[0], q.raw[1], q.raw[2]}};
     }
 };
 
-template <typename VecT, typename T=long double>
-struct funmat {};
+typedef basic_spacexfrm3d<long double> spacexfrm3d;
 
-template <typename VecT, typename T=long double>
-struct funmat3x3 : public funmat<VecT, T>
+/*
+ * Symbolic 3x3 matrices whose elements are functions of the vector they're
+ * applied to, as expression templates. Each element is a type built from the
+ * terms below, so multiplying two matrices multiplies out their elements at
+ * compile time (dropping zeros and ones as it goes), and applying one to a
+ * vector compiles to a single routine that takes each sine and cosine the
+ * matrix uses once and then does the 3x3 product.
+ */
+namespace funexpr {
+
+struct term {};
+
+template <typename E>
+inline constexpr bool is_term_v = std::is_base_of_v<term, E>;
+
+// the vector's components and their trig functions, computed once per vector
+// for whichever ones the expression uses
+template <typename T, unsigned Trig>
+struct context
 {
-    typedef T TT;
-    typedef VecT VecTT;
-    typedef mat3x3q_t XfrmMatrixT;
-    typedef std::function<T(const VecTT&, int, int)> coeffun;
-
-        static constexpr coeffun ident = [](const VecTT &v, int r, int c) -> T { return r == c ? v.raw[r] : T(0.0); };
-    static constexpr coeffun zero = [](const VecT &, int, int) -> T { return T(0.0); };
-    static constexpr coeffun one = [](const VecT &, int, int) -> T { return T(1.0); };
-    static constexpr coeffun sine = [](const VecT &v, int r, int c) -> T { return r == c ? sinl(v.raw[r]) : T(0.0); };
-    static constexpr coeffun cosine = [](const VecT &v, int r, int c) -> T { return r == c ? cosl(v.raw[r]) : T(0.0); };
-
-        static constexpr coeffun sinθ = [](const spherical3dvec&v, int, int) -> TT { return sinl(v.θ()); };
-    static constexpr coeffun sinø = [](const spherical3dvec&v, int, int) -> TT { return sinl(v.ø()); };
-    static constexpr coeffun cosθ = [](const spherical3dvec&v, int, int) -> TT { return cosl(v.θ()); };
-    static constexpr coeffun cosø = [](const spherical3dvec&v, int, int) -> TT { return cosl(v.ø()); };
-    static constexpr coeffun sinθcosø = [](const spherical3dvec&v, int, int) -> TT { return sinl(v.θ()) * cosl(v.ø()); };
-    static constexpr coeffun cosθcosø = [](const spherical3dvec&v, int, int) -> TT { return cosl(v.θ()) * cosl(v.ø()); };
-    static constexpr coeffun sinθsinø = [](const spherical3dvec&v, int, int) -> TT { return sinl(v.θ()) * sinl(v.ø()); };
-    static constexpr coeffun cosθsinø = [](const spherical3dvec&v, int, int) -> TT { return cosl(v.θ()) * sinl(v.ø()); };
-
-        static constexpr XfrmMatrixT identitymatrix = {
-            {  one, zero, zero },
-            { zero,  one, zero },
-            { zero, zero,  one },
-            };
+    T v[3];
+    T s[3] = {};
+    T c[3] = {};
 
-        static constexpr XfrmMatrixT R_1_mtrx ={
-            {  one,  zero, zero },
-            { zero,  cosθ, sinθ },
-            { zero, -sinθ, cosθ },
-            };
+    template <typename VecT>
+    explicit context(const VecT &vec) : v{vec.raw[0], vec.raw[1], vec.raw[2]} {
+        fill<0>();
+        fill<1>();
+        fill<2>();
+    }
 
-        static constexpr XfrmMatrixT R_2_mtrx = {
-            { cosθ, zero, -sinθ },
-            { zero,  one,  zero },
-            { sinθ, zero,  cosθ },
-            };
+    template <std::size_t I>
+    void fill() {
+        if constexpr ((Trig & (1u << I)) != 0) {
+            s[I] = mmm::sin(v[I]);
+        }
+        if constexpr ((Trig & (8u << I)) != 0) {
+            c[I] = mmm::cos(v[I]);
+        }
+    }
+};
 
-        static constexpr XfrmMatrixT R_3_mtrx = {
-            {  cosθ, sinθ, zero },
-            { -sinθ, cosθ, zero },
-            {  zero, zero,  one },
-            };
+// terms that don't depend on where in the matrix they are bind to themselves
+template <typename Self>
+struct unbound : term
+{
+    template <std::size_t R, std::size_t C>
+    using at = Self;
+};
 
-        static constexpr XfrmMatrixT sph2cart_mtrx = {
-            { sinθcosø, cosθcosø, -sinø },
-            { sinθsinø, cosθsinø,  cosø },
-            {     cosθ,    -sinθ,  zero },
-            };
+struct zero : unbound<zero>
+{
+    static constexpr unsigned trig = 0;
+    template <typename Ctx>
+    static constexpr auto eval(const Ctx &c) { return std::remove_cvref_t<decltype(c.v[0])>(0); }
+};
 
-    XfrmMatrixT xfrmmtrx = identitymatrix;
+struct one : unbound<one>
+{
+    static constexpr unsigned trig = 0;
+    template <typename Ctx>
+    static constexpr auto eval(const Ctx &c) { return std::remove_cvref_t<decltype(c.v[0])>(1); }
+};
 
-    void setxfrmmtrx(const XfrmMatrixT &mtrx) {
-        xfrmmtrx = mtrx;
-    }
+template <std::size_t I>
+struct component : unbound<component<I>>
+{
+    static constexpr unsigned trig = 0;
+    template <typename Ctx>
+    static constexpr auto eval(const Ctx &c) { return c.v[I]; }
+};
 
-        VecT mul(const VecT &v) const {
-        return {
-            xfrmmtrx.elems[0][0](v, 0, 0) * v.raw[0] + xfrmmtrx.elems[0][1](v, 0, 1) * v.raw[1] + xfrmmtrx.elems[0][2](v, 0, 2) * v.raw[2],
-            xfrmmtrx.elems[1][0](v, 1, 0) * v.raw[0] + xfrmmtrx.elems[1][1](v, 1, 1) * v.raw[1] + xfrmmtrx.elems[1][2](v, 1, 2) * v.raw[2],
-            xfrmmtrx.elems[2][0](v, 2, 0) * v.raw[0] + xfrmmtrx.elems[2][1](v, 2, 1) * v.raw[1] + xfrmmtrx.elems[2][2](v, 2, 2) * v.raw[2],
-            };
-    }
+template <std::size_t I>
+struct sin_of : unbound<sin_of<I>>
+{
+    static constexpr unsigned trig = 1u << I;
+    template <typename Ctx>
+    static constexpr auto eval(const Ctx &c) { return c.s[I]; }
+};
 
-    XfrmMatrixT mul(const XfrmMatrixT &) const {
-        XfrmMatrixT product;
-        //product[0][0] = [](const VecT &v, int r, int c) -> T { return xfrmmtrx.elems[r][c](v,r,c) * m.elems[0][0](v,r,c); };
+template <std::size_t I>
+struct cos_of : unbound<cos_of<I>>
+{
+    static constexpr unsigned trig = 8u << I;
+    template <typename Ctx>
+    static constexpr auto eval(const Ctx &c) { return c.c[I]; }
+};
 
-        return {
-            //[](const VecT &v, int r, int c) -> T { return xfrmmtrx.elems[0][0](v,r,c) * m.elems[0][0](v,r,c); };
-        };
+template <typename A, typename B>
+struct product : unbound<product<A, B>>
+{
+    static constexpr unsigned trig = A::trig | B::trig;
+    template <typename Ctx>
+    static constexpr auto eval(const Ctx &c) { return A::eval(c) * B::eval(c); }
+};
+
+template <typename A, typename B>
+struct sum : unbound<sum<A, B>>
+{
+    static constexpr unsigned trig = A::trig | B::trig;
+    template <typename Ctx>
+    static constexpr auto eval(const Ctx &c) { return A::eval(c) + B::eval(c); }
+};
+
+template <typename A>
+struct negation : unbound<negation<A>>
+{
+    static constexpr unsigned trig = A::trig;
+    template <typename Ctx>
+    static constexpr auto eval(const Ctx &c) { return -A::eval(c); }
+};
+
+// f(v[r]) on the diagonal and zero elsewhere, for ident, sine and cosine
+template <template <std::size_t> class F>
+struct diagonal : term
+{
+    template <std::size_t R, std::size_t C>
+    using at = std::conditional_t<R == C, F<R>, zero>;
+};
+
+template <typename A, typename B> requires (is_term_v<A> && is_term_v<B>)
+constexpr auto operator*(A, B) {
+    if constexpr (std::is_same_v<A, zero> || std::is_same_v<B, zero>) {
+        return zero{};
+    } else if constexpr (std::is_same_v<A, one>) {
+        return B{};
+    } else if constexpr (std::is_same_v<B, one>) {
+        return A{};
+    } else {
+        return product<A, B>{};
+    }
+}
+
+template <typename A, typename B> requires (is_term_v<A> && is_term_v<B>)
+constexpr auto operator+(A, B) {
+    if constexpr (std::is_same_v<A, zero>) {
+        return B{};
+    } else if constexpr (std::is_same_v<B, zero>) {
+        return A{};
+    } else {
+        return sum<A, B>{};
+    }
+}
+
+template <typename A> requires is_term_v<A>
+constexpr auto operator-(A) {
+    if constexpr (std::is_same_v<A, zero>) {
+        return zero{};
+    } else {
+        return negation<A>{};
+    }
+}
+
+template <typename A>
+constexpr A operator-(negation<A>) {
+    return A{};
+}
+
+// elements in row-major order, already bound to their positions
+template <typename... E>
+struct matrix
+{
+    static_assert(sizeof...(E) == 9, "a 3x3 matrix has 9 elements");
+    typedef std::tuple<E...> elements;
+    static constexpr unsigned trig = (E::trig | ...);
+
+    template <std::size_t R, std::size_t C>
+    using elem = std::tuple_element_t<3 * R + C, elements>;
+
+    template <typename VecT>
+    VecT mul(const VecT &v) const {
+        typedef std::remove_cvref_t<decltype(v.raw[0])> T;
+        const context<T, trig> ctx(v);
+        return {{
+            elem<0, 0>::eval(ctx) * ctx.v[0] + elem<0, 1>::eval(ctx) * ctx.v[1] + elem<0, 2>::eval(ctx) * ctx.v[2],
+            elem<1, 0>::eval(ctx) * ctx.v[0] + elem<1, 1>::eval(ctx) * ctx.v[1] + elem<1, 2>::eval(ctx) * ctx.v[2],
+            elem<2, 0>::eval(ctx) * ctx.v[0] + elem<2, 1>::eval(ctx) * ctx.v[1] + elem<2, 2>::eval(ctx) * ctx.v[2],
+            }};
+    }
+
+    // the numbers for one vector, eg. to apply to others
+    template <typename VecT>
+    auto eval(const VecT &v) const {
+        typedef std::remove_cvref_t<decltype(v.raw[0])> T;
+        const context<T, trig> ctx(v);
+        return mat3x3<T>({
+            {elem<0, 0>::eval(ctx), elem<0, 1>::eval(ctx), elem<0, 2>::eval(ctx)},
+            {elem<1, 0>::eval(ctx), elem<1, 1>::eval(ctx), elem<1, 2>::eval(ctx)},
+            {elem<2, 0>::eval(ctx), elem<2, 1>::eval(ctx), elem<2, 2>::eval(ctx)},
+            });
+    }
+
+    template <typename... F>
+    constexpr auto mul(const matrix<F...> &) const {
+        return product_of<matrix<F...>>(std::make_index_sequence<9>());
+    }
+
+private:
+    template <typename M, std::size_t R, std::size_t C>
+    using dot = decltype(elem<R, 0>{} * typename M::template elem<0, C>{}
+                       + elem<R, 1>{} * typename M::template elem<1, C>{}
+                       + elem<R, 2>{} * typename M::template elem<2, C>{});
+
+    template <typename M, std::size_t... K>
+    static constexpr auto product_of(std::index_sequence<K...>) {
+        return matrix<dot<M, K / 3, K % 3>...>{};
     }
 };
 
+template <typename... E, std::size_t... K>
+constexpr auto bind(std::index_sequence<K...>) {
+    return matrix<typename E::template at<K / 3, K % 3>...>{};
+}
+
+// a matrix from nine terms, row by row
+template <typename... E> requires (sizeof...(E) == 9 && (is_term_v<E> && ...))
+constexpr auto make_matrix(E...) {
+    return bind<E...>(std::make_index_sequence<9>());
+}
+
+}
+
+template <typename VecT, typename T=long double>
+struct funmat {};
+
+// The coefficient terms and matrices by name. The θ and ø ones read components
+// 1 and 2 of a spherical vector (r, θ, ø).
+template <typename VecT, typename T=long double>
+struct funmat3x3 : public funmat<VecT, T>
+{
+    typedef T TT;
+    typedef VecT VecTT;
+
+    static constexpr funexpr::diagonal<funexpr::component> ident {};
+    static constexpr funexpr::zero zero {};
+    static constexpr funexpr::one one {};
+    static constexpr funexpr::diagonal<funexpr::sin_of> sine {};
+    static constexpr funexpr::diagonal<funexpr::cos_of> cosine {};
+
+    static constexpr funexpr::sin_of<1> sinθ {};
+    static constexpr funexpr::sin_of<2> sinø {};
+    static constexpr funexpr::cos_of<1> cosθ {};
+    static constexpr funexpr::cos_of<2> cosø {};
+    static constexpr auto sinθcosø = sinθ * cosø;
+    static constexpr auto cosθcosø = cosθ * cosø;
+    static constexpr auto sinθsinø = sinθ * sinø;
+    static constexpr auto cosθsinø = cosθ * sinø;
+
+    static constexpr auto identitymatrix = funexpr::make_matrix(
+          one, zero, zero,
+         zero,  one, zero,
+         zero, zero,  one);
+
+    static constexpr auto R_1_mtrx = funexpr::make_matrix(
+          one,  zero, zero,
+         zero,  cosθ, sinθ,
+         zero, -sinθ, cosθ);
+
+    static constexpr auto R_2_mtrx = funexpr::make_matrix(
+         cosθ, zero, -sinθ,
+         zero,  one,  zero,
+         sinθ, zero,  cosθ);
+
+    static constexpr auto R_3_mtrx = funexpr::make_matrix(
+          cosθ, sinθ, zero,
+         -sinθ, cosθ, zero,
+          zero, zero,  one);
+
+    static constexpr auto sph2cart_mtrx = funexpr::make_matrix(
+         sinθcosø, cosθcosø, -sinø,
+         sinθsinø, cosθsinø,  cosø,
+             cosθ,    -sinθ,  zero);
+};
+
 #endif /* PAULYC_LALGEBRA_HPP */
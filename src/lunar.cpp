@@ -0,0 +1,205 @@
+/**
+ * lunar.cpp
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#include "lunar.hpp"
+#include "solvers.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace github {
+namespace paulyc {
+
+namespace {
+
+static constexpr long double SAMPLE_STEP_JD = 1.0l;
+static constexpr long double EVENT_TOLERANCE_JD = 1e-8l;
+
+// geocentric moon in J2000 ecliptic coordinates with the rates we need:
+// r' = (p.v)/|p| for the apsides, and z, z' for the nodes
+struct MoonSample {
+    long double jd;
+    long double r;
+    long double dr;
+    long double z;
+    long double dz;
+    cartesian3dvec pos;
+};
+
+// Moon minus Sun in J2000 ecliptic longitude, radians in (-π, π], and its rate
+struct PhaseSample {
+    long double jd;
+    long double D;
+    long double dD;
+    long double λ;
+};
+
+// each phase and the value of D there
+static constexpr std::pair<LunarEvent::Kind, long double> PHASES[] = {
+    {LunarEvent::NewMoon, 0.0l},
+    {LunarEvent::FirstQuarter, MMM_PI / 2.0l},
+    {LunarEvent::FullMoon, MMM_PI},
+    {LunarEvent::LastQuarter, -MMM_PI / 2.0l},
+};
+
+PhaseSample samplePhase(JPLEphems &ephems, long double jd) {
+    const split_jd_clock::time_point t = split_jd_clock::from_jd(jd_clock::time_point(jd_clock::duration(jd)));
+    long double λ[2], dλ[2];
+    const JPLEphems::Point bodies[2] = {JPLEphems::Moon, JPLEphems::Sun};
+    for (int i = 0; i < 2; ++i) {
+        const JPLEphems::State s = ephems.get_state(t, JPLEphems::Earth, bodies[i], true);
+        const cartesian3dvec p = equatorialToEcliptic(s.position());
+        const cartesian3dvec v = equatorialToEcliptic(s.velocity());
+        λ[i] = atan2l(p.y(), p.x());
+        dλ[i] = (p.x() * v.y() - p.y() * v.x()) / (p.x() * p.x() + p.y() * p.y());
+    }
+    return PhaseSample {jd, wrapAngle(λ[0] - λ[1]), dλ[0] - dλ[1], λ[0] < 0.0l ? λ[0] + MMM_2_PI : λ[0]};
+}
+
+MoonSample sampleMoon(JPLEphems &ephems, long double jd) {
+    const JPLEphems::State s = ephems.get_state(static_cast<double>(jd), JPLEphems::Earth, JPLEphems::Moon, true);
+    const cartesian3dvec p = equatorialToEcliptic(s.position());
+    const cartesian3dvec v = equatorialToEcliptic(s.velocity());
+    const long double r = p.mag();
+    return MoonSample {jd, r, p.dotP(v) / r, p.z(), v.z(), p};
+}
+
+}
+
+std::vector<LunarEvent> findLunarEvents(JPLEphems &ephems, const jd_clock::time_point &from, const jd_clock::time_point &to, unsigned kinds) {
+    std::vector<LunarEvent> events;
+    const long double jd_from = from.time_since_epoch().count();
+    const long double jd_to = to.time_since_epoch().count();
+    const long double au_km = ephems.au_km();
+
+    // r' has no closed-form derivative without accelerations, so its root is found
+    // derivative-free; z has z' straight from the ephemeris so it gets Newton
+    auto dr_at = [&ephems](long double jd) -> long double {
+        return sampleMoon(ephems, jd).dr;
+    };
+    auto z_at = [&ephems](long double jd) -> std::pair<long double, long double> {
+        const MoonSample s = sampleMoon(ephems, jd);
+        return {s.z, s.dz};
+    };
+
+    // a phases-only search never needs the Moon's distance or latitude
+    const bool moon = kinds & (LunarEvent::Apsides | LunarEvent::Nodes);
+    const bool phases = kinds & LunarEvent::Phases;
+    MoonSample prev = moon ? sampleMoon(ephems, jd_from) : MoonSample {};
+    PhaseSample prevPhase = phases ? samplePhase(ephems, jd_from) : PhaseSample {};
+    for (long double jd_prev = jd_from; jd_prev < jd_to; ) {
+        const long double jd_next = std::min(jd_prev + SAMPLE_STEP_JD, jd_to);
+        const MoonSample next = moon ? sampleMoon(ephems, jd_next) : MoonSample {};
+
+        // D gains ~12° a day, so a step crosses each quarter at most once, and Newton has its rate
+        if (phases) {
+            const PhaseSample nextPhase = samplePhase(ephems, jd_next);
+            for (const auto &phase : PHASES) {
+                const LunarEvent::Kind kind = phase.first;
+                const long double target = phase.second;
+                const long double a = wrapAngle(prevPhase.D - target), b = wrapAngle(nextPhase.D - target);
+                if ((kinds & kind) && a < 0.0l && b >= 0.0l && b - a < MMM_PI) {
+                    auto g = [&ephems, target](long double jd) -> std::pair<long double, long double> {
+                        const PhaseSample s = samplePhase(ephems, jd);
+                        return {wrapAngle(s.D - target), s.dD};
+                    };
+                    const SolverResult<long double> jd = newton_root(g, prevPhase.jd, nextPhase.jd, a, b, EVENT_TOLERANCE_JD);
+                    if (jd) {
+                        events.push_back(LunarEvent {kind, jd_clock::time_point(jd_clock::duration(jd.x)), samplePhase(ephems, jd.x).λ});
+                    }
+                }
+            }
+            prevPhase = nextPhase;
+        }
+
+        if (moon && (kinds & LunarEvent::Apsides) && (prev.dr < 0.0l) != (next.dr < 0.0l)) {
+            const LunarEvent::Kind kind = prev.dr < 0.0l ? LunarEvent::Perigee : LunarEvent::Apogee;
+            if (kinds & kind) {
+                const SolverResult<long double> jd = brent_root(dr_at, prev.jd, next.jd, prev.dr, next.dr, EVENT_TOLERANCE_JD);
+                if (jd) {
+                    const long double r = sampleMoon(ephems, jd.x).r;
+                    events.push_back(LunarEvent {kind, jd_clock::time_point(jd_clock::duration(jd.x)), r * au_km});
+                }
+            }
+        }
+
+        if (moon && (kinds & LunarEvent::Nodes) && (prev.z < 0.0l) != (next.z < 0.0l)) {
+            const LunarEvent::Kind kind = prev.z < 0.0l ? LunarEvent::AscendingNode : LunarEvent::DescendingNode;
+            if (kinds & kind) {
+                const SolverResult<long double> jd = newton_root(z_at, prev.jd, next.jd, prev.z, next.z, EVENT_TOLERANCE_JD);
+                if (jd) {
+                    const cartesian3dvec p = sampleMoon(ephems, jd.x).pos;
+                    long double λ = atan2l(p.y(), p.x());
+                    if (λ < 0.0l) {
+                        λ += MMM_2_PI;
+                    }
+                    events.push_back(LunarEvent {kind, jd_clock::time_point(jd_clock::duration(jd.x)), λ});
+                }
+            }
+        }
+
+        prev = next;
+        jd_prev = jd_next;
+    }
+
+    std::sort(events.begin(), events.end(), [](const LunarEvent &a, const LunarEvent &b) {
+        return a.jd < b.jd;
+    });
+    return events;
+}
+
+std::ostream& operator<<(std::ostream &os, const LunarEvent &ev) {
+    using ::operator<<;
+    jd_clock::time_point jd = ev.jd;
+    os << jd_clock::to_system_clock(jd);
+    switch (ev.kind) {
+    case LunarEvent::Perigee:
+        os << " perigee " << ev.value << " km";
+        break;
+    case LunarEvent::Apogee:
+        os << " apogee " << ev.value << " km";
+        break;
+    case LunarEvent::AscendingNode:
+        os << " ascending node λ " << ev.value * 180.0l / MMM_PI;
+        break;
+    case LunarEvent::DescendingNode:
+        os << " descending node λ " << ev.value * 180.0l / MMM_PI;
+        break;
+    case LunarEvent::NewMoon:
+        os << " new moon λ " << ev.value * 180.0l / MMM_PI;
+        break;
+    case LunarEvent::FullMoon:
+        os << " full moon λ " << ev.value * 180.0l / MMM_PI;
+        break;
+    case LunarEvent::FirstQuarter:
+        os << " first quarter λ " << ev.value * 180.0l / MMM_PI;
+        break;
+    case LunarEvent::LastQuarter:
+        os << " last quarter λ " << ev.value * 180.0l / MMM_PI;
+        break;
+    default:
+        os << " unknown lunar event";
+        break;
+    }
+    return os;
+}
+
+}
+}
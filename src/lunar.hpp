@@ -0,0 +1,69 @@
+/**
+ * lunar.hpp
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#ifndef PAULYC_LUNAR_HPP
+#define PAULYC_LUNAR_HPP
+
+#include "astro.hpp"
+
+#include <vector>
+
+namespace github {
+namespace paulyc {
+
+struct LunarEvent {
+    enum Kind {
+        Perigee        = 1 << 0,
+        Apogee         = 1 << 1,
+        AscendingNode  = 1 << 2,
+        DescendingNode = 1 << 3,
+        NewMoon        = 1 << 4,
+        FullMoon       = 1 << 5,
+        FirstQuarter   = 1 << 6,
+        LastQuarter    = 1 << 7,
+
+        Apsides  = Perigee | Apogee,
+        Nodes    = AscendingNode | DescendingNode,
+        Quarters = FirstQuarter | LastQuarter,
+        Phases   = NewMoon | FullMoon | Quarters,
+        All      = Apsides | Nodes | Phases,
+    };
+
+    Kind kind;
+    jd_clock::time_point jd;
+    // geocentric distance in km for apsides, J2000 ecliptic longitude in radians for
+    // nodes and phases
+    long double value;
+};
+
+// Every perigee, apogee, ecliptic node crossing and phase in [from, to), in time order.
+// New moon, first quarter, full moon and last quarter are where the geocentric J2000
+// ecliptic longitude of the Moon is 0°, 90°, 180° and 270° ahead of the Sun's. The
+// range is sampled once a day (the closest events of a kind, the quarters, are ~7.4
+// days apart) and every bracketed event is then solved to ~1ms against the ephemeris
+// velocities, never stepping minutes. Only the samples the kinds asked for need are taken.
+std::vector<LunarEvent> findLunarEvents(JPLEphems &ephems, const jd_clock::time_point &from, const jd_clock::time_point &to, unsigned kinds = LunarEvent::All);
+
+std::ostream& operator<<(std::ostream &os, const LunarEvent &ev);
+
+}
+}
+
+#endif /* PAULYC_LUNAR_HPP */
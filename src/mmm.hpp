@@ -0,0 +1,246 @@
+/**
+ * mmm.hpp
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#ifndef PAULYC_MMM_HPP
+#define PAULYC_MMM_HPP
+
+#include <cmath>
+#include <type_traits>
+
+#include "quadmath.h"
+
+/*
+ * Math shims so the same template code runs on double, long double, __float128
+ * and dual numbers: mmm::sin(x) is sin, sinl or sinq by the type of x, and for
+ * the dual types below carries the derivatives along by the chain rule.
+ *
+ * dual<T> is value + first derivative, dual2<T> adds the second. Seed an input
+ * with its known rate (eg. an ephemeris position and velocity) and every result
+ * computed from it comes out with its exact rate too, for about twice the cost of
+ * the plain evaluation instead of the three or more a finite difference needs,
+ * and with no step size to choose.
+ */
+namespace mmm {
+
+template <typename S>
+inline constexpr bool is_scalar_v = std::is_arithmetic_v<S> || std::is_same_v<S, __float128>;
+
+#define MMM_SCALAR_FUN1(name, d, l, q) \
+    inline double name(double x) { return ::d(x); } \
+    inline long double name(long double x) { return ::l(x); } \
+    inline __float128 name(__float128 x) { return ::q(x); }
+
+#define MMM_SCALAR_FUN2(name, d, l, q) \
+    inline double name(double x, double y) { return ::d(x, y); } \
+    inline long double name(long double x, long double y) { return ::l(x, y); } \
+    inline __float128 name(__float128 x, __float128 y) { return ::q(x, y); }
+
+MMM_SCALAR_FUN1(sin, sin, sinl, sinq)
+MMM_SCALAR_FUN1(cos, cos, cosl, cosq)
+MMM_SCALAR_FUN1(tan, tan, tanl, tanq)
+MMM_SCALAR_FUN1(asin, asin, asinl, asinq)
+MMM_SCALAR_FUN1(acos, acos, acosl, acosq)
+MMM_SCALAR_FUN1(atan, atan, atanl, atanq)
+MMM_SCALAR_FUN1(sqrt, sqrt, sqrtl, sqrtq)
+MMM_SCALAR_FUN1(exp, exp, expl, expq)
+MMM_SCALAR_FUN1(log, log, logl, logq)
+MMM_SCALAR_FUN1(fabs, fabs, fabsl, fabsq)
+MMM_SCALAR_FUN1(floor, floor, floorl, floorq)
+MMM_SCALAR_FUN2(atan2, atan2, atan2l, atan2q)
+MMM_SCALAR_FUN2(fmod, fmod, fmodl, fmodq)
+
+#undef MMM_SCALAR_FUN1
+#undef MMM_SCALAR_FUN2
+
+template <typename T>
+struct dual
+{
+    typedef T value_type;
+    T v;
+    T d;
+
+    constexpr dual() : v(0), d(0) {}
+    constexpr dual(T value, T derivative = T(0)) : v(value), d(derivative) {}
+    template <typename S, typename = std::enable_if_t<is_scalar_v<S> && !std::is_same_v<S, T>>>
+    constexpr dual(S value) : v(T(value)), d(T(0)) {}
+
+    // the independent variable, d/dx x = 1
+    static constexpr dual variable(T x) { return dual(x, T(1)); }
+};
+
+template <typename T>
+struct dual2
+{
+    typedef T value_type;
+    T v;
+    T d;
+    T dd;
+
+    constexpr dual2() : v(0), d(0), dd(0) {}
+    constexpr dual2(T value, T derivative = T(0), T second = T(0)) : v(value), d(derivative), dd(second) {}
+    template <typename S, typename = std::enable_if_t<is_scalar_v<S> && !std::is_same_v<S, T>>>
+    constexpr dual2(S value) : v(T(value)), d(T(0)), dd(T(0)) {}
+
+    static constexpr dual2 variable(T x) { return dual2(x, T(1), T(0)); }
+};
+
+template <typename D> struct is_dual : std::false_type {};
+template <typename T> struct is_dual<dual<T>> : std::true_type {};
+template <typename T> struct is_dual<dual2<T>> : std::true_type {};
+
+template <typename D, typename R = D>
+using if_dual_t = std::enable_if_t<is_dual<D>::value, R>;
+template <typename D, typename S, typename R = D>
+using if_dual_scalar_t = std::enable_if_t<is_dual<D>::value && is_scalar_v<S>, R>;
+
+// f(u) given f, f' and f'' at u.v
+template <typename T>
+constexpr dual<T> chain(const dual<T> &u, T f0, T f1, T) {
+    return dual<T>(f0, f1 * u.d);
+}
+template <typename T>
+constexpr dual2<T> chain(const dual2<T> &u, T f0, T f1, T f2) {
+    return dual2<T>(f0, f1 * u.d, f2 * u.d * u.d + f1 * u.dd);
+}
+
+// arithmetic
+
+template <typename T> constexpr dual<T> operator-(const dual<T> &a) { return dual<T>(-a.v, -a.d); }
+template <typename T> constexpr dual<T> operator+(const dual<T> &a, const dual<T> &b) { return dual<T>(a.v + b.v, a.d + b.d); }
+template <typename T> constexpr dual<T> operator-(const dual<T> &a, const dual<T> &b) { return dual<T>(a.v - b.v, a.d - b.d); }
+template <typename T> constexpr dual<T> operator*(const dual<T> &a, const dual<T> &b) { return dual<T>(a.v * b.v, a.d * b.v + a.v * b.d); }
+template <typename T> constexpr dual<T> operator/(const dual<T> &a, const dual<T> &b) {
+    const T q = a.v / b.v;
+    return dual<T>(q, (a.d - q * b.d) / b.v);
+}
+
+template <typename T> constexpr dual2<T> operator-(const dual2<T> &a) { return dual2<T>(-a.v, -a.d, -a.dd); }
+template <typename T> constexpr dual2<T> operator+(const dual2<T> &a, const dual2<T> &b) { return dual2<T>(a.v + b.v, a.d + b.d, a.dd + b.dd); }
+template <typename T> constexpr dual2<T> operator-(const dual2<T> &a, const dual2<T> &b) { return dual2<T>(a.v - b.v, a.d - b.d, a.dd - b.dd); }
+template <typename T> constexpr dual2<T> operator*(const dual2<T> &a, const dual2<T> &b) {
+    return dual2<T>(a.v * b.v, a.d * b.v + a.v * b.d, a.dd * b.v + T(2) * a.d * b.d + a.v * b.dd);
+}
+template <typename T> constexpr dual2<T> operator/(const dual2<T> &a, const dual2<T> &b) {
+    const T r = T(1) / b.v;
+    return a * chain(b, r, -r * r, T(2) * r * r * r);
+}
+
+// with plain scalars, which are constants
+
+template <typename D, typename S> constexpr if_dual_scalar_t<D, S> operator+(const D &a, S b) { return a + D(b); }
+template <typename D, typename S> constexpr if_dual_scalar_t<D, S> operator+(S a, const D &b) { return D(a) + b; }
+template <typename D, typename S> constexpr if_dual_scalar_t<D, S> operator-(const D &a, S b) { return a - D(b); }
+template <typename D, typename S> constexpr if_dual_scalar_t<D, S> operator-(S a, const D &b) { return D(a) - b; }
+template <typename D, typename S> constexpr if_dual_scalar_t<D, S> operator*(const D &a, S b) { return a * D(b); }
+template <typename D, typename S> constexpr if_dual_scalar_t<D, S> operator*(S a, const D &b) { return D(a) * b; }
+template <typename D, typename S> constexpr if_dual_scalar_t<D, S> operator/(const D &a, S b) { return a / D(b); }
+template <typename D, typename S> constexpr if_dual_scalar_t<D, S> operator/(S a, const D &b) { return D(a) / b; }
+
+template <typename D> constexpr if_dual_t<D, D&> operator+=(D &a, const D &b) { return a = a + b; }
+template <typename D> constexpr if_dual_t<D, D&> operator-=(D &a, const D &b) { return a = a - b; }
+template <typename D> constexpr if_dual_t<D, D&> operator*=(D &a, const D &b) { return a = a * b; }
+template <typename D> constexpr if_dual_t<D, D&> operator/=(D &a, const D &b) { return a = a / b; }
+
+// comparisons are on the value alone
+
+#define MMM_DUAL_COMPARISON(op) \
+    template <typename D> constexpr if_dual_t<D, bool> operator op(const D &a, const D &b) { return a.v op b.v; } \
+    template <typename D, typename S> constexpr if_dual_scalar_t<D, S, bool> operator op(const D &a, S b) { return a.v op b; } \
+    template <typename D, typename S> constexpr if_dual_scalar_t<D, S, bool> operator op(S a, const D &b) { return a op b.v; }
+
+MMM_DUAL_COMPARISON(<)
+MMM_DUAL_COMPARISON(>)
+MMM_DUAL_COMPARISON(<=)
+MMM_DUAL_COMPARISON(>=)
+MMM_DUAL_COMPARISON(==)
+MMM_DUAL_COMPARISON(!=)
+
+#undef MMM_DUAL_COMPARISON
+
+// functions
+
+template <typename D> if_dual_t<D> sin(const D &u) {
+    const auto s = sin(u.v);
+    const auto c = cos(u.v);
+    return chain(u, s, c, -s);
+}
+template <typename D> if_dual_t<D> cos(const D &u) {
+    const auto s = sin(u.v);
+    const auto c = cos(u.v);
+    return chain(u, c, -s, -c);
+}
+template <typename D> if_dual_t<D> tan(const D &u) {
+    const auto t = tan(u.v);
+    const auto sec2 = 1 + t * t;
+    return chain(u, t, sec2, 2 * t * sec2);
+}
+template <typename D> if_dual_t<D> asin(const D &u) {
+    const auto r = 1 / sqrt(1 - u.v * u.v);
+    return chain(u, asin(u.v), r, u.v * r * r * r);
+}
+template <typename D> if_dual_t<D> acos(const D &u) {
+    const auto r = 1 / sqrt(1 - u.v * u.v);
+    return chain(u, acos(u.v), -r, -u.v * r * r * r);
+}
+template <typename D> if_dual_t<D> atan(const D &u) {
+    const auto r = 1 / (1 + u.v * u.v);
+    return chain(u, atan(u.v), r, -2 * u.v * r * r);
+}
+template <typename D> if_dual_t<D> sqrt(const D &u) {
+    const auto s = sqrt(u.v);
+    return chain(u, s, 1 / (2 * s), -1 / (4 * s * u.v));
+}
+template <typename D> if_dual_t<D> exp(const D &u) {
+    const auto e = exp(u.v);
+    return chain(u, e, e, e);
+}
+template <typename D> if_dual_t<D> log(const D &u) {
+    const auto r = 1 / u.v;
+    return chain(u, log(u.v), r, -r * r);
+}
+template <typename D> if_dual_t<D> fabs(const D &u) {
+    return u.v < 0 ? -u : u;
+}
+template <typename D> if_dual_t<D> floor(const D &u) {
+    return D(floor(u.v));
+}
+// the remainder moves with u, the divisor is a constant
+template <typename D, typename S> if_dual_scalar_t<D, S> fmod(const D &u, S m) {
+    D r = u;
+    r.v = fmod(u.v, static_cast<typename D::value_type>(m));
+    return r;
+}
+
+// θ = atan2(y, x): θ' = (x y' - y x') / r², and differentiating that again the
+// x'y' terms cancel, θ'' = (x y'' - y x'') / r² - 2 θ' (x x' + y y') / r²
+template <typename T> dual<T> atan2(const dual<T> &y, const dual<T> &x) {
+    const T r2 = x.v * x.v + y.v * y.v;
+    return dual<T>(atan2(y.v, x.v), (x.v * y.d - y.v * x.d) / r2);
+}
+template <typename T> dual2<T> atan2(const dual2<T> &y, const dual2<T> &x) {
+    const T r2 = x.v * x.v + y.v * y.v;
+    const T d = (x.v * y.d - y.v * x.d) / r2;
+    const T dd = (x.v * y.dd - y.v * x.dd) / r2 - T(2) * d * (x.v * x.d + y.v * y.d) / r2;
+    return dual2<T>(atan2(y.v, x.v), d, dd);
+}
+
+}
+
+#endif /* PAULYC_MMM_HPP */
@@ -18,40 +18,279 @@
  * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
  **/
 
-#include "tetrabiblos.hpp"
+#include "ingress.hpp"
+#include "iso8601.hpp"
+#include "lunar.hpp"
+#include "parallel.hpp"
 
-int main(int argc, char *argv[]) {
-    (void)argc;
-    (void)argv;
-    
-    JPLEphems ephems;
+#include <algorithm>
+#include <charconv>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
 
-    char tzbuf[] = "TZ=UTC";
-    putenv(tzbuf);
-    tzset();
+using namespace github::paulyc;
+using std::chrono::system_clock;
 
-    timespec ts = {0,100000000};
-    try {
-        ephems.init("ephem/lnxm13000p17000.431");
-    } catch (const std::exception &ex) {
-        std::cerr << "Couldn't initialize ephems: " << ex.what() << std::endl;
-        return 1;
+namespace {
+
+static constexpr const char *DEFAULT_EPHEMERIS = "ephem/lnxm13000p17000.431";
+static constexpr long double YEAR_JD = 365.25l;
+// longer than the gap between any two events of one kind
+static constexpr long double MAX_INTERVAL_JD = 32.0l;
+
+struct Options {
+    system_clock::time_point from = system_clock::now();
+    system_clock::time_point to;
+    bool haveTo = false;
+    std::size_t count = 0;
+    unsigned lunarKinds = 0;
+    bool solar = false;
+    std::string ephemeris = DEFAULT_EPHEMERIS;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    bool json = false;
+};
+
+struct Event {
+    jd_clock::time_point jd;
+    const char *name;
+    // the sign entered for ingresses, null for phases
+    const char *sign;
+};
+
+void usage(std::ostream &os) {
+    os << "usage: newmoon [options]\n"
+          "  --from=TIME        start, an ISO 8601 UTC date or time (default now)\n"
+          "  --to=TIME          end (default a year after --from)\n"
+          "  --count=N          the first N events instead of up to --to\n"
+          "  --events=LIST      comma separated new,full,quarters,solar (default new)\n"
+          "  --ephem=FILE       ephemeris (default " << DEFAULT_EPHEMERIS << ")\n"
+          "  --threads=N        workers (default one per core)\n"
+          "  --format=csv|json  output (default csv)\n";
+}
+
+// a bare date is midnight UTC
+bool parseTime(std::string_view s, system_clock::time_point &out) {
+    if (s.size() == 10) {
+        char buf[iso8601::LENGTH];
+        std::copy(s.begin(), s.end(), buf);
+        std::copy_n("T00:00:00Z", 10, buf + 10);
+        return iso8601::parse(std::string_view(buf, 20), out);
+    }
+    return iso8601::parse(s, out);
+}
+
+template <typename T>
+bool parseNumber(std::string_view s, T &out) {
+    const auto [end, ec] = std::from_chars(s.data(), s.data() + s.size(), out);
+    return ec == std::errc() && end == s.data() + s.size() && out > 0;
+}
+
+bool parseEvents(std::string_view s, Options &opt) {
+    opt.lunarKinds = 0;
+    opt.solar = false;
+    while (!s.empty()) {
+        const std::size_t comma = s.find(',');
+        const std::string_view kind = s.substr(0, comma);
+        if (kind == "new") {
+            opt.lunarKinds |= LunarEvent::NewMoon;
+        } else if (kind == "full") {
+            opt.lunarKinds |= LunarEvent::FullMoon;
+        } else if (kind == "quarters") {
+            opt.lunarKinds |= LunarEvent::Quarters;
+        } else if (kind == "solar") {
+            opt.solar = true;
+        } else {
+            return false;
+        }
+        s = comma == std::string_view::npos ? std::string_view() : s.substr(comma + 1);
+    }
+    return opt.lunarKinds != 0 || opt.solar;
+}
+
+// false, having said why, for anything it doesn't understand
+bool parseArgs(int argc, char *argv[], Options &opt) {
+    opt.lunarKinds = LunarEvent::NewMoon;
+    for (int i = 1; i < argc; ++i) {
+        std::string_view arg = argv[i];
+        if (arg == "-h" || arg == "--help") {
+            usage(std::cout);
+            std::exit(0);
+        }
+        // --name=value or --name value
+        std::string_view name = arg, value;
+        const std::size_t eq = arg.find('=');
+        if (eq != std::string_view::npos) {
+            name = arg.substr(0, eq);
+            value = arg.substr(eq + 1);
+        } else if (i + 1 < argc) {
+            value = argv[++i];
+        }
+        bool ok;
+        if (name == "--from") {
+            ok = parseTime(value, opt.from);
+        } else if (name == "--to") {
+            ok = parseTime(value, opt.to);
+            opt.haveTo = true;
+        } else if (name == "--count") {
+            ok = parseNumber(value, opt.count);
+        } else if (name == "--events") {
+            ok = parseEvents(value, opt);
+        } else if (name == "--ephem") {
+            opt.ephemeris = value;
+            ok = !value.empty();
+        } else if (name == "--threads") {
+            ok = parseNumber(value, opt.threads);
+        } else if (name == "--format") {
+            opt.json = value == "json";
+            ok = value == "json" || value == "csv";
+        } else {
+            std::cerr << "newmoon: unknown option " << arg << '\n';
+            return false;
+        }
+        if (!ok) {
+            std::cerr << "newmoon: bad value '" << value << "' for " << name << '\n';
+            return false;
+        }
+    }
+    if (opt.haveTo && opt.count > 0) {
+        std::cerr << "newmoon: --to and --count don't go together\n";
+        return false;
+    }
+    if (opt.haveTo && opt.to <= opt.from) {
+        std::cerr << "newmoon: --to has to be after --from\n";
+        return false;
     }
+    return true;
+}
+
+jd_clock::time_point at(long double jd) {
+    return jd_clock::time_point(jd_clock::duration(jd));
+}
+
+const char* phaseName(LunarEvent::Kind kind) {
+    switch (kind) {
+    case LunarEvent::NewMoon: return "new moon";
+    case LunarEvent::FirstQuarter: return "first quarter";
+    case LunarEvent::FullMoon: return "full moon";
+    case LunarEvent::LastQuarter: return "last quarter";
+    default: return "unknown";
+    }
+}
+
+// every event asked for in [from, to), in time order, over chunks of the range
+// small enough to keep every worker busy
+std::vector<Event> search(const Options &opt, long double from, long double to) {
+    const long double chunk = std::clamp((to - from) / (4.0l * opt.threads), MAX_INTERVAL_JD, YEAR_JD);
+    const std::size_t tasks = std::max<std::size_t>(1, static_cast<std::size_t>(ceill((to - from) / chunk)));
+    std::vector<std::vector<Event>> results(tasks);
+    parallelEphemerisTasks(opt.ephemeris, tasks, opt.threads, [&](JPLEphems &ephems, std::size_t task) {
+        const long double t0 = from + static_cast<long double>(task) * chunk;
+        const long double t1 = std::min(to, t0 + chunk);
+        // a root right on the end of a chunk belongs to the next one
+        auto inside = [t1](const jd_clock::time_point &jd) {
+            return jd.time_since_epoch().count() < t1;
+        };
+        if (opt.lunarKinds != 0) {
+            for (const LunarEvent &ev : findLunarEvents(ephems, at(t0), at(t1), opt.lunarKinds)) {
+                if (inside(ev.jd)) {
+                    results[task].push_back(Event {ev.jd, phaseName(ev.kind), nullptr});
+                }
+            }
+        }
+        if (opt.solar) {
+            for (const PlanetEvent &ev : SolarIngresses(ephems).find(at(t0), at(t1))) {
+                if (inside(ev.jd)) {
+                    results[task].push_back(Event {ev.jd, "ingress", PlanetEvent::signName(ev.sign)});
+                }
+            }
+        }
+    });
+
+    std::vector<Event> events;
+    for (std::vector<Event> &r : results) {
+        std::sort(r.begin(), r.end(), [](const Event &a, const Event &b) {
+            return a.jd < b.jd;
+        });
+        events.insert(events.end(), r.begin(), r.end());
+    }
+    return events;
+}
 
+void write(std::ostream &os, const std::vector<Event> &events, bool json) {
+    char time[iso8601::MAX_LENGTH];
+    char jd[32];
+    if (!json) {
+        os << "time,jd,event,sign\n";
+    } else {
+        os << '[';
+    }
+    for (std::size_t i = 0; i < events.size(); ++i) {
+        const Event &ev = events[i];
+        const std::size_t tlen = iso8601::format(jd_clock::to_system_clock(ev.jd), time) - time;
+        const int jlen = std::snprintf(jd, sizeof(jd), "%.6Lf", ev.jd.time_since_epoch().count());
+        if (!json) {
+            os.write(time, tlen);
+            os << ',';
+            os.write(jd, jlen);
+            os << ',' << ev.name << ',' << (ev.sign ? ev.sign : "") << '\n';
+        } else {
+            os << (i == 0 ? "\n" : ",\n") << "  {\"time\": \"";
+            os.write(time, tlen);
+            os << "\", \"jd\": ";
+            os.write(jd, jlen);
+            os << ", \"event\": \"" << ev.name << "\", \"sign\": ";
+            if (ev.sign) {
+                os << '"' << ev.sign << '"';
+            } else {
+                os << "null";
+            }
+            os << '}';
+        }
+    }
+    if (json) {
+        os << "\n]\n";
+    }
+}
 
-    github::paulyc::tetrabiblos::Date today = github::paulyc::tetrabiblos::getDate(ephems, std::chrono::system_clock::now());
-    std::cout << today << std::endl;
+}
 
-    jd_clock::time_point jd = jd_clock::now();
-    jd -= jd_clock::duration(28.0);
+int main(int argc, char *argv[]) {
+    Options opt;
+    if (!parseArgs(argc, argv, opt)) {
+        usage(std::cerr);
+        return 2;
+    }
 
-    // generate newmoons every ts seconds forever
-    for (;;) {
-        std::chrono::system_clock::time_point tp = minFinder(ephems, jd);
-        std::cout << "\"new moon (ISO8601)\"" << '"' << tp << '"' << std::endl;
-        jd += jd_clock::duration(1.0);
-        nanosleep(&ts, nullptr);
+    std::vector<Event> events;
+    try {
+        const long double from = jd_clock::from_system_clock(opt.from).time_since_epoch().count();
+        if (opt.count > 0) {
+            // enough for count events of the rarest kind asked for, then more until there are
+            const int kinds = __builtin_popcount(opt.lunarKinds) + (opt.solar ? 1 : 0);
+            const long double span = (static_cast<long double>(opt.count) / kinds + 1.0l) * MAX_INTERVAL_JD;
+            for (long double lo = from; events.size() < opt.count; lo += span) {
+                const std::vector<Event> more = search(opt, lo, lo + span);
+                events.insert(events.end(), more.begin(), more.end());
+            }
+            events.resize(opt.count);
+        } else {
+            const long double to = opt.haveTo ? jd_clock::from_system_clock(opt.to).time_since_epoch().count() : from + YEAR_JD;
+            if (to > from) {
+                events = search(opt, from, to);
+            }
+        }
+    } catch (const std::exception &ex) {
+        std::cerr << "newmoon: " << ex.what() << '\n';
+        return 1;
     }
 
-    return 0;
+    std::ios::sync_with_stdio(false);
+    write(std::cout, events, opt.json);
+    std::cout.flush();
+    return std::cout ? 0 : 1;
 }
@@ -0,0 +1,90 @@
+/**
+ * parallel.hpp
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#ifndef PAULYC_PARALLEL_HPP
+#define PAULYC_PARALLEL_HPP
+
+#include "ephemshelper.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace github {
+namespace paulyc {
+
+// Runs fun(ephems, task) for every task in [0, tasks) on up to `threads` workers.
+// A JPLEphems handle caches records and isn't safe to share, so each worker opens
+// its own with open(ephems). Tasks are handed out in order from a shared counter;
+// the first exception thrown by any worker stops the others picking up new tasks
+// and is rethrown here once they've all finished.
+template <typename F>
+void parallelEphemerisTasks(const std::function<void(JPLEphems &)> &open, std::size_t tasks, unsigned threads, F &&fun)
+{
+    std::atomic<std::size_t> next(0);
+    std::exception_ptr error;
+    std::mutex error_mutex;
+
+    auto worker = [&]() {
+        try {
+            JPLEphems ephems;
+            open(ephems);
+            for (std::size_t task = next++; task < tasks; task = next++) {
+                fun(ephems, task);
+            }
+        } catch (...) {
+            next = tasks;
+            std::lock_guard<std::mutex> lock(error_mutex);
+            if (!error) {
+                error = std::current_exception();
+            }
+        }
+    };
+
+    std::vector<std::thread> pool;
+    const std::size_t nthreads = std::min<std::size_t>(std::max(1u, threads), tasks);
+    for (std::size_t i = 0; i < nthreads; ++i) {
+        pool.emplace_back(worker);
+    }
+    for (std::thread &t : pool) {
+        t.join();
+    }
+    if (error) {
+        std::rethrow_exception(error);
+    }
+}
+
+// the same with each worker's handle on the ephemeris file
+template <typename F>
+void parallelEphemerisTasks(const std::string &ephemeris, std::size_t tasks, unsigned threads, F &&fun)
+{
+    parallelEphemerisTasks([&ephemeris](JPLEphems &ephems) { ephems.init(ephemeris); }, tasks, threads, std::forward<F>(fun));
+}
+
+}
+}
+
+#endif /* PAULYC_PARALLEL_HPP */
@@ -0,0 +1,132 @@
+/**
+ * phase.cpp
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#include "phase.hpp"
+#include "vec3batch.hpp"
+#include "vmath.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+namespace github {
+namespace paulyc {
+
+namespace {
+
+// big enough to amortize the per-call overhead, small enough to stay in L1/L2
+static constexpr std::size_t CHUNK = 1024;
+
+// the J2000 equatorial to ecliptic rotation is about x, so only y and z change
+static const double COS_ɛ = cos(static_cast<double>(OBLIQUITY_J2000));
+static const double SIN_ɛ = sin(static_cast<double>(OBLIQUITY_J2000));
+
+// one chunk's vectors and angles, kept between chunks so nothing is allocated per chunk
+struct PhaseScratch {
+    Vec3BatchD moon, sun, toEarth, toSun;
+    // ecliptic y and x of the Moon then the Sun, and their longitudes
+    aligned_vector<double> λy, λx, λ;
+    aligned_vector<double> phaseAngle, cosPhase, elongation;
+
+    void resize(std::size_t n) {
+        for (Vec3BatchD *b : {&moon, &sun, &toEarth, &toSun}) {
+            b->resize(n);
+        }
+        for (aligned_vector<double> *v : {&λy, &λx, &λ}) {
+            v->resize(2 * n);
+        }
+        for (aligned_vector<double> *v : {&phaseAngle, &cosPhase, &elongation}) {
+            v->resize(n);
+        }
+    }
+};
+
+}
+
+void moonPhases(JPLEphems &ephems, std::span<const jd_clock::time_point> jds, PhaseSeries &out, SimdLevel level) {
+    const std::size_t n = jds.size();
+    out.resize(n);
+
+    std::vector<std::size_t> order(n);
+    std::iota(order.begin(), order.end(), 0);
+    if (!std::is_sorted(jds.begin(), jds.end())) {
+        std::sort(order.begin(), order.end(), [&jds](std::size_t a, std::size_t b) {
+            return jds[a] < jds[b];
+        });
+    }
+
+    double epochs[CHUNK];
+    JPLEphems::State moon[CHUNK], sun[CHUNK];
+    PhaseScratch b;
+    for (std::size_t base = 0; base < n; base += CHUNK) {
+        const std::size_t len = std::min(CHUNK, n - base);
+        for (std::size_t i = 0; i < len; ++i) {
+            epochs[i] = static_cast<double>(jds[order[base + i]].time_since_epoch().count());
+        }
+        ephems.get_moon_sun(epochs, len, moon, sun);
+
+        b.resize(len);
+        for (std::size_t i = 0; i < len; ++i) {
+            const double *m = moon[i].pv;
+            const double *s = sun[i].pv;
+            b.moon.x[i] = m[0];
+            b.moon.y[i] = m[1];
+            b.moon.z[i] = m[2];
+            b.sun.x[i] = s[0];
+            b.sun.y[i] = s[1];
+            b.sun.z[i] = s[2];
+            // at the moon, the earth is at -m and the sun at s - m
+            b.toEarth.x[i] = -m[0];
+            b.toEarth.y[i] = -m[1];
+            b.toEarth.z[i] = -m[2];
+            b.toSun.x[i] = s[0] - m[0];
+            b.toSun.y[i] = s[1] - m[1];
+            b.toSun.z[i] = s[2] - m[2];
+            b.λy[i] = COS_ɛ * m[1] + SIN_ɛ * m[2];
+            b.λx[i] = m[0];
+            b.λy[len + i] = COS_ɛ * s[1] + SIN_ɛ * s[2];
+            b.λx[len + i] = s[0];
+        }
+        batch::angle(b.toEarth, b.toSun, b.phaseAngle, level);
+        vmath::cos(b.phaseAngle, b.cosPhase, level);
+        batch::angle(b.moon, b.sun, b.elongation, level);
+        vmath::atan2(b.λy, b.λx, b.λ, level);
+
+        for (std::size_t i = 0; i < len; ++i) {
+            const std::size_t k = order[base + i];
+            out.phaseAngle[k] = b.phaseAngle[i];
+            out.illuminated[k] = 0.5 * (1.0 + b.cosPhase[i]);
+            out.elongation[k] = b.elongation[i];
+            double Δλ = b.λ[i] - b.λ[len + i];
+            if (Δλ < 0.0) {
+                Δλ += 2.0 * M_PI;
+            }
+            out.age[k] = Δλ * (SYNODIC_MONTH_JD / (2.0 * M_PI));
+        }
+    }
+}
+
+PhaseSeries moonPhases(JPLEphems &ephems, std::span<const jd_clock::time_point> jds, SimdLevel level) {
+    PhaseSeries series;
+    moonPhases(ephems, jds, series, level);
+    return series;
+}
+
+}
+}
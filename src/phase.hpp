@@ -0,0 +1,70 @@
+/**
+ * phase.hpp
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#ifndef PAULYC_PHASE_HPP
+#define PAULYC_PHASE_HPP
+
+#include "astro.hpp"
+#include "simd.hpp"
+
+#include <span>
+#include <vector>
+
+namespace github {
+namespace paulyc {
+
+// mean synodic month in days, used to turn the Moon-Sun longitude difference into an age
+static constexpr double SYNODIC_MONTH_JD = 29.530588853;
+
+// Structure-of-arrays output of moonPhases(), element i belongs to epoch i
+struct PhaseSeries {
+    // Sun-Moon-Earth angle in radians, 0 at full moon and π at new moon
+    std::vector<double> phaseAngle;
+    // illuminated fraction of the disk, (1 + cos(phaseAngle)) / 2
+    std::vector<double> illuminated;
+    // Sun-Earth-Moon angle in radians, 0 at new moon and π at full moon
+    std::vector<double> elongation;
+    // days into the lunation, from the ecliptic longitude of the Moon ahead of the Sun
+    // scaled by the mean synodic month, so it runs 0 (new) through ~14.77 (full)
+    std::vector<double> age;
+
+    void resize(std::size_t n) {
+        phaseAngle.resize(n);
+        illuminated.resize(n);
+        elongation.resize(n);
+        age.resize(n);
+    }
+    std::size_t size() const { return phaseAngle.size(); }
+};
+
+// Evaluate the phase quantities at every epoch directly, no searching.
+// Epochs don't need to be sorted, they're visited in time order internally so
+// the ephemeris reads each record once, and the output keeps the input order.
+// The angles are worked out a chunk of epochs at a time with the batch::angle
+// and vmath kernels for `level`.
+void moonPhases(JPLEphems &ephems, std::span<const jd_clock::time_point> jds, PhaseSeries &out,
+                SimdLevel level = detectedSimdLevel());
+PhaseSeries moonPhases(JPLEphems &ephems, std::span<const jd_clock::time_point> jds,
+                       SimdLevel level = detectedSimdLevel());
+
+}
+}
+
+#endif /* PAULYC_PHASE_HPP */
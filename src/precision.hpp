@@ -0,0 +1,79 @@
+/**
+ * precision.hpp
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#ifndef PAULYC_PRECISION_HPP
+#define PAULYC_PRECISION_HPP
+
+#include <cfloat>
+#include <functional>
+
+#include "quadmath.h"
+#include "lalgebra.hpp"
+
+namespace github {
+namespace paulyc {
+
+/*
+ * Precision policies. A policy names the real type the vectors, matrices,
+ * transforms and solvers of the pipeline are instantiated on, so one build can
+ * carry a fast double pipeline next to the __float128 reference it's checked
+ * against, both from the same templates. mmm:: picks the libm, libm-l or
+ * libquadmath routine for each.
+ */
+template <typename Real>
+struct precision_policy {
+    typedef Real real;
+    typedef basic_cartesian3dvec<Real> cartesian;
+    typedef basic_spherical3dvec<Real> spherical;
+    typedef mat3x3<Real> matrix;
+    typedef basic_spacexfrm3d<Real> xfrm;
+    typedef std::function<Real(Real)> fun_1d;
+};
+
+struct double_precision : precision_policy<double> {
+    static constexpr const char *name = "double";
+    static constexpr int digits = DBL_MANT_DIG;
+    static constexpr double epsilon = DBL_EPSILON;
+};
+
+// x87 extended on amd64: 64 bits of mantissa in 16 bytes of storage
+struct extended_precision : precision_policy<long double> {
+    static constexpr const char *name = "long double";
+    static constexpr int digits = LDBL_MANT_DIG;
+    static constexpr long double epsilon = LDBL_EPSILON;
+};
+
+// IEEE binary128 in software, the reference
+struct quad_precision : precision_policy<__float128> {
+    static constexpr const char *name = "__float128";
+    static constexpr int digits = FLT128_MANT_DIG;
+    static constexpr __float128 epsilon = FLT128_EPSILON;
+};
+
+// what the non-template API (cartesian3dvec, fun_1d_t, ...) is
+typedef extended_precision default_precision;
+
+template <typename P>
+using real_t = typename P::real;
+
+} /* namespace paulyc */
+} /* namespace github */
+
+#endif /* PAULYC_PRECISION_HPP */
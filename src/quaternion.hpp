@@ -0,0 +1,268 @@
+/**
+ * quaternion.hpp
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#ifndef PAULYC_QUATERNION_HPP
+#define PAULYC_QUATERNION_HPP
+
+#include <cmath>
+#include <functional>
+#include <limits>
+#include <span>
+#include <stdexcept>
+
+#include "lalgebra.hpp"
+#include "vec3batch.hpp"
+#include "jd_clock.hpp"
+
+namespace github {
+namespace paulyc {
+
+/*
+ * Unit quaternions as rotations, with the conventions of mat3x3: R_1..R_3 and
+ * R_seq give the same rotations as the matrices of the same name, a.mul(b) is
+ * b then a, mul(v) rotates v and transposeMul(v) undoes it. Composing costs 16
+ * multiplications against a matrix product's 27, four numbers renormalize back
+ * to an exact rotation where a chain of matrix products slowly stops being
+ * orthogonal, and slerp interpolates between two rotations at a constant rate.
+ * To apply one to many vectors, take matrix() once (or use batch::rotate).
+ */
+template <typename T = long double>
+struct quaternion
+{
+    typedef T TT;
+    T w;
+    T x;
+    T y;
+    T z;
+
+    static constexpr quaternion identity() {
+        return {T(1), T(0), T(0), T(0)};
+    }
+
+    // R_axis(θ) rotates the frame by θ, so the vector by -θ, about axis 1, 2 or 3
+    static quaternion R(int axis, T θ) {
+        const T h = θ / T(2);
+        const T s = -mmm::sin(h);
+        return {mmm::cos(h), axis == 1 ? s : T(0), axis == 2 ? s : T(0), axis == 3 ? s : T(0)};
+    }
+    static quaternion R_1(T θ) { return R(1, θ); }
+    static quaternion R_2(T θ) { return R(2, θ); }
+    static quaternion R_3(T θ) { return R(3, θ); }
+
+    // R_a(θ_a) R_b(θ_b) ... R_z(θ_z), as mat3x3::R_seq
+    template <int... Axes, typename... Angles>
+    static quaternion R_seq(Angles... θs) {
+        static_assert(sizeof...(Axes) == sizeof...(Angles) && sizeof...(Axes) > 0, "one angle per axis");
+        static_assert(((Axes >= 1 && Axes <= 3) && ...), "axes are 1, 2 or 3");
+        quaternion q = identity();
+        ((q = q.mul(R(Axes, static_cast<T>(θs)))), ...);
+        return q;
+    }
+
+    // the rotation matrix m, which has to be orthogonal (Shepperd's method, taking
+    // the square root of whichever of w, x, y, z is largest)
+    static quaternion fromMatrix(const mat3x3<T> &m) {
+        const T (&e)[3][3] = m.elems;
+        const T trace = e[0][0] + e[1][1] + e[2][2];
+        if (trace >= e[0][0] && trace >= e[1][1] && trace >= e[2][2]) {
+            const T s = mmm::sqrt(T(1) + trace) * T(2);
+            return quaternion {s / T(4), (e[2][1] - e[1][2]) / s, (e[0][2] - e[2][0]) / s, (e[1][0] - e[0][1]) / s}.canonical();
+        } else if (e[0][0] >= e[1][1] && e[0][0] >= e[2][2]) {
+            const T s = mmm::sqrt(T(1) + e[0][0] - e[1][1] - e[2][2]) * T(2);
+            return quaternion {(e[2][1] - e[1][2]) / s, s / T(4), (e[0][1] + e[1][0]) / s, (e[0][2] + e[2][0]) / s}.canonical();
+        } else if (e[1][1] >= e[2][2]) {
+            const T s = mmm::sqrt(T(1) + e[1][1] - e[0][0] - e[2][2]) * T(2);
+            return quaternion {(e[0][2] - e[2][0]) / s, (e[0][1] + e[1][0]) / s, s / T(4), (e[1][2] + e[2][1]) / s}.canonical();
+        }
+        const T s = mmm::sqrt(T(1) + e[2][2] - e[0][0] - e[1][1]) * T(2);
+        return quaternion {(e[1][0] - e[0][1]) / s, (e[0][2] + e[2][0]) / s, (e[1][2] + e[2][1]) / s, s / T(4)}.canonical();
+    }
+
+    mat3x3<T> matrix() const {
+        const T xx = x * x, yy = y * y, zz = z * z;
+        const T xy = x * y, xz = x * z, yz = y * z;
+        const T wx = w * x, wy = w * y, wz = w * z;
+        return {{
+            {T(1) - T(2) * (yy + zz), T(2) * (xy - wz), T(2) * (xz + wy)},
+            {T(2) * (xy + wz), T(1) - T(2) * (xx + zz), T(2) * (yz - wx)},
+            {T(2) * (xz - wy), T(2) * (yz + wx), T(1) - T(2) * (xx + yy)},
+            }};
+    }
+
+    // the Hamilton product: that rotation, then this one
+    constexpr quaternion mul(const quaternion &that) const {
+        return {
+            w * that.w - x * that.x - y * that.y - z * that.z,
+            w * that.x + x * that.w + y * that.z - z * that.y,
+            w * that.y - x * that.z + y * that.w + z * that.x,
+            w * that.z + x * that.y - y * that.x + z * that.w,
+        };
+    }
+
+    // v + 2w (u × v) + 2 u × (u × v) for the vector part u: 18 multiplications
+    // to the matrix's 9, so it only pays for a vector or two
+    template <typename U>
+    constexpr vec3<U> mul(const vec3<U> &v) const {
+        const U tx = U(2) * (y * v.raw[2] - z * v.raw[1]);
+        const U ty = U(2) * (z * v.raw[0] - x * v.raw[2]);
+        const U tz = U(2) * (x * v.raw[1] - y * v.raw[0]);
+        return {
+            v.raw[0] + w * tx + (y * tz - z * ty),
+            v.raw[1] + w * ty + (z * tx - x * tz),
+            v.raw[2] + w * tz + (x * ty - y * tx),
+        };
+    }
+
+    template <typename U>
+    constexpr vec3<U> transposeMul(const vec3<U> &v) const {
+        return conjugate().mul(v);
+    }
+
+    // the inverse rotation
+    constexpr quaternion conjugate() const {
+        return {w, -x, -y, -z};
+    }
+
+    constexpr T dotP(const quaternion &that) const {
+        return w * that.w + x * that.x + y * that.y + z * that.z;
+    }
+
+    T norm() const {
+        return mmm::sqrt(dotP(*this));
+    }
+
+    quaternion normalize() const {
+        const T n = norm();
+        return {w / n, x / n, y / n, z / n};
+    }
+
+    // q and -q are the same rotation; this is the one with w >= 0
+    constexpr quaternion canonical() const {
+        return w < T(0) ? quaternion {-w, -x, -y, -z} : *this;
+    }
+
+    // the angle of the rotation that takes a to b, 4 atan2(|a - b|, |a + b|) with
+    // a and b on the same side
+    static T angle(const quaternion &a, quaternion b) {
+        if (a.dotP(b) < T(0)) {
+            b = {-b.w, -b.x, -b.y, -b.z};
+        }
+        const quaternion d {a.w - b.w, a.x - b.x, a.y - b.y, a.z - b.z};
+        const quaternion s {a.w + b.w, a.x + b.x, a.y + b.y, a.z + b.z};
+        return T(4) * mmm::atan2(d.norm(), s.norm());
+    }
+
+    // from a (t = 0) to b (t = 1) the short way round, at a constant angular rate
+    static quaternion slerp(const quaternion &a, quaternion b, T t) {
+        if (a.dotP(b) < T(0)) {
+            b = {-b.w, -b.x, -b.y, -b.z};
+        }
+        // half the angle between them, as 2 atan2(|b - a|, |b + a|) so it keeps
+        // its precision when they're close
+        const quaternion d {b.w - a.w, b.x - a.x, b.y - a.y, b.z - a.z};
+        const quaternion s {b.w + a.w, b.x + a.x, b.y + a.y, b.z + a.z};
+        const T θ = T(2) * mmm::atan2(d.norm(), s.norm());
+        if (θ == T(0)) {
+            return a;
+        }
+        const T r = T(1) / mmm::sin(θ);
+        const T ka = mmm::sin((T(1) - t) * θ) * r, kb = mmm::sin(t * θ) * r;
+        return {ka * a.w + kb * b.w, ka * a.x + kb * b.x, ka * a.y + kb * b.y, ka * a.z + kb * b.z};
+    }
+};
+
+typedef quaternion<double> quaterniond_t;
+typedef quaternion<long double> quaternionq_t;
+
+namespace batch {
+
+// q applied to every vector, as one matrix
+template <typename T>
+void rotate(const quaternion<T> &q, const Vec3BatchD &in, Vec3BatchD &out, SimdLevel level = detectedSimdLevel()) {
+    const mat3x3<T> m = q.matrix();
+    mat3x3<double> d;
+    for (std::size_t i = 0; i < 3; ++i) {
+        for (std::size_t j = 0; j < 3; ++j) {
+            d.elems[i][j] = static_cast<double>(m.elems[i][j]);
+        }
+    }
+    rotate(d, in, out, level);
+}
+
+}
+
+// A rotation that varies with time, evaluated exactly on nodes `step` days apart
+// and slerped between them. Slerp turns at a constant rate over each interval,
+// so its error is second order in the step: for the precession-nutation matrix
+// (FrameRotation::npb) on the default one day step it's about 3 mas from the
+// 13.66 day nutation term. The two nodes around the last epoch are kept, so a
+// time ordered series computes one new node per step.
+template <typename T = double>
+class SlerpedRotation
+{
+public:
+    typedef std::function<quaternion<T>(long double)> rotation_fun;
+
+    explicit SlerpedRotation(rotation_fun rotation, long double step = 1.0l) :
+        _rotation(std::move(rotation)),
+        _step(step),
+        _index(std::numeric_limits<long>::min())
+    {
+        if (!(step > 0.0l)) {
+            throw std::runtime_error("SlerpedRotation step must be positive, not %Lf"_fmt.format(step));
+        }
+    }
+
+    quaternion<T> at(long double jd) {
+        const long double u = jd / _step;
+        const long k = static_cast<long>(floorl(u));
+        if (k != _index) {
+            _a = k == _index + 1 ? _b : _rotation(static_cast<long double>(k) * _step);
+            _b = _rotation(static_cast<long double>(k + 1) * _step);
+            _index = k;
+        }
+        return quaternion<T>::slerp(_a, _b, static_cast<T>(u - static_cast<long double>(k)));
+    }
+
+    // out[i] = at(jds[i]) applied to in[i]; out may be in
+    template <typename U>
+    void apply(std::span<const jd_clock::time_point> jds, const Vec3Batch<U> &in, Vec3Batch<U> &out) {
+        if (jds.size() != in.size()) {
+            throw std::runtime_error("SlerpedRotation::apply %zu epochs for %zu vectors"_fmt.format(jds.size(), in.size()));
+        }
+        out.resize(in.size());
+        for (std::size_t i = 0; i < in.size(); ++i) {
+            const mat3x3<T> m = at(jds[i].time_since_epoch().count()).matrix();
+            out.set(i, m.mul(vec3<U> {in.x[i], in.y[i], in.z[i]}));
+        }
+    }
+
+private:
+    rotation_fun _rotation;
+    long double _step;
+    long _index;
+    quaternion<T> _a;
+    quaternion<T> _b;
+};
+
+} /* namespace paulyc */
+} /* namespace github */
+
+#endif /* PAULYC_QUATERNION_HPP */
@@ -0,0 +1,67 @@
+/**
+ * simd.hpp
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#ifndef PAULYC_SIMD_HPP
+#define PAULYC_SIMD_HPP
+
+#include <algorithm>
+
+namespace github {
+namespace paulyc {
+
+// Which kernels the batch operations run. They pick the widest the CPU
+// supports unless told otherwise, which is mostly for testing the others.
+// Scalar means whatever the baseline target has, which on x86-64 is SSE2.
+enum class SimdLevel { Scalar, AVX2, AVX512 };
+
+inline SimdLevel detectedSimdLevel() {
+    static const SimdLevel level = []() {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f")) {
+            return SimdLevel::AVX512;
+        }
+        if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+            return SimdLevel::AVX2;
+        }
+#endif
+        return SimdLevel::Scalar;
+    }();
+    return level;
+}
+
+// never run kernels the CPU doesn't have, whatever the caller asked for
+inline SimdLevel usableSimdLevel(SimdLevel level) {
+    return std::min(level, detectedSimdLevel());
+}
+
+inline const char* name(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::Scalar: return "scalar";
+    case SimdLevel::AVX2: return "AVX2";
+    case SimdLevel::AVX512: return "AVX-512";
+    }
+    return "?";
+}
+
+} /* namespace paulyc */
+} /* namespace github */
+
+#endif /* PAULYC_SIMD_HPP */
@@ -0,0 +1,476 @@
+/**
+ * solvers.hpp
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#ifndef PAULYC_SOLVERS_HPP
+#define PAULYC_SOLVERS_HPP
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace github {
+namespace paulyc {
+
+// Root finders and minimizers over any callable. Every one takes an explicit
+// tolerance on x and a cap on iterations, and reports how many times it
+// evaluated the function, which for an ephemeris search is the whole cost.
+
+template <typename T>
+struct SolverResult {
+    // the root or minimizer, and f there
+    T x;
+    T fx;
+    int evaluations;
+    // false when the bracket was bad or the iteration cap was hit first; x is
+    // then the best estimate so far
+    bool converged;
+
+    explicit operator bool() const { return converged; }
+};
+
+template <typename T>
+struct Bracket {
+    T a;
+    T b;
+    T fa;
+    T fb;
+    int evaluations;
+    bool found;
+
+    explicit operator bool() const { return found; }
+};
+
+// Bracket of a minimum, f(b) <= f(a) and f(b) <= f(c) with b between a and c.
+template <typename T>
+struct MinBracket {
+    T a, b, c;
+    T fa, fb, fc;
+    int evaluations;
+    bool found;
+
+    explicit operator bool() const { return found; }
+};
+
+namespace solvers_detail {
+
+template <typename T>
+constexpr T epsilon() {
+    return std::numeric_limits<T>::epsilon();
+}
+
+// numeric_limits isn't specialized for __float128, and std::sqrt doesn't take it
+template <>
+constexpr __float128 epsilon<__float128>() {
+    return 0x1p-112q;
+}
+
+template <typename T>
+T sqrt_epsilon() {
+    using std::sqrt;
+    return sqrt(epsilon<T>());
+}
+
+template <>
+inline __float128 sqrt_epsilon<__float128>() {
+    return 0x1p-56q;
+}
+
+template <typename T>
+constexpr T abs(T x) {
+    return x < T(0) ? -x : x;
+}
+
+template <typename T>
+constexpr bool opposite(T fa, T fb) {
+    return (fa < T(0)) != (fb < T(0));
+}
+
+}
+
+// Widen [a, b] geometrically (by 1.6 each time, toward whichever end is smaller
+// in |f|) until f changes sign over it.
+template <typename T, typename F>
+Bracket<T> bracket_root(F &&f, T a, T b, const int maxiter = 50)
+{
+    using namespace solvers_detail;
+    static constexpr T GROW = T(1.6);
+    Bracket<T> r {a, b, f(a), f(b), 2, false};
+    for (int i = 0; i < maxiter && !opposite(r.fa, r.fb) && r.fa != T(0) && r.fb != T(0); ++i) {
+        if (abs(r.fa) < abs(r.fb)) {
+            r.a += GROW * (r.a - r.b);
+            r.fa = f(r.a);
+        } else {
+            r.b += GROW * (r.b - r.a);
+            r.fb = f(r.b);
+        }
+        ++r.evaluations;
+    }
+    r.found = opposite(r.fa, r.fb) || r.fa == T(0) || r.fb == T(0);
+    return r;
+}
+
+// Brent's method (zeroin) on a root bracketed by [a, b]: inverse quadratic or
+// secant steps when they behave, bisection when they don't, so never worse than
+// bisection and usually superlinear. Derivative free.
+template <typename T, typename F>
+SolverResult<T> brent_root(F &&f, T a, T b, T fa, T fb, const T xtol, const int maxiter = 100)
+{
+    using namespace solvers_detail;
+    if (fa == T(0)) {
+        return {a, fa, 0, true};
+    } else if (fb == T(0)) {
+        return {b, fb, 0, true};
+    } else if (!opposite(fa, fb)) {
+        return {b, fb, 0, false};
+    }
+    int evaluations = 0;
+    T c = a, fc = fa;
+    T d = b - a, e = d;
+    for (int i = 0; i < maxiter; ++i) {
+        if (!opposite(fb, fc)) {
+            c = a;
+            fc = fa;
+            d = e = b - a;
+        }
+        if (abs(fc) < abs(fb)) {
+            a = b; b = c; c = a;
+            fa = fb; fb = fc; fc = fa;
+        }
+        const T tol = T(2) * epsilon<T>() * abs(b) + T(0.5) * xtol;
+        const T m = T(0.5) * (c - b);
+        if (abs(m) <= tol || fb == T(0)) {
+            return {b, fb, evaluations, true};
+        }
+        if (abs(e) >= tol && abs(fa) > abs(fb)) {
+            const T s = fb / fa;
+            T p, q;
+            if (a == c) {
+                p = T(2) * m * s;
+                q = T(1) - s;
+            } else {
+                const T qa = fa / fc;
+                const T r = fb / fc;
+                p = s * (T(2) * m * qa * (qa - r) - (b - a) * (r - T(1)));
+                q = (qa - T(1)) * (r - T(1)) * (s - T(1));
+            }
+            if (p > T(0)) {
+                q = -q;
+            } else {
+                p = -p;
+            }
+            if (T(2) * p < std::min(T(3) * m * q - abs(tol * q), abs(e * q))) {
+                e = d;
+                d = p / q;
+            } else {
+                d = e = m;
+            }
+        } else {
+            d = e = m;
+        }
+        a = b;
+        fa = fb;
+        b += abs(d) > tol ? d : (m > T(0) ? tol : -tol);
+        fb = f(b);
+        ++evaluations;
+    }
+    return {b, fb, evaluations, false};
+}
+
+// ITP (Oliveira & Takahashi 2020) on a root bracketed by [a, b]: a regula falsi
+// step truncated toward the midpoint and projected into a shrinking ball around
+// it, so it takes at most one more evaluation than bisection would and is
+// superlinear on smooth functions.
+template <typename T, typename F>
+SolverResult<T> itp_root(F &&f, T a, T b, T fa, T fb, const T xtol, const int maxiter = 100)
+{
+    using namespace solvers_detail;
+    if (fa == T(0)) {
+        return {a, fa, 0, true};
+    } else if (fb == T(0)) {
+        return {b, fb, 0, true};
+    } else if (!opposite(fa, fb)) {
+        return {b, fb, 0, false};
+    }
+    // work on g = sign * f so that g(a) < 0 < g(b) with a < b
+    if (b < a) {
+        std::swap(a, b);
+        std::swap(fa, fb);
+    }
+    const T sign = fa < T(0) ? T(1) : T(-1);
+    fa *= sign;
+    fb *= sign;
+    const T ɛ = T(0.5) * xtol;
+    const T κ1 = T(0.2) / (b - a);
+    const int n_half = std::max(0, static_cast<int>(std::ceil(std::log2(static_cast<double>((b - a) / (T(2) * ɛ))))));
+    const int n_max = n_half + 1;
+    int evaluations = 0;
+    for (int j = 0; j < maxiter; ++j) {
+        if (b - a <= T(2) * ɛ) {
+            const T x = T(0.5) * (a + b);
+            return {x, abs(fa) < abs(fb) ? sign * fa : sign * fb, evaluations, true};
+        }
+        const T x_half = T(0.5) * (a + b);
+        const T r = ɛ * std::ldexp(T(1), std::max(0, n_max - j)) - T(0.5) * (b - a);
+        const T δ = κ1 * (b - a) * (b - a);
+        const T x_f = (fb * a - fa * b) / (fb - fa);
+        const T σ = x_half >= x_f ? T(1) : T(-1);
+        const T x_t = δ <= abs(x_half - x_f) ? x_f + σ * δ : x_half;
+        const T x = abs(x_t - x_half) <= r ? x_t : x_half - σ * r;
+        const T fx = sign * f(x);
+        ++evaluations;
+        if (fx > T(0)) {
+            b = x;
+            fb = fx;
+        } else if (fx < T(0)) {
+            a = x;
+            fa = fx;
+        } else {
+            return {x, T(0), evaluations, true};
+        }
+    }
+    return {T(0.5) * (a + b), abs(fa) < abs(fb) ? sign * fa : sign * fb, evaluations, false};
+}
+
+// Newton's method on a root bracketed by [a, b], with fun returning {f(x), f'(x)}
+// so an analytic derivative (eg. an ephemeris velocity) is used instead of
+// differencing. Any step that would leave the bracket is replaced by bisection,
+// so it always converges.
+template <typename T, typename F>
+SolverResult<T> newton_root(F &&fun, T a, T b, T fa, T fb, const T xtol, const int maxiter = 64)
+{
+    using namespace solvers_detail;
+    if (fa == T(0)) {
+        return {a, fa, 0, true};
+    } else if (fb == T(0)) {
+        return {b, fb, 0, true};
+    } else if (!opposite(fa, fb)) {
+        return {b, fb, 0, false};
+    }
+    // orient so that f(lo) < 0 < f(hi)
+    T lo = fa < T(0) ? a : b;
+    T hi = fa < T(0) ? b : a;
+    T x = (fb * a - fa * b) / (fb - fa);
+    T fx = fb;
+    int evaluations = 0;
+    for (int i = 0; i < maxiter; ++i) {
+        const auto [f, df] = fun(x);
+        fx = f;
+        ++evaluations;
+        if (fx == T(0)) {
+            return {x, fx, evaluations, true};
+        } else if (fx < T(0)) {
+            lo = x;
+        } else {
+            hi = x;
+        }
+        T next = x - fx / df;
+        if (!(df != T(0)) || (next - lo) * (next - hi) > T(0)) {
+            next = T(0.5) * (lo + hi);
+        }
+        const T step = next - x;
+        x = next;
+        if (abs(step) < xtol) {
+            return {x, fx, evaluations, true};
+        }
+    }
+    return {x, fx, evaluations, false};
+}
+
+// Starting from [a, b], step downhill with golden ratio growth (and parabolic
+// extrapolation when it helps) until a minimum is bracketed.
+template <typename T, typename F>
+MinBracket<T> bracket_min(F &&f, T a, T b, const int maxiter = 50)
+{
+    using namespace solvers_detail;
+    static constexpr T GOLD = T(1.618033988749894848204586834365638118l);
+    static constexpr T GLIMIT = T(100);
+    MinBracket<T> r {a, b, b, f(a), f(b), T(0), 2, false};
+    if (r.fb > r.fa) {
+        std::swap(r.a, r.b);
+        std::swap(r.fa, r.fb);
+    }
+    r.c = r.b + GOLD * (r.b - r.a);
+    r.fc = f(r.c);
+    ++r.evaluations;
+    for (int i = 0; i < maxiter && r.fb > r.fc; ++i) {
+        const T s = (r.b - r.a) * (r.fb - r.fc);
+        const T q = (r.b - r.c) * (r.fb - r.fa);
+        const T denom = T(2) * (abs(q - s) > T(1e-20) ? q - s : (q - s < T(0) ? T(-1e-20) : T(1e-20)));
+        T u = r.b - ((r.b - r.c) * q - (r.b - r.a) * s) / denom;
+        const T ulim = r.b + GLIMIT * (r.c - r.b);
+        T fu;
+        if ((r.b - u) * (u - r.c) > T(0)) {
+            // parabolic minimum between b and c
+            fu = f(u);
+            ++r.evaluations;
+            if (fu < r.fc) {
+                r.a = r.b; r.fa = r.fb;
+                r.b = u; r.fb = fu;
+                break;
+            } else if (fu > r.fb) {
+                r.c = u; r.fc = fu;
+                break;
+            }
+            u = r.c + GOLD * (r.c - r.b);
+            fu = f(u);
+            ++r.evaluations;
+        } else if ((r.c - u) * (u - ulim) > T(0)) {
+            fu = f(u);
+            ++r.evaluations;
+            if (fu < r.fc) {
+                r.b = r.c; r.fb = r.fc;
+                r.c = u; r.fc = fu;
+                u = r.c + GOLD * (r.c - r.b);
+                fu = f(u);
+                ++r.evaluations;
+            }
+        } else if ((u - ulim) * (ulim - r.c) >= T(0)) {
+            u = ulim;
+            fu = f(u);
+            ++r.evaluations;
+        } else {
+            u = r.c + GOLD * (r.c - r.b);
+            fu = f(u);
+            ++r.evaluations;
+        }
+        r.a = r.b; r.fa = r.fb;
+        r.b = r.c; r.fb = r.fc;
+        r.c = u; r.fc = fu;
+    }
+    r.found = r.fb <= r.fa && r.fb <= r.fc;
+    return r;
+}
+
+// Golden section search for a minimum of a unimodal f on [a, b]. Linear, one
+// evaluation per iteration, shrinking the interval by 0.618 each time.
+template <typename T, typename F>
+SolverResult<T> golden_section_min(F &&f, T a, T b, const T xtol, const int maxiter = 200)
+{
+    using namespace solvers_detail;
+    static constexpr T R = T(0.618033988749894848204586834365638118l);
+    T c = b - R * (b - a);
+    T d = a + R * (b - a);
+    T fc = f(c), fd = f(d);
+    int evaluations = 2;
+    for (int i = 0; i < maxiter; ++i) {
+        if (abs(b - a) <= xtol) {
+            return fc < fd ? SolverResult<T> {c, fc, evaluations, true} : SolverResult<T> {d, fd, evaluations, true};
+        }
+        if (fc < fd) {
+            b = d;
+            d = c; fd = fc;
+            c = b - R * (b - a);
+            fc = f(c);
+        } else {
+            a = c;
+            c = d; fc = fd;
+            d = a + R * (b - a);
+            fd = f(d);
+        }
+        ++evaluations;
+    }
+    return fc < fd ? SolverResult<T> {c, fc, evaluations, false} : SolverResult<T> {d, fd, evaluations, false};
+}
+
+// Brent's minimizer on [a, b]: parabolic interpolation through the three best
+// points, falling back to golden section steps whenever the parabola misbehaves.
+template <typename T, typename F>
+SolverResult<T> brent_min(F &&f, T a, T b, const T xtol, const int maxiter = 100)
+{
+    using namespace solvers_detail;
+    static constexpr T CGOLD = T(0.381966011250105151795413165634361882l);
+    if (b < a) {
+        std::swap(a, b);
+    }
+    // the relative part of the tolerance is measured from where the bracket
+    // starts, not from zero, or near a julian date it would swamp xtol
+    const T origin = a;
+    T x = a + CGOLD * (b - a);
+    T w = x, v = x;
+    T fx = f(x);
+    T fw = fx, fv = fx;
+    T d = T(0), e = T(0);
+    int evaluations = 1;
+    for (int i = 0; i < maxiter; ++i) {
+        const T xm = T(0.5) * (a + b);
+        const T tol1 = sqrt_epsilon<T>() * abs(x - origin) + T(0.5) * xtol / T(2);
+        const T tol2 = T(2) * tol1;
+        if (abs(x - xm) <= tol2 - T(0.5) * (b - a)) {
+            return {x, fx, evaluations, true};
+        }
+        bool golden = true;
+        if (abs(e) > tol1) {
+            T r = (x - w) * (fx - fv);
+            T q = (x - v) * (fx - fw);
+            T p = (x - v) * q - (x - w) * r;
+            q = T(2) * (q - r);
+            if (q > T(0)) {
+                p = -p;
+            }
+            q = abs(q);
+            const T etemp = e;
+            if (!(abs(p) >= abs(T(0.5) * q * etemp) || p <= q * (a - x) || p >= q * (b - x))) {
+                e = d;
+                d = p / q;
+                const T u = x + d;
+                if (u - a < tol2 || b - u < tol2) {
+                    d = xm >= x ? tol1 : -tol1;
+                }
+                golden = false;
+            }
+        }
+        if (golden) {
+            e = x >= xm ? a - x : b - x;
+            d = CGOLD * e;
+        }
+        const T u = abs(d) >= tol1 ? x + d : x + (d >= T(0) ? tol1 : -tol1);
+        const T fu = f(u);
+        ++evaluations;
+        if (fu <= fx) {
+            if (u >= x) {
+                a = x;
+            } else {
+                b = x;
+            }
+            v = w; fv = fw;
+            w = x; fw = fx;
+            x = u; fx = fu;
+        } else {
+            if (u < x) {
+                a = u;
+            } else {
+                b = u;
+            }
+            if (fu <= fw || w == x) {
+                v = w; fv = fw;
+                w = u; fw = fu;
+            } else if (fu <= fv || v == x || v == w) {
+                v = u; fv = fu;
+            }
+        }
+    }
+    return {x, fx, evaluations, false};
+}
+
+} /* namespace paulyc */
+} /* namespace github */
+
+#endif /* PAULYC_SOLVERS_HPP */
@@ -0,0 +1,170 @@
+/**
+ * split_jd_clock.hpp
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#ifndef PAULYC_SPLIT_JD_CLOCK_HPP
+#define PAULYC_SPLIT_JD_CLOCK_HPP
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <ctime>
+
+#include "jd_clock.hpp"
+#include "timescales.hpp"
+
+/*
+ * TDB julian dates as a whole day number and the nanoseconds since that day
+ * began (at noon, as julian days do). Integers add without rounding, so a scan
+ * that steps a minute at a time for a month ends exactly a month later, and
+ * unix and system_clock times convert both ways with their sub-second part:
+ * the UTC -> TDB offset is rounded to the nanosecond and the way back solves
+ * for the UTC time that maps onto the time point, so round trips are exact.
+ * epoch() is the two-part date jpl_state2() and jpl_pleph2() interpolate at
+ * without ever adding the day and the fraction together in a double.
+ *
+ * Differences of time points are std::chrono::nanoseconds, which span 292
+ * years either way; further apart, compare the day numbers.
+ */
+struct split_jd_clock
+{
+    typedef std::chrono::nanoseconds duration;
+
+    static constexpr bool is_steady = true;
+    static constexpr std::int64_t NS_PER_SECOND = 1000000000ll;
+    static constexpr std::int64_t NS_PER_DAY = 86400ll * NS_PER_SECOND;
+    // the julian day that began at noon on 1969-12-31 UTC
+    static constexpr std::int64_t UNIX_EPOCH_DAY = 2440587ll;
+
+    static constexpr std::int64_t floor_div(std::int64_t a, std::int64_t b) {
+        return a / b - ((a % b != 0) && ((a < 0) != (b < 0)));
+    }
+
+    struct time_point
+    {
+        std::int64_t day;
+        std::int64_t ns;  // 0 <= ns < NS_PER_DAY
+
+        constexpr time_point() : day(0), ns(0) {}
+        constexpr time_point(std::int64_t d, std::int64_t n) :
+            day(d + floor_div(n, NS_PER_DAY)),
+            ns(n - floor_div(n, NS_PER_DAY) * NS_PER_DAY) {}
+        // whole day and fraction, for jpl_state2() and jpl_pleph2()
+        std::array<double, 2> epoch() const {
+            return {static_cast<double>(day), static_cast<double>(ns) / static_cast<double>(NS_PER_DAY)};
+        }
+
+        time_point& operator+=(duration d) {
+            return *this = time_point(day, ns + d.count());
+        }
+        time_point& operator-=(duration d) {
+            return *this = time_point(day, ns - d.count());
+        }
+        time_point operator+(duration d) const {
+            return time_point(*this) += d;
+        }
+        time_point operator-(duration d) const {
+            return time_point(*this) -= d;
+        }
+        duration operator-(const time_point &that) const {
+            return duration((day - that.day) * NS_PER_DAY + (ns - that.ns));
+        }
+        auto operator<=>(const time_point &) const = default;
+    };
+
+    // to the nearest nanosecond
+    static time_point from_jd(const jd_clock::time_point &jd) {
+        const long double t = jd.time_since_epoch().count();
+        const long double d = floorl(t);
+        return time_point(static_cast<std::int64_t>(d), llroundl((t - d) * NS_PER_DAY));
+    }
+
+    static jd_clock::time_point to_jd(const time_point &tp) {
+        return jd_clock::time_point(jd_clock::duration(static_cast<long double>(tp.day) + static_cast<long double>(tp.ns) / NS_PER_DAY));
+    }
+
+    static dd_jd_clock::time_point to_dd(const time_point &tp) {
+        return dd_jd_clock::time_point(dd_jd_clock::duration(mmm::ddouble(tp.day) + mmm::ddouble(tp.ns) / mmm::ddouble(NS_PER_DAY)));
+    }
+
+    static time_point now() {
+        return from_system_clock(std::chrono::system_clock::now());
+    }
+
+    static time_point from_system_clock(const std::chrono::system_clock::time_point &t) {
+        const auto s = std::chrono::floor<std::chrono::seconds>(t);
+        return from_utc(utc_from_unix(s.time_since_epoch().count(), std::chrono::duration_cast<duration>(t - s).count()));
+    }
+
+    static std::chrono::system_clock::time_point to_system_clock(const time_point &tp) {
+        const time_point utc = to_utc(tp);
+        const std::int64_t ns = utc.ns - NS_PER_DAY / 2;
+        const std::int64_t s = floor_div(ns, NS_PER_SECOND);
+        return std::chrono::system_clock::time_point(std::chrono::seconds((utc.day - UNIX_EPOCH_DAY) * 86400ll + s)) +
+            std::chrono::duration_cast<std::chrono::system_clock::duration>(duration(ns - s * NS_PER_SECOND));
+    }
+
+    static time_point from_time_t(std::time_t t) {
+        return from_utc(utc_from_unix(t, 0));
+    }
+
+    // the second the time point falls in
+    static std::time_t to_time_t(const time_point &tp) {
+        const time_point utc = to_utc(tp);
+        return static_cast<std::time_t>((utc.day - UNIX_EPOCH_DAY) * 86400ll + floor_div(utc.ns - NS_PER_DAY / 2, NS_PER_SECOND));
+    }
+
+    // TDB - UTC in nanoseconds at a UTC time point
+    static std::int64_t tdb_minus_utc(const time_point &utc) {
+        const std::array<double, 2> e = utc.epoch();
+        const double jd = e[0] + e[1];
+        const double tt = timescales::to_tt(jd, timescales::UTC);
+        const double tdb = timescales::from_tt(jd + tt / timescales::SECONDS_PER_DAY, timescales::TDB);
+        return llround((tt + tdb) * NS_PER_SECOND);
+    }
+
+    static time_point from_utc(const time_point &utc) {
+        return utc + duration(tdb_minus_utc(utc));
+    }
+
+    // the UTC time point from_utc() maps onto tp; the offset is flat to well
+    // under a nanosecond across its own size, so this settles in a step or two
+    // (within a leap second there are two answers, and this picks one)
+    static time_point to_utc(const time_point &tp) {
+        time_point utc = tp - duration(tdb_minus_utc(tp));
+        for (int i = 0; i < 3; ++i) {
+            const duration miss = from_utc(utc) - tp;
+            if (miss.count() == 0) {
+                break;
+            }
+            utc -= miss;
+        }
+        return utc;
+    }
+
+private:
+    static time_point utc_from_unix(std::int64_t seconds, std::int64_t ns) {
+        const std::int64_t s = seconds + 43200;
+        const std::int64_t days = floor_div(s, 86400);
+        return time_point(UNIX_EPOCH_DAY + days, (s - days * 86400) * NS_PER_SECOND + ns);
+    }
+};
+
+#endif /* PAULYC_SPLIT_JD_CLOCK_HPP */
@@ -0,0 +1,234 @@
+/**
+ * stations.cpp
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#include "stations.hpp"
+#include "apparent.hpp"
+#include "aspects.hpp"
+#include "frames.hpp"
+#include "parallel.hpp"
+#include "solvers.hpp"
+
+#include <algorithm>
+
+namespace github {
+namespace paulyc {
+
+namespace {
+
+static constexpr long double EVENT_TOLERANCE_JD = 1e-8l;
+static constexpr long double YEAR_JD = 365.25l;
+static constexpr long double SIGN = MMM_PI / 6.0l;
+
+inline int mod12(long k) {
+    const int s = static_cast<int>(k % 12);
+    return s < 0 ? s + 12 : s;
+}
+
+struct Sample {
+    long double jd;
+    // ecliptic longitude of date in [0, 2π) and its rate per day
+    long double λ;
+    long double dλ;
+};
+
+class Searcher
+{
+public:
+    Searcher(JPLEphems &ephems, JPLEphems::Point body, unsigned kinds) :
+        _ephems(ephems), _frame(ephems), _body(body), _kinds(kinds),
+        _step(body == JPLEphems::Moon ? 0.5l : 1.0l)
+    {
+    }
+
+    void run(long double from, long double to, std::vector<PlanetEvent> &out) {
+        auto dλ_at = [this](long double jd) -> long double {
+            return sample(jd).dλ;
+        };
+
+        Sample prev = sample(from);
+        while (prev.jd < to) {
+            const Sample next = sample(std::min(prev.jd + _step, to));
+            if ((prev.dλ < 0.0l) != (next.dλ < 0.0l)) {
+                // the station splits the step into two monotone pieces; should Brent
+                // hit its iteration cap the bracket still holds, so bisect it instead
+                const SolverResult<long double> root = brent_root(dλ_at, prev.jd, next.jd, prev.dλ, next.dλ, EVENT_TOLERANCE_JD);
+                const Sample mid = sample(root ? root.x : bisectStation(prev, next));
+                const PlanetEvent::Kind kind = prev.dλ > 0.0l ? PlanetEvent::StationRetrograde : PlanetEvent::StationDirect;
+                if (_kinds & kind) {
+                    out.push_back(PlanetEvent {_body, kind, jd_clock::time_point(jd_clock::duration(mid.jd)), mid.λ, -1});
+                }
+                ingresses(prev, mid, out);
+                ingresses(mid, next, out);
+            } else {
+                ingresses(prev, next, out);
+            }
+            prev = next;
+        }
+    }
+
+private:
+    Sample sample(long double jd) {
+        const JPLEphems::State s = _ephems.get_state(static_cast<double>(jd), JPLEphems::Earth, _body, true);
+        const mat3x3q_t m = _frame.eclipticInterpolated(jd);
+        const vec3q_t p = m.mul(s.position());
+        const vec3q_t v = m.mul(s.velocity());
+        const long double x = p.raw[0], y = p.raw[1];
+        long double λ = atan2l(y, x);
+        if (λ < 0.0l) {
+            λ += MMM_2_PI;
+        }
+        // the rotated ephemeris velocity misses the turning of the frame itself, the
+        // precession plus the nutation in longitude; the nutation rate is read at every
+        // sample, since near a station even its fortnightly swing moves the root
+        const long double dλ = (x * v.raw[1] - y * v.raw[0]) / (x * x + y * y) + ApparentPlace::precessionRate(jd)
+            + _ephems.get_nutations(static_cast<double>(jd)).nutationInLongitudeRate();
+        return Sample {jd, λ, dλ};
+    }
+
+    // the longitude is monotone over [a, b], so each boundary between the ends is crossed once
+    void ingresses(const Sample &a, const Sample &b, std::vector<PlanetEvent> &out) {
+        if (!(_kinds & PlanetEvent::Ingress)) {
+            return;
+        }
+        const long double λa = a.λ;
+        const long double λb = λa + wrapAngle(b.λ - a.λ);
+        long first, last;
+        if (λb > λa) {
+            // boundaries in (λa, λb]
+            first = static_cast<long>(floorl(λa / SIGN)) + 1;
+            last = static_cast<long>(floorl(λb / SIGN));
+        } else {
+            // boundaries in [λb, λa)
+            first = static_cast<long>(ceill(λb / SIGN));
+            last = static_cast<long>(ceill(λa / SIGN)) - 1;
+        }
+        for (long k = first; k <= last; ++k) {
+            const long double boundary = k * SIGN;
+            auto g = [this, boundary](long double jd) -> std::pair<long double, long double> {
+                const Sample s = sample(jd);
+                return {wrapAngle(s.λ - boundary), s.dλ};
+            };
+            const SolverResult<long double> jd = newton_root(g, a.jd, b.jd, λa - boundary, λb - boundary, EVENT_TOLERANCE_JD);
+            if (jd) {
+                const int sign = λb > λa ? mod12(k) : mod12(k - 1);
+                out.push_back(PlanetEvent {_body, PlanetEvent::Ingress, jd_clock::time_point(jd_clock::duration(jd.x)), mod12(k) * SIGN, sign});
+            }
+        }
+    }
+
+    // dλ changes sign over [a, b]
+    long double bisectStation(Sample a, Sample b) {
+        while (b.jd - a.jd > EVENT_TOLERANCE_JD) {
+            const Sample m = sample(0.5l * (a.jd + b.jd));
+            ((m.dλ < 0.0l) == (a.dλ < 0.0l) ? a : b) = m;
+        }
+        return 0.5l * (a.jd + b.jd);
+    }
+
+    JPLEphems &_ephems;
+    FrameRotation _frame;
+    JPLEphems::Point _body;
+    unsigned _kinds;
+    long double _step;
+};
+
+std::size_t bodyOrder(JPLEphems::Point body) {
+    return std::find(std::begin(PlanetEvent::BODIES), std::end(PlanetEvent::BODIES), body) - std::begin(PlanetEvent::BODIES);
+}
+
+void sortEvents(std::vector<PlanetEvent> &events) {
+    std::sort(events.begin(), events.end(), [](const PlanetEvent &a, const PlanetEvent &b) {
+        if (a.jd != b.jd) {
+            return a.jd < b.jd;
+        }
+        return bodyOrder(a.body) < bodyOrder(b.body);
+    });
+}
+
+}
+
+const char* PlanetEvent::name(Kind kind) {
+    switch (kind) {
+    case StationRetrograde: return "stations retrograde";
+    case StationDirect: return "stations direct";
+    case Ingress: return "enters";
+    default: return "unknown";
+    }
+}
+
+const char* PlanetEvent::signName(int sign) {
+    static const char *names[] = {
+        "Aries", "Taurus", "Gemini", "Cancer", "Leo", "Virgo",
+        "Libra", "Scorpio", "Sagittarius", "Capricornus", "Aquarius", "Pisces",
+    };
+    return sign >= 0 && sign < 12 ? names[sign] : "unknown";
+}
+
+std::vector<PlanetEvent> findPlanetEvents(JPLEphems &ephems, const jd_clock::time_point &from, const jd_clock::time_point &to, unsigned kinds) {
+    std::vector<PlanetEvent> events;
+    for (JPLEphems::Point body : PlanetEvent::BODIES) {
+        Searcher(ephems, body, kinds).run(from.time_since_epoch().count(), to.time_since_epoch().count(), events);
+    }
+    sortEvents(events);
+    return events;
+}
+
+std::vector<PlanetEvent> findPlanetEvents(JPLEphems &ephems, JPLEphems::Point body, const jd_clock::time_point &from, const jd_clock::time_point &to, unsigned kinds) {
+    std::vector<PlanetEvent> events;
+    Searcher(ephems, body, kinds).run(from.time_since_epoch().count(), to.time_since_epoch().count(), events);
+    sortEvents(events);
+    return events;
+}
+
+std::vector<PlanetEvent> findPlanetEvents(const std::string &ephemeris, const jd_clock::time_point &from, const jd_clock::time_point &to, unsigned threads, unsigned kinds) {
+    const long double jd_from = from.time_since_epoch().count();
+    const long double jd_to = to.time_since_epoch().count();
+    const std::size_t years = std::max<std::size_t>(1, static_cast<std::size_t>(ceill((jd_to - jd_from) / YEAR_JD)));
+    const std::size_t tasks = years * PlanetEvent::NBODIES;
+
+    std::vector<std::vector<PlanetEvent>> results(tasks);
+    parallelEphemerisTasks(ephemeris, tasks, threads, [&](JPLEphems &ephems, std::size_t task) {
+        const long double t0 = jd_from + static_cast<long double>(task / PlanetEvent::NBODIES) * YEAR_JD;
+        const long double t1 = std::min(jd_to, t0 + YEAR_JD);
+        Searcher(ephems, PlanetEvent::BODIES[task % PlanetEvent::NBODIES], kinds).run(t0, t1, results[task]);
+    });
+
+    std::vector<PlanetEvent> events;
+    for (const std::vector<PlanetEvent> &r : results) {
+        events.insert(events.end(), r.begin(), r.end());
+    }
+    sortEvents(events);
+    return events;
+}
+
+std::ostream& operator<<(std::ostream &os, const PlanetEvent &ev) {
+    using ::operator<<;
+    jd_clock::time_point jd = ev.jd;
+    os << jd_clock::to_system_clock(jd) << ' ' << Aspect::name(ev.body) << ' ' << PlanetEvent::name(ev.kind);
+    if (ev.kind == PlanetEvent::Ingress) {
+        os << ' ' << PlanetEvent::signName(ev.sign);
+    } else {
+        os << " λ " << ev.longitude * 180.0l / MMM_PI;
+    }
+    return os;
+}
+
+}
+}
@@ -0,0 +1,83 @@
+/**
+ * stations.hpp
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#ifndef PAULYC_STATIONS_HPP
+#define PAULYC_STATIONS_HPP
+
+#include "astro.hpp"
+
+#include <string>
+#include <vector>
+
+namespace github {
+namespace paulyc {
+
+struct PlanetEvent {
+    enum Kind {
+        StationRetrograde = 1 << 0,
+        StationDirect     = 1 << 1,
+        Ingress           = 1 << 2,
+
+        Stations = StationRetrograde | StationDirect,
+        All      = Stations | Ingress,
+    };
+
+    // every body the ephemeris has that moves against the geocentric sky
+    static constexpr JPLEphems::Point BODIES[] = {
+        JPLEphems::Sun, JPLEphems::Moon, JPLEphems::Mercury, JPLEphems::Venus, JPLEphems::Mars,
+        JPLEphems::Jupiter, JPLEphems::Saturn, JPLEphems::Uranus, JPLEphems::Neptune, JPLEphems::Pluto,
+    };
+    static constexpr std::size_t NBODIES = sizeof(BODIES) / sizeof(BODIES[0]);
+
+    JPLEphems::Point body;
+    Kind kind;
+    jd_clock::time_point jd;
+    // geocentric ecliptic longitude of date, radians in [0, 2π)
+    long double longitude;
+    // for ingresses the sign entered, 0 = Aries .. 11 = Pisces; -1 for stations
+    int sign;
+
+    static const char* name(Kind kind);
+    static const char* signName(int sign);
+};
+
+// Every station and 30° sign ingress of every body in [from, to), in time order.
+// Geometric geocentric longitudes on the true ecliptic and equinox of date.
+//
+// Each body is sampled once a day (twice for the Moon) with velocities from the
+// ephemeris. A change of sign of the longitude rate brackets a station, which is
+// solved derivative-free; splitting the step there leaves pieces over which the
+// longitude is monotone, so every sign boundary between their ends is crossed
+// exactly once and is solved with Newton on the rate.
+std::vector<PlanetEvent> findPlanetEvents(JPLEphems &ephems, const jd_clock::time_point &from, const jd_clock::time_point &to, unsigned kinds = PlanetEvent::All);
+
+// Same, for one body
+std::vector<PlanetEvent> findPlanetEvents(JPLEphems &ephems, JPLEphems::Point body, const jd_clock::time_point &from, const jd_clock::time_point &to, unsigned kinds = PlanetEvent::All);
+
+// Same, split by body and by year over `threads` workers, each with its own
+// handle on the ephemeris.
+std::vector<PlanetEvent> findPlanetEvents(const std::string &ephemeris, const jd_clock::time_point &from, const jd_clock::time_point &to, unsigned threads, unsigned kinds = PlanetEvent::All);
+
+std::ostream& operator<<(std::ostream &os, const PlanetEvent &ev);
+
+}
+}
+
+#endif /* PAULYC_STATIONS_HPP */
@@ -19,8 +19,15 @@
  **/
 
 #include "tetrabiblos.hpp"
+#include "ingress.hpp"
+#include "iso8601.hpp"
+#include "lunar.hpp"
+#include "parallel.hpp"
+
+#include <algorithm>
 #include <chrono>
-#include <ctime>
+#include <stdexcept>
+#include <string>
 
 namespace github {
 namespace paulyc {
@@ -28,54 +35,290 @@ namespace tetrabiblos {
 
 using std::chrono::system_clock;
 
-static int monthLength(std::tm *t) {
-    switch (t->tm_mon) {
-    case 8:
-    case 3:
-    case 7:
-    case 10:
-        return 30;
-    case 1:
-        return ((t->tm_year % 4) == 0 && (t->tm_year % 400) != 0) ? 29 : 28;
-    default:
-        return 31;
-    }
-}
-
-static void fixTm(std::tm *t) {
-    int mlen = monthLength(t);
-    if (t->tm_mday > mlen) {
-        t->tm_mday -= mlen;
-        ++t->tm_mon;
-        if (t->tm_mon > 11) {
-            t->tm_mon = 0;
-            ++t->tm_year;
+namespace {
+
+static constexpr long double YEAR_JD = 365.25l;
+// enough before a date for the Capricornus ingress that began its year (up to
+// 13 months back) and the new moon before that, and after it for the new moon
+// that ends its month
+static constexpr long double MARGIN_BEFORE_JD = 450.0l;
+static constexpr long double MARGIN_AFTER_JD = 31.0l;
+static constexpr int CAPRICORNUS_SIGN = 9;
+
+static constexpr Month SIGN_MONTHS[12] = {
+    ARIES, TAURUS, GEMINI, CANCER, LEO, VIRGO, LIBRA, SCORPIO, SAGITTARIUS, CAPRICORNUS, AQUARIUS, PISCES,
+};
+
+jd_clock::time_point at(long double jd) {
+    return jd_clock::time_point(jd_clock::duration(jd));
+}
+
+long double jdOf(const system_clock::time_point &tp) {
+    return jd_clock::from_system_clock(tp).time_since_epoch().count();
+}
+
+// the UTC Gregorian year a TDB julian date falls in
+std::int64_t civilYear(long double jd) {
+    const auto days = std::chrono::floor<std::chrono::days>(jd_clock::to_system_clock(at(jd)));
+    return iso8601::civil_from_days(days.time_since_epoch().count()).year;
+}
+
+}
+
+Month signMonth(int sign) {
+    return sign >= 0 && sign < 12 ? SIGN_MONTHS[sign] : NONE;
+}
+
+const char* monthName(Month month) {
+    for (int sign = 0; sign < 12; ++sign) {
+        if (SIGN_MONTHS[sign] == month) {
+            return PlanetEvent::signName(sign);
         }
     }
+    return "none";
+}
+
+void Calendar::cover(JPLEphems &ephems, const jd_clock::time_point &from, const jd_clock::time_point &to) {
+    const long double a = from.time_since_epoch().count() - MARGIN_BEFORE_JD;
+    const long double b = to.time_since_epoch().count() + MARGIN_AFTER_JD;
+    const bool found = _from < _to;
+    if (found && a >= _from && b <= _to) {
+        return;
+    }
+    // a year or more at a time
+    auto search = [&](long double lo, long double hi) {
+        std::vector<jd_clock::time_point> newMoons;
+        for (const LunarEvent &ev : findLunarEvents(ephems, at(lo), at(hi), LunarEvent::NewMoon)) {
+            newMoons.push_back(ev.jd);
+        }
+        insert(at(lo), at(hi), newMoons, SolarIngresses(ephems).find(at(lo), at(hi)));
+    };
+    if (!found) {
+        search(a, std::max(b, a + YEAR_JD));
+        return;
+    }
+    if (a < _from) {
+        search(std::min(a, _from - YEAR_JD), _from);
+    }
+    if (b > _to) {
+        search(_to, std::max(b, _to + YEAR_JD));
+    }
+}
+
+void Calendar::insert(const jd_clock::time_point &from, const jd_clock::time_point &to,
+                      std::span<const jd_clock::time_point> newMoons, std::span<const PlanetEvent> solarIngresses) {
+    const long double lo = from.time_since_epoch().count();
+    const long double hi = to.time_since_epoch().count();
+    const bool found = _from < _to;
+    if (found && (lo > _to || hi < _from)) {
+        throw std::runtime_error("Calendar::insert %Lf to %Lf leaves a gap to %Lf to %Lf"_fmt.format(lo, hi, _from, _to));
+    }
+    // only what's new, so overlapping searches don't count an event twice
+    auto fresh = [&](long double jd) {
+        return jd >= lo && jd < hi && (!found || jd < _from || jd >= _to);
+    };
+    for (const jd_clock::time_point &jd : newMoons) {
+        if (fresh(jd.time_since_epoch().count())) {
+            _newMoons.push_back(jd.time_since_epoch().count());
+        }
+    }
+    for (const PlanetEvent &ev : solarIngresses) {
+        if (ev.kind == PlanetEvent::Ingress && fresh(ev.jd.time_since_epoch().count())) {
+            _ingresses.push_back(ev);
+        }
+    }
+    std::sort(_newMoons.begin(), _newMoons.end());
+    std::sort(_ingresses.begin(), _ingresses.end(), [](const PlanetEvent &a, const PlanetEvent &b) {
+        return a.jd < b.jd;
+    });
+    _from = found ? std::min(_from, lo) : lo;
+    _to = found ? std::max(_to, hi) : hi;
+    label();
+}
+
+// one pass over the new moons with a pointer into the ingresses: the sign the Sun
+// last entered names the month, and a Capricornus ingress since the previous new
+// moon starts a year
+void Calendar::label() {
+    _months.clear();
+    std::size_t k = 0;
+    int sign = -1;
+    Month prev = NONE;
+    bool dated = false;
+    int year = 0;
+    for (std::size_t i = 0; i < _newMoons.size(); ++i) {
+        const long double jd = _newMoons[i];
+        bool yearStart = false;
+        std::int64_t startYear = 0;
+        for (; k < _ingresses.size() && _ingresses[k].jd.time_since_epoch().count() <= jd; ++k) {
+            sign = _ingresses[k].sign;
+            if (sign == CAPRICORNUS_SIGN && i > 0) {
+                yearStart = true;
+                startYear = civilYear(_ingresses[k].jd.time_since_epoch().count()) + 1;
+            }
+        }
+        if (yearStart) {
+            dated = true;
+            year = static_cast<int>(startYear);
+        }
+        const Month month = signMonth(sign);
+        _months.push_back(Lunation {jd_clock::to_system_clock(at(jd)), month, month != NONE && month == prev, dated, year});
+        prev = month;
+    }
+}
+
+Date Calendar::date(const system_clock::time_point &tp) const {
+    const auto it = std::upper_bound(_months.begin(), _months.end(), tp, [](const system_clock::time_point &t, const Lunation &m) {
+        return t < m.start;
+    });
+    if (it == _months.begin() || it == _months.end()) {
+        return Date {false, 0, 0, NONE, 0, false};
+    }
+    const Lunation &m = *(it - 1);
+    if (!m.dated || m.month == NONE) {
+        return Date {false, 0, 0, NONE, 0, false};
+    }
+    const int day = static_cast<int>(std::chrono::floor<std::chrono::days>(tp - m.start).count()) + 1;
+    const int cycle = m.year >= 0 ? m.year / PRECESSIONAL_CYCLE_YEARS : -((PRECESSIONAL_CYCLE_YEARS - 1 - m.year) / PRECESSIONAL_CYCLE_YEARS);
+    return Date {true, cycle, m.year - cycle * PRECESSIONAL_CYCLE_YEARS, m.month, day, m.leap};
+}
+
+std::vector<CalendarMonth> Calendar::months(int fromYear, int toYear) const {
+    std::vector<CalendarMonth> out;
+    for (std::size_t i = 0; i + 1 < _months.size(); ++i) {
+        const Lunation &m = _months[i];
+        if (!m.dated || m.month == NONE || m.year < fromYear || m.year > toYear) {
+            continue;
+        }
+        const Date d = date(m.start);
+        const int days = static_cast<int>(std::chrono::ceil<std::chrono::days>(_months[i + 1].start - m.start).count());
+        out.push_back(CalendarMonth {d.precessionalCycle, d.year, m.month, m.leap, m.start, days});
+    }
+    return out;
+}
+
+void Calendar::dates(std::span<const system_clock::time_point> tps, std::span<Date> out) const {
+    if (out.size() < tps.size()) {
+        throw std::runtime_error("Calendar::dates %zu dates for %zu time points"_fmt.format(out.size(), tps.size()));
+    }
+    for (std::size_t i = 0; i < tps.size(); ++i) {
+        out[i] = date(tps[i]);
+    }
+}
+
+Date Calendar::date(JPLEphems &ephems, const system_clock::time_point &tp) {
+    const jd_clock::time_point jd = jd_clock::from_system_clock(tp);
+    cover(ephems, jd, jd);
+    return date(tp);
+}
+
+void Calendar::dates(JPLEphems &ephems, std::span<const system_clock::time_point> tps, std::span<Date> out) {
+    if (!tps.empty()) {
+        const auto [lo, hi] = std::minmax_element(tps.begin(), tps.end());
+        cover(ephems, at(jdOf(*lo)), at(jdOf(*hi)));
+    }
+    dates(tps, out);
+}
+
+CalendarGenerator::CalendarGenerator(const std::string &ephemeris) :
+    _open([ephemeris](JPLEphems &ephems) { ephems.init(ephemeris); }),
+    _search(&CalendarGenerator::searchYear)
+{
+}
+
+CalendarGenerator::YearEvents CalendarGenerator::searchYear(JPLEphems &ephems, int year) {
+    YearEvents events;
+    for (const LunarEvent &ev : findLunarEvents(ephems, SolarIngresses::newYear(year), SolarIngresses::newYear(year + 1), LunarEvent::NewMoon)) {
+        events.newMoons.push_back(ev.jd);
+    }
+    events.ingresses = SolarIngresses(ephems).year(year);
+    return events;
+}
+
+std::vector<CalendarMonth> CalendarGenerator::generate(int fromYear, int toYear, unsigned threads) {
+    if (toYear < fromYear) {
+        return {};
+    }
+    // from the Capricornus ingress, and the months before it, that begin fromYear
+    // to the new moon that ends toYear
+    const int first = fromYear - 1, last = toYear + 1;
+    std::vector<int> missing;
+    for (int y = first; y <= last; ++y) {
+        if (_years.find(y) == _years.end()) {
+            missing.push_back(y);
+        }
+    }
+    std::vector<YearEvents> found(missing.size());
+    parallelEphemerisTasks(_open, missing.size(), threads, [&](JPLEphems &ephems, std::size_t task) {
+        found[task] = _search(ephems, missing[task]);
+    });
+    for (std::size_t i = 0; i < missing.size(); ++i) {
+        _years[missing[i]] = std::move(found[i]);
+    }
+
+    std::vector<jd_clock::time_point> newMoons;
+    std::vector<PlanetEvent> ingresses;
+    for (int y = first; y <= last; ++y) {
+        const YearEvents &events = _years.at(y);
+        newMoons.insert(newMoons.end(), events.newMoons.begin(), events.newMoons.end());
+        ingresses.insert(ingresses.end(), events.ingresses.begin(), events.ingresses.end());
+    }
+    Calendar calendar;
+    calendar.insert(SolarIngresses::newYear(first), SolarIngresses::newYear(last + 1), newMoons, ingresses);
+    return calendar.months(fromYear, toYear);
+}
+
+void writeCsv(std::ostream &os, std::span<const CalendarMonth> months) {
+    char start[iso8601::MAX_LENGTH];
+    os << "cycle,year,month,leap,start,days\n";
+    for (const CalendarMonth &m : months) {
+        os << m.precessionalCycle << ',' << m.year << ',' << monthName(m.month) << ',' << (m.leap ? 1 : 0) << ',';
+        os.write(start, iso8601::format(m.start, start) - start);
+        os << ',' << m.days << '\n';
+    }
+}
+
+void writeJson(std::ostream &os, std::span<const CalendarMonth> months) {
+    char start[iso8601::MAX_LENGTH];
+    os << '[';
+    for (std::size_t i = 0; i < months.size(); ++i) {
+        const CalendarMonth &m = months[i];
+        os << (i == 0 ? "\n" : ",\n") << "  {\"cycle\": " << m.precessionalCycle << ", \"year\": " << m.year
+           << ", \"month\": \"" << monthName(m.month) << "\", \"leap\": " << (m.leap ? "true" : "false") << ", \"start\": \"";
+        os.write(start, iso8601::format(m.start, start) - start);
+        os << "\", \"days\": " << m.days << '}';
+    }
+    os << "\n]\n";
+}
+
+namespace {
+
+Calendar& calendarFor(JPLEphems &ephems) {
+    thread_local std::string filename;
+    thread_local Calendar calendar;
+    if (filename != ephems.filename()) {
+        filename = ephems.filename();
+        calendar = Calendar();
+    }
+    return calendar;
+}
+
 }
 
 Date getDate(JPLEphems &ephems, const system_clock::time_point &tp) {
-    Date d = {false, 0, 0, NONE, 0};
-    std::time_t tp_time = system_clock::to_time_t(tp);
-    tm *tp_tm = gmtime(&tp_time);
-    jd_clock::time_point jd = jd_clock::from_system_clock(tp);
-    // find next new moon
-    const system_clock::time_point nextNewMoon = minFinder(ephems, jd);
-    const std::time_t nextNewMoonTs = system_clock::to_time_t(nextNewMoon);
-    jd -= jd_clock::duration(30.0);
-    const system_clock::time_point lastNewMoon = minFinder(ephems, jd);
-    const std::time_t lastNewMoonTs = system_clock::to_time_t(lastNewMoon);
-    tm * lastTm = gmtime(&lastNewMoonTs);
-    tm * nextTm = gmtime(&nextNewMoonTs);
-    if (tp_tm->tm_mon >= nextTm->tm_mon || (tp_tm->tm_mon == nextTm->tm_mon && tp_tm->tm_mday >= nextTm->tm_mday)) {
-        // TODO
-    }
-    return d;
+    return calendarFor(ephems).date(ephems, tp);
+}
+
+std::vector<Date> getDates(JPLEphems &ephems, std::span<const system_clock::time_point> tps) {
+    std::vector<Date> out(tps.size());
+    calendarFor(ephems).dates(ephems, tps, out);
+    return out;
 }
 
 std::ostream& operator<<(std::ostream &os, const Date &d) {
-    if (!d.valid) {
-        os << "dayOfMonth: " << d.dayOfMonth << " month: " << d.month << " year: " << d.year << " cycle: " << d.precessionalCycle;
+    if (d.valid) {
+        os << "dayOfMonth: " << d.dayOfMonth << " month: " << (d.leap ? "leap " : "") << monthName(d.month)
+           << " year: " << d.year << " cycle: " << d.precessionalCycle;
     } else {
         os << "invalid Date";
     }
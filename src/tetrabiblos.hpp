@@ -22,6 +22,14 @@
 #define PAULYC_TETRABIBLOS_HPP
 
 #include "astro.hpp"
+#include "stations.hpp"
+
+#include <chrono>
+#include <functional>
+#include <map>
+#include <span>
+#include <string>
+#include <vector>
 
 namespace github {
 namespace paulyc {
@@ -46,12 +54,137 @@ enum Month {
 struct Date {
     bool valid;
     int precessionalCycle;
+    // within the precessional cycle
     int year;
     Month month;
+    // from 1 for the 24 hours starting at the new moon
     int dayOfMonth;
+    // the second month in a row to start with the Sun in the same sign
+    bool leap;
+};
+
+static constexpr int PRECESSIONAL_CYCLE_YEARS = 25772;
+
+// one month of a published calendar
+struct CalendarMonth {
+    int precessionalCycle;
+    int year;
+    Month month;
+    bool leap;
+    std::chrono::system_clock::time_point start;
+    // how many days dayOfMonth counts through
+    int days;
 };
 
+// the month the Sun's sign names, 0 = Aries .. 11 = Pisces as in PlanetEvent
+Month signMonth(int sign);
+const char* monthName(Month month);
+
+/*
+ * A lunisolar calendar. Months begin at new moons and are named for the sign
+ * the Sun is in at the time, by its apparent longitude of date (see
+ * SolarIngresses); when it's in the same sign for two new moons
+ * running, the second month is a leap month. The new moons themselves are
+ * findLunarEvents' geometric J2000 conjunctions, which without the Sun's
+ * aberration come about 40 s after the apparent ones; a month is only
+ * misnamed if an ingress falls inside that gap. The year begins with the first
+ * new moon after the Sun enters Capricornus and is numbered one more than the
+ * (UTC, Gregorian) year the Sun entered it in.
+ *
+ * The new moons and the Sun's ingresses are searched for a year or more at a
+ * time as dates need them and kept, along with each month's name and year, so
+ * converting a date inside what's already been found is a binary search over
+ * the months. The calendar can also be given events found elsewhere, say by a
+ * parallel search. It isn't safe to share between threads while it's growing;
+ * the const lookups are.
+ */
+class Calendar
+{
+public:
+    Date date(JPLEphems &ephems, const std::chrono::system_clock::time_point &tp);
+    // out[i] is the date of tps[i]
+    void dates(JPLEphems &ephems, std::span<const std::chrono::system_clock::time_point> tps, std::span<Date> out);
+
+    // only from what's been found so far, invalid outside it
+    Date date(const std::chrono::system_clock::time_point &tp) const;
+    void dates(std::span<const std::chrono::system_clock::time_point> tps, std::span<Date> out) const;
+
+    // searches the ephemeris so dates in [from, to] are found
+    void cover(JPLEphems &ephems, const jd_clock::time_point &from, const jd_clock::time_point &to);
+    // all the new moons and solar ingresses in [from, to), which has to overlap or
+    // touch the range already found, if any
+    void insert(const jd_clock::time_point &from, const jd_clock::time_point &to,
+                std::span<const jd_clock::time_point> newMoons, std::span<const PlanetEvent> solarIngresses);
+
+    // months found so far
+    std::size_t months() const { return _months.size(); }
+    // every whole month of the years [fromYear, toYear] found so far, in order;
+    // years count through the cycles here, cycle * PRECESSIONAL_CYCLE_YEARS + year
+    std::vector<CalendarMonth> months(int fromYear, int toYear) const;
+
+private:
+    struct Lunation {
+        std::chrono::system_clock::time_point start;
+        Month month;
+        bool leap;
+        // false until a year start has been seen
+        bool dated;
+        int year;
+    };
+
+    void label();
+
+    long double _from = 0.0l;
+    long double _to = 0.0l;
+    std::vector<long double> _newMoons;
+    std::vector<PlanetEvent> _ingresses;
+    // one per new moon; the last only marks where the month before it ends
+    std::vector<Lunation> _months;
+};
+
+/*
+ * Whole calendars for ranges of years. The new moons and solar ingresses are
+ * searched one Gregorian year per task over `threads` workers, each with its
+ * own handle on the ephemeris, and kept by year, so a later range only
+ * searches the years it hasn't seen.
+ */
+class CalendarGenerator
+{
+public:
+    // the new moons and solar ingresses from SolarIngresses::newYear(year) to newYear(year + 1)
+    struct YearEvents {
+        std::vector<jd_clock::time_point> newMoons;
+        std::vector<PlanetEvent> ingresses;
+    };
+    typedef std::function<void(JPLEphems &)> open_fun;
+    typedef std::function<YearEvents(JPLEphems &, int)> search_fun;
+
+    explicit CalendarGenerator(const std::string &ephemeris);
+    // each worker's handle opened with open and each year found with search,
+    // which is called from the workers at once
+    CalendarGenerator(open_fun open, search_fun search) : _open(std::move(open)), _search(std::move(search)) {}
+
+    std::vector<CalendarMonth> generate(int fromYear, int toYear, unsigned threads);
+    // years searched so far
+    std::size_t years() const { return _years.size(); }
+
+    static YearEvents searchYear(JPLEphems &ephems, int year);
+
+private:
+    open_fun _open;
+    search_fun _search;
+    std::map<int, YearEvents> _years;
+};
+
+// a header line, then cycle,year,month,leap,start,days per month
+void writeCsv(std::ostream &os, std::span<const CalendarMonth> months);
+// an array of {"cycle", "year", "month", "leap", "start", "days"} objects
+void writeJson(std::ostream &os, std::span<const CalendarMonth> months);
+
+// through a calendar kept per thread for the ephemeris file
 Date getDate(JPLEphems &ephems, const std::chrono::system_clock::time_point &tp);
+std::vector<Date> getDates(JPLEphems &ephems, std::span<const std::chrono::system_clock::time_point> tps);
+
 std::ostream& operator<<(std::ostream &os, const Date &d);
 
 }
@@ -0,0 +1,184 @@
+/**
+ * timescales.hpp
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#ifndef PAULYC_TIMESCALES_HPP
+#define PAULYC_TIMESCALES_HPP
+
+#include <chrono>
+#include <cmath>
+#include <span>
+#include <stdexcept>
+
+#include "delta_t.hpp"
+
+/*
+ * Conversions between julian dates in UTC, TAI, TT and TDB.
+ *
+ *   TAI - UTC  whole leap seconds from the IERS table, 10s at 1972-01-01 up to
+ *              37s since 2017-01-01 and assumed constant after. Before 1972 UTC
+ *              was steered to UT, so there TT - UTC is taken as ΔT instead.
+ *   TT  - TAI  32.184s exactly.
+ *   TDB - TT   periodic, under 2ms. By default the leading terms of the
+ *              Fairhead & Bretagnon series (USNO Circular 179 eq. 2.6, good to
+ *              ~10µs); conversions take any callable tdb_minus_tt(jd) -> seconds,
+ *              so a time ephemeris (JPLEphems::tdb_minus_tt) can be plugged in.
+ *
+ * Offsets are computed in double, they only need to be good to a nanosecond or
+ * so, and added to the long double dates at the end. The leap second lookup is
+ * a branchless count over the table and nothing here allocates, so conversions
+ * are cheap enough to do per epoch inside a search.
+ */
+struct timescales
+{
+    enum Scale {
+        UTC,
+        TAI,
+        TT,
+        TDB,
+    };
+
+    static constexpr double SECONDS_PER_DAY = 86400.0;
+    static constexpr double TT_MINUS_TAI = 32.184;
+    static constexpr double LEAP_SECONDS_EPOCH_JD = 2441317.5; // 1972-01-01 UTC
+    static constexpr double TAI_MINUS_UTC_1972 = 10.0;
+
+    // UTC julian dates of 0h on the days after each leap second
+    static constexpr double LEAP_SECONDS_JD[] = {
+        2441499.5, 2441683.5, 2442048.5, 2442413.5, 2442778.5, 2443144.5, 2443509.5,
+        2443874.5, 2444239.5, 2444786.5, 2445151.5, 2445516.5, 2446247.5, 2447161.5,
+        2447892.5, 2448257.5, 2448804.5, 2449169.5, 2449534.5, 2450083.5, 2450630.5,
+        2451179.5, 2453736.5, 2454832.5, 2456109.5, 2457204.5, 2457754.5,
+    };
+
+    struct fairhead {
+        double operator()(double tt_jd) const {
+            const double T = (tt_jd - 2451545.0) / 36525.0;
+            return 0.001657 * sin(628.3076 * T + 6.2401)
+                 + 0.000022 * sin(575.3385 * T + 4.2970)
+                 + 0.000014 * sin(1256.6152 * T + 6.1969)
+                 + 0.000005 * sin(606.9777 * T + 4.0212)
+                 + 0.000005 * sin(52.9691 * T + 0.4444)
+                 + 0.000002 * sin(21.3299 * T + 5.5431)
+                 + 0.000010 * T * sin(628.3076 * T + 4.2490);
+        }
+    };
+
+    // TAI - UTC in seconds at a UTC julian date, from 1972 on
+    static double tai_minus_utc(double utc_jd) {
+        int steps = 0;
+        for (double jd : LEAP_SECONDS_JD) {
+            steps += utc_jd >= jd;
+        }
+        return TAI_MINUS_UTC_1972 + steps;
+    }
+
+    // TT - UTC in seconds at a UTC julian date
+    static double tt_minus_utc(double utc_jd) {
+        const double leap = tai_minus_utc(utc_jd) + TT_MINUS_TAI;
+        const double ΔT = delta_t::seconds_at_jd(utc_jd);
+        return utc_jd >= LEAP_SECONDS_EPOCH_JD ? leap : ΔT;
+    }
+
+    // TDB - TT in seconds, from the analytic series
+    static double tdb_minus_tt(double tt_jd) {
+        return fairhead()(tt_jd);
+    }
+
+    // offset in seconds that takes a julian date in `from` to TT
+    template <typename TDBModel = fairhead>
+    static double to_tt(double jd, Scale from, const TDBModel &tdb_minus_tt = TDBModel()) {
+        switch (from) {
+        case UTC: return tt_minus_utc(jd);
+        case TAI: return TT_MINUS_TAI;
+        case TT: return 0.0;
+        // the argument should be TT, but 2ms early moves TDB - TT by ~1e-13s
+        case TDB: return -tdb_minus_tt(jd);
+        default: throw std::runtime_error("unknown time scale");
+        }
+    }
+
+    // offset in seconds that takes a TT julian date to `to`
+    template <typename TDBModel = fairhead>
+    static double from_tt(double tt_jd, Scale to, const TDBModel &tdb_minus_tt = TDBModel()) {
+        switch (to) {
+        case UTC: {
+            // TT - UTC is a function of UTC, one fixed point step settles it
+            // (except within the minute of a leap second, which is ambiguous anyway)
+            const double utc = tt_jd - tt_minus_utc(tt_jd) / SECONDS_PER_DAY;
+            return -tt_minus_utc(utc);
+        }
+        case TAI: return -TT_MINUS_TAI;
+        case TT: return 0.0;
+        case TDB: return tdb_minus_tt(tt_jd);
+        default: throw std::runtime_error("unknown time scale");
+        }
+    }
+
+    // jd can be any type with more precision than double (long double, mmm::ddouble);
+    // the offsets are doubles either way
+    template <typename TDBModel = fairhead, typename JD = long double>
+    static JD convert(JD jd, Scale from, Scale to, const TDBModel &tdb_minus_tt = TDBModel()) {
+        if (from == to) {
+            return jd;
+        }
+        const double a = to_tt(static_cast<double>(jd), from, tdb_minus_tt);
+        const JD tt = jd + a / SECONDS_PER_DAY;
+        const double b = from_tt(static_cast<double>(tt), to, tdb_minus_tt);
+        return tt + b / SECONDS_PER_DAY;
+    }
+
+    template <typename TDBModel = fairhead>
+    static void convert(std::span<const long double> in, std::span<long double> out, Scale from, Scale to, const TDBModel &tdb_minus_tt = TDBModel()) {
+        if (out.size() < in.size()) {
+            throw std::runtime_error("timescales::convert output span too small");
+        }
+        for (std::size_t i = 0; i < in.size(); ++i) {
+            out[i] = convert(in[i], from, to, tdb_minus_tt);
+        }
+    }
+};
+
+// Clocks counting julian days in one time scale, so dates in different scales
+// are different types and only meet through scale_cast
+template <timescales::Scale S>
+struct scale_clock
+{
+    typedef long double                         rep;
+    typedef std::ratio<86400>                   period;
+    typedef std::chrono::duration<rep, period>  duration;
+    typedef std::chrono::time_point<scale_clock> time_point;
+
+    static constexpr timescales::Scale scale = S;
+    static constexpr bool is_steady = S != timescales::UTC;
+};
+
+typedef scale_clock<timescales::UTC> utc_jd_clock;
+typedef scale_clock<timescales::TAI> tai_jd_clock;
+typedef scale_clock<timescales::TT>  tt_jd_clock;
+typedef scale_clock<timescales::TDB> tdb_jd_clock;
+
+template <typename ToClock, timescales::Scale From, typename TDBModel = timescales::fairhead>
+typename ToClock::time_point scale_cast(const std::chrono::time_point<scale_clock<From>> &tp, const TDBModel &tdb_minus_tt = TDBModel())
+{
+    const long double jd = timescales::convert(tp.time_since_epoch().count(), From, ToClock::scale, tdb_minus_tt);
+    return typename ToClock::time_point(typename ToClock::duration(jd));
+}
+
+#endif /* PAULYC_TIMESCALES_HPP */
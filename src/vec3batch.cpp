@@ -0,0 +1,433 @@
+/**
+ * vec3batch.cpp
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#include "vec3batch.hpp"
+#include "vmath.hpp"
+#include "jd_clock.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define PAULYC_VEC3BATCH_X86 1
+#include <immintrin.h>
+#endif
+
+namespace github {
+namespace paulyc {
+
+namespace {
+
+// points at the three streams of a batch
+struct Streams
+{
+    const double *x;
+    const double *y;
+    const double *z;
+};
+
+struct OutStreams
+{
+    double *x;
+    double *y;
+    double *z;
+};
+
+Streams streams(const Vec3BatchD &v) { return {v.x.data(), v.y.data(), v.z.data()}; }
+OutStreams streams(Vec3BatchD &v) { return {v.x.data(), v.y.data(), v.z.data()}; }
+
+// The kernels, once per instruction set. Each runs over [0, n); the AVX-512 ones
+// finish with a masked partial vector, the AVX2 ones with the scalar loop from
+// where they stopped.
+
+namespace scalar {
+
+void dot(Streams a, Streams b, double *out, std::size_t n, std::size_t begin = 0) {
+    for (std::size_t i = begin; i < n; ++i) {
+        out[i] = a.x[i] * b.x[i] + a.y[i] * b.y[i] + a.z[i] * b.z[i];
+    }
+}
+
+void cross(Streams a, Streams b, OutStreams out, std::size_t n, std::size_t begin = 0) {
+    for (std::size_t i = begin; i < n; ++i) {
+        const double x = a.y[i] * b.z[i] - a.z[i] * b.y[i];
+        const double y = a.z[i] * b.x[i] - a.x[i] * b.z[i];
+        const double z = a.x[i] * b.y[i] - a.y[i] * b.x[i];
+        out.x[i] = x;
+        out.y[i] = y;
+        out.z[i] = z;
+    }
+}
+
+void mag(Streams a, double *out, std::size_t n, std::size_t begin = 0) {
+    for (std::size_t i = begin; i < n; ++i) {
+        out[i] = std::sqrt(a.x[i] * a.x[i] + a.y[i] * a.y[i] + a.z[i] * a.z[i]);
+    }
+}
+
+void normalize(Streams a, OutStreams out, std::size_t n, std::size_t begin = 0) {
+    for (std::size_t i = begin; i < n; ++i) {
+        const double m = std::sqrt(a.x[i] * a.x[i] + a.y[i] * a.y[i] + a.z[i] * a.z[i]);
+        out.x[i] = a.x[i] / m;
+        out.y[i] = a.y[i] / m;
+        out.z[i] = a.z[i] / m;
+    }
+}
+
+// |a × b| and a · b, the two arguments of the angle's atan2
+void sinCos(Streams a, Streams b, double *s, double *c, std::size_t n, std::size_t begin = 0) {
+    for (std::size_t i = begin; i < n; ++i) {
+        const double x = a.y[i] * b.z[i] - a.z[i] * b.y[i];
+        const double y = a.z[i] * b.x[i] - a.x[i] * b.z[i];
+        const double z = a.x[i] * b.y[i] - a.y[i] * b.x[i];
+        s[i] = std::sqrt(x * x + y * y + z * z);
+        c[i] = a.x[i] * b.x[i] + a.y[i] * b.y[i] + a.z[i] * b.z[i];
+    }
+}
+
+// r and the distance from the z axis
+void radii(Streams a, double *r, double *rho, std::size_t n, std::size_t begin = 0) {
+    for (std::size_t i = begin; i < n; ++i) {
+        const double xy = a.x[i] * a.x[i] + a.y[i] * a.y[i];
+        r[i] = std::sqrt(xy + a.z[i] * a.z[i]);
+        rho[i] = std::sqrt(xy);
+    }
+}
+
+// m, row major, times each vector
+void rotate(const double *m, Streams a, OutStreams out, std::size_t n, std::size_t begin = 0) {
+    for (std::size_t i = begin; i < n; ++i) {
+        const double x = a.x[i], y = a.y[i], z = a.z[i];
+        out.x[i] = m[0] * x + m[1] * y + m[2] * z;
+        out.y[i] = m[3] * x + m[4] * y + m[5] * z;
+        out.z[i] = m[6] * x + m[7] * y + m[8] * z;
+    }
+}
+
+}
+
+#ifdef PAULYC_VEC3BATCH_X86
+
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+
+namespace avx2 {
+
+constexpr std::size_t W = 4;
+
+void dot(Streams a, Streams b, double *out, std::size_t n) {
+    std::size_t i = 0;
+    for (; i + W <= n; i += W) {
+        __m256d d = _mm256_mul_pd(_mm256_loadu_pd(a.x + i), _mm256_loadu_pd(b.x + i));
+        d = _mm256_fmadd_pd(_mm256_loadu_pd(a.y + i), _mm256_loadu_pd(b.y + i), d);
+        d = _mm256_fmadd_pd(_mm256_loadu_pd(a.z + i), _mm256_loadu_pd(b.z + i), d);
+        _mm256_storeu_pd(out + i, d);
+    }
+    scalar::dot(a, b, out, n, i);
+}
+
+void cross(Streams a, Streams b, OutStreams out, std::size_t n) {
+    std::size_t i = 0;
+    for (; i + W <= n; i += W) {
+        const __m256d ax = _mm256_loadu_pd(a.x + i), ay = _mm256_loadu_pd(a.y + i), az = _mm256_loadu_pd(a.z + i);
+        const __m256d bx = _mm256_loadu_pd(b.x + i), by = _mm256_loadu_pd(b.y + i), bz = _mm256_loadu_pd(b.z + i);
+        _mm256_storeu_pd(out.x + i, _mm256_fmsub_pd(ay, bz, _mm256_mul_pd(az, by)));
+        _mm256_storeu_pd(out.y + i, _mm256_fmsub_pd(az, bx, _mm256_mul_pd(ax, bz)));
+        _mm256_storeu_pd(out.z + i, _mm256_fmsub_pd(ax, by, _mm256_mul_pd(ay, bx)));
+    }
+    scalar::cross(a, b, out, n, i);
+}
+
+inline __m256d norm2(__m256d x, __m256d y, __m256d z) {
+    return _mm256_fmadd_pd(z, z, _mm256_fmadd_pd(y, y, _mm256_mul_pd(x, x)));
+}
+
+void mag(Streams a, double *out, std::size_t n) {
+    std::size_t i = 0;
+    for (; i + W <= n; i += W) {
+        const __m256d x = _mm256_loadu_pd(a.x + i), y = _mm256_loadu_pd(a.y + i), z = _mm256_loadu_pd(a.z + i);
+        _mm256_storeu_pd(out + i, _mm256_sqrt_pd(norm2(x, y, z)));
+    }
+    scalar::mag(a, out, n, i);
+}
+
+void normalize(Streams a, OutStreams out, std::size_t n) {
+    std::size_t i = 0;
+    for (; i + W <= n; i += W) {
+        const __m256d x = _mm256_loadu_pd(a.x + i), y = _mm256_loadu_pd(a.y + i), z = _mm256_loadu_pd(a.z + i);
+        const __m256d m = _mm256_sqrt_pd(norm2(x, y, z));
+        _mm256_storeu_pd(out.x + i, _mm256_div_pd(x, m));
+        _mm256_storeu_pd(out.y + i, _mm256_div_pd(y, m));
+        _mm256_storeu_pd(out.z + i, _mm256_div_pd(z, m));
+    }
+    scalar::normalize(a, out, n, i);
+}
+
+void sinCos(Streams a, Streams b, double *s, double *c, std::size_t n) {
+    std::size_t i = 0;
+    for (; i + W <= n; i += W) {
+        const __m256d ax = _mm256_loadu_pd(a.x + i), ay = _mm256_loadu_pd(a.y + i), az = _mm256_loadu_pd(a.z + i);
+        const __m256d bx = _mm256_loadu_pd(b.x + i), by = _mm256_loadu_pd(b.y + i), bz = _mm256_loadu_pd(b.z + i);
+        const __m256d x = _mm256_fmsub_pd(ay, bz, _mm256_mul_pd(az, by));
+        const __m256d y = _mm256_fmsub_pd(az, bx, _mm256_mul_pd(ax, bz));
+        const __m256d z = _mm256_fmsub_pd(ax, by, _mm256_mul_pd(ay, bx));
+        _mm256_storeu_pd(s + i, _mm256_sqrt_pd(norm2(x, y, z)));
+        _mm256_storeu_pd(c + i, _mm256_fmadd_pd(az, bz, _mm256_fmadd_pd(ay, by, _mm256_mul_pd(ax, bx))));
+    }
+    scalar::sinCos(a, b, s, c, n, i);
+}
+
+void radii(Streams a, double *r, double *rho, std::size_t n) {
+    std::size_t i = 0;
+    for (; i + W <= n; i += W) {
+        const __m256d x = _mm256_loadu_pd(a.x + i), y = _mm256_loadu_pd(a.y + i), z = _mm256_loadu_pd(a.z + i);
+        const __m256d xy = _mm256_fmadd_pd(y, y, _mm256_mul_pd(x, x));
+        _mm256_storeu_pd(r + i, _mm256_sqrt_pd(_mm256_fmadd_pd(z, z, xy)));
+        _mm256_storeu_pd(rho + i, _mm256_sqrt_pd(xy));
+    }
+    scalar::radii(a, r, rho, n, i);
+}
+
+void rotate(const double *m, Streams a, OutStreams out, std::size_t n) {
+    __m256d e[9];
+    for (int k = 0; k < 9; ++k) {
+        e[k] = _mm256_set1_pd(m[k]);
+    }
+    std::size_t i = 0;
+    for (; i + W <= n; i += W) {
+        const __m256d x = _mm256_loadu_pd(a.x + i), y = _mm256_loadu_pd(a.y + i), z = _mm256_loadu_pd(a.z + i);
+        _mm256_storeu_pd(out.x + i, _mm256_fmadd_pd(e[2], z, _mm256_fmadd_pd(e[1], y, _mm256_mul_pd(e[0], x))));
+        _mm256_storeu_pd(out.y + i, _mm256_fmadd_pd(e[5], z, _mm256_fmadd_pd(e[4], y, _mm256_mul_pd(e[3], x))));
+        _mm256_storeu_pd(out.z + i, _mm256_fmadd_pd(e[8], z, _mm256_fmadd_pd(e[7], y, _mm256_mul_pd(e[6], x))));
+    }
+    scalar::rotate(m, a, out, n, i);
+}
+
+}
+
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+
+namespace avx512 {
+
+constexpr std::size_t W = 8;
+
+// all lanes for a whole vector, the first n - i for the last partial one
+inline __mmask8 lanes(std::size_t i, std::size_t n) {
+    return n - i >= W ? __mmask8(0xff) : __mmask8((1u << (n - i)) - 1);
+}
+
+inline __m512d load(const double *p, __mmask8 m) {
+    return _mm512_maskz_loadu_pd(m, p);
+}
+
+inline __m512d norm2(__m512d x, __m512d y, __m512d z) {
+    return _mm512_fmadd_pd(z, z, _mm512_fmadd_pd(y, y, _mm512_mul_pd(x, x)));
+}
+
+void dot(Streams a, Streams b, double *out, std::size_t n) {
+    for (std::size_t i = 0; i < n; i += W) {
+        const __mmask8 m = lanes(i, n);
+        __m512d d = _mm512_mul_pd(load(a.x + i, m), load(b.x + i, m));
+        d = _mm512_fmadd_pd(load(a.y + i, m), load(b.y + i, m), d);
+        d = _mm512_fmadd_pd(load(a.z + i, m), load(b.z + i, m), d);
+        _mm512_mask_storeu_pd(out + i, m, d);
+    }
+}
+
+void cross(Streams a, Streams b, OutStreams out, std::size_t n) {
+    for (std::size_t i = 0; i < n; i += W) {
+        const __mmask8 m = lanes(i, n);
+        const __m512d ax = load(a.x + i, m), ay = load(a.y + i, m), az = load(a.z + i, m);
+        const __m512d bx = load(b.x + i, m), by = load(b.y + i, m), bz = load(b.z + i, m);
+        _mm512_mask_storeu_pd(out.x + i, m, _mm512_fmsub_pd(ay, bz, _mm512_mul_pd(az, by)));
+        _mm512_mask_storeu_pd(out.y + i, m, _mm512_fmsub_pd(az, bx, _mm512_mul_pd(ax, bz)));
+        _mm512_mask_storeu_pd(out.z + i, m, _mm512_fmsub_pd(ax, by, _mm512_mul_pd(ay, bx)));
+    }
+}
+
+void mag(Streams a, double *out, std::size_t n) {
+    for (std::size_t i = 0; i < n; i += W) {
+        const __mmask8 m = lanes(i, n);
+        const __m512d x = load(a.x + i, m), y = load(a.y + i, m), z = load(a.z + i, m);
+        _mm512_mask_storeu_pd(out + i, m, _mm512_sqrt_pd(norm2(x, y, z)));
+    }
+}
+
+void normalize(Streams a, OutStreams out, std::size_t n) {
+    for (std::size_t i = 0; i < n; i += W) {
+        const __mmask8 m = lanes(i, n);
+        const __m512d x = load(a.x + i, m), y = load(a.y + i, m), z = load(a.z + i, m);
+        const __m512d r = _mm512_sqrt_pd(norm2(x, y, z));
+        _mm512_mask_storeu_pd(out.x + i, m, _mm512_div_pd(x, r));
+        _mm512_mask_storeu_pd(out.y + i, m, _mm512_div_pd(y, r));
+        _mm512_mask_storeu_pd(out.z + i, m, _mm512_div_pd(z, r));
+    }
+}
+
+void sinCos(Streams a, Streams b, double *s, double *c, std::size_t n) {
+    for (std::size_t i = 0; i < n; i += W) {
+        const __mmask8 m = lanes(i, n);
+        const __m512d ax = load(a.x + i, m), ay = load(a.y + i, m), az = load(a.z + i, m);
+        const __m512d bx = load(b.x + i, m), by = load(b.y + i, m), bz = load(b.z + i, m);
+        const __m512d x = _mm512_fmsub_pd(ay, bz, _mm512_mul_pd(az, by));
+        const __m512d y = _mm512_fmsub_pd(az, bx, _mm512_mul_pd(ax, bz));
+        const __m512d z = _mm512_fmsub_pd(ax, by, _mm512_mul_pd(ay, bx));
+        _mm512_mask_storeu_pd(s + i, m, _mm512_sqrt_pd(norm2(x, y, z)));
+        _mm512_mask_storeu_pd(c + i, m, _mm512_fmadd_pd(az, bz, _mm512_fmadd_pd(ay, by, _mm512_mul_pd(ax, bx))));
+    }
+}
+
+void radii(Streams a, double *r, double *rho, std::size_t n) {
+    for (std::size_t i = 0; i < n; i += W) {
+        const __mmask8 m = lanes(i, n);
+        const __m512d x = load(a.x + i, m), y = load(a.y + i, m), z = load(a.z + i, m);
+        const __m512d xy = _mm512_fmadd_pd(y, y, _mm512_mul_pd(x, x));
+        _mm512_mask_storeu_pd(r + i, m, _mm512_sqrt_pd(_mm512_fmadd_pd(z, z, xy)));
+        _mm512_mask_storeu_pd(rho + i, m, _mm512_sqrt_pd(xy));
+    }
+}
+
+void rotate(const double *r, Streams a, OutStreams out, std::size_t n) {
+    __m512d e[9];
+    for (int k = 0; k < 9; ++k) {
+        e[k] = _mm512_set1_pd(r[k]);
+    }
+    for (std::size_t i = 0; i < n; i += W) {
+        const __mmask8 m = lanes(i, n);
+        const __m512d x = load(a.x + i, m), y = load(a.y + i, m), z = load(a.z + i, m);
+        _mm512_mask_storeu_pd(out.x + i, m, _mm512_fmadd_pd(e[2], z, _mm512_fmadd_pd(e[1], y, _mm512_mul_pd(e[0], x))));
+        _mm512_mask_storeu_pd(out.y + i, m, _mm512_fmadd_pd(e[5], z, _mm512_fmadd_pd(e[4], y, _mm512_mul_pd(e[3], x))));
+        _mm512_mask_storeu_pd(out.z + i, m, _mm512_fmadd_pd(e[8], z, _mm512_fmadd_pd(e[7], y, _mm512_mul_pd(e[6], x))));
+    }
+}
+
+}
+
+#pragma GCC pop_options
+
+#endif /* PAULYC_VEC3BATCH_X86 */
+
+void checkSizes(const char *op, std::size_t n, std::size_t m, std::size_t out) {
+    if (m != n) {
+        throw std::runtime_error("batch::%s input sizes differ: %zu and %zu"_fmt.format(op, n, m));
+    }
+    if (out < n) {
+        throw std::runtime_error("batch::%s output span too small"_fmt.format(op));
+    }
+}
+
+// the ones with trigonometry go a block at a time, the algebra in one vectorized
+// pass and the vmath functions in another
+constexpr std::size_t BLOCK = 512;
+
+}
+
+namespace batch {
+
+#ifdef PAULYC_VEC3BATCH_X86
+#define PAULYC_DISPATCH(level, kernel, ...) \
+    switch (usableSimdLevel(level)) { \
+    case SimdLevel::AVX512: avx512::kernel(__VA_ARGS__); break; \
+    case SimdLevel::AVX2: avx2::kernel(__VA_ARGS__); break; \
+    default: scalar::kernel(__VA_ARGS__); break; \
+    }
+#else
+#define PAULYC_DISPATCH(level, kernel, ...) scalar::kernel(__VA_ARGS__)
+#endif
+
+void dot(const Vec3BatchD &a, const Vec3BatchD &b, std::span<double> out, SimdLevel level) {
+    checkSizes("dot", a.size(), b.size(), out.size());
+    PAULYC_DISPATCH(level, dot, streams(a), streams(b), out.data(), a.size());
+}
+
+void cross(const Vec3BatchD &a, const Vec3BatchD &b, Vec3BatchD &out, SimdLevel level) {
+    checkSizes("cross", a.size(), b.size(), a.size());
+    out.resize(a.size());
+    PAULYC_DISPATCH(level, cross, streams(a), streams(b), streams(out), a.size());
+}
+
+void mag(const Vec3BatchD &a, std::span<double> out, SimdLevel level) {
+    checkSizes("mag", a.size(), a.size(), out.size());
+    PAULYC_DISPATCH(level, mag, streams(a), out.data(), a.size());
+}
+
+void normalize(const Vec3BatchD &a, Vec3BatchD &out, SimdLevel level) {
+    out.resize(a.size());
+    PAULYC_DISPATCH(level, normalize, streams(a), streams(out), a.size());
+}
+
+void angle(const Vec3BatchD &a, const Vec3BatchD &b, std::span<double> out, SimdLevel level) {
+    checkSizes("angle", a.size(), b.size(), out.size());
+    double c[BLOCK];
+    for (std::size_t i = 0; i < a.size(); i += BLOCK) {
+        const std::size_t n = std::min(BLOCK, a.size() - i);
+        const Streams as = {a.x.data() + i, a.y.data() + i, a.z.data() + i};
+        const Streams bs = {b.x.data() + i, b.y.data() + i, b.z.data() + i};
+        const std::span<double> s = out.subspan(i, n);
+        PAULYC_DISPATCH(level, sinCos, as, bs, s.data(), c, n);
+        vmath::atan2(s, std::span<const double>(c, n), s, level);
+    }
+}
+
+void cart2sph(const Vec3BatchD &cart, Vec3BatchD &sph, SimdLevel level) {
+    sph.resize(cart.size());
+    double r[BLOCK], rho[BLOCK], θ[BLOCK];
+    for (std::size_t i = 0; i < cart.size(); i += BLOCK) {
+        const std::size_t n = std::min(BLOCK, cart.size() - i);
+        const Streams in = {cart.x.data() + i, cart.y.data() + i, cart.z.data() + i};
+        PAULYC_DISPATCH(level, radii, in, r, rho, n);
+        vmath::atan2(std::span<const double>(rho, n), std::span<const double>(in.z, n), std::span<double>(θ, n), level);
+        // ø last, since sph may be cart and it overwrites z
+        vmath::atan2(std::span<const double>(in.y, n), std::span<const double>(in.x, n), std::span<double>(sph.z.data() + i, n), level);
+        std::copy(r, r + n, sph.x.data() + i);
+        std::copy(θ, θ + n, sph.y.data() + i);
+    }
+}
+
+void sph2cart(const Vec3BatchD &sph, Vec3BatchD &cart, SimdLevel level) {
+    cart.resize(sph.size());
+    double sin_θ[BLOCK], cos_θ[BLOCK], sin_ø[BLOCK], cos_ø[BLOCK];
+    for (std::size_t i = 0; i < sph.size(); i += BLOCK) {
+        const std::size_t n = std::min(BLOCK, sph.size() - i);
+        vmath::sincos(std::span<const double>(sph.y.data() + i, n), sin_θ, cos_θ, level);
+        vmath::sincos(std::span<const double>(sph.z.data() + i, n), sin_ø, cos_ø, level);
+        for (std::size_t j = 0; j < n; ++j) {
+            const double r = sph.x[i + j];
+            cart.x[i + j] = r * sin_θ[j] * cos_ø[j];
+            cart.y[i + j] = r * sin_θ[j] * sin_ø[j];
+            cart.z[i + j] = r * cos_θ[j];
+        }
+    }
+}
+
+void rotate(const mat3x3<double> &m, const Vec3BatchD &in, Vec3BatchD &out, SimdLevel level) {
+    out.resize(in.size());
+    PAULYC_DISPATCH(level, rotate, &m.elems[0][0], streams(in), streams(out), in.size());
+}
+
+#undef PAULYC_DISPATCH
+
+}
+
+} /* namespace paulyc */
+} /* namespace github */
@@ -0,0 +1,140 @@
+/**
+ * vec3batch.hpp
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#ifndef PAULYC_VEC3BATCH_HPP
+#define PAULYC_VEC3BATCH_HPP
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+#include "lalgebra.hpp"
+#include "simd.hpp"
+
+namespace github {
+namespace paulyc {
+
+// std::allocator with the alignment of a cache line, which is also that of a zmm register
+template <typename T, std::size_t Align = 64>
+struct aligned_allocator
+{
+    typedef T value_type;
+    template <typename U> struct rebind { typedef aligned_allocator<U, Align> other; };
+
+    aligned_allocator() = default;
+    template <typename U>
+    constexpr aligned_allocator(const aligned_allocator<U, Align> &) noexcept {}
+
+    T* allocate(std::size_t n) {
+        if (n > std::size_t(-1) / sizeof(T)) {
+            throw std::bad_array_new_length();
+        }
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t(Align)));
+    }
+    void deallocate(T *p, std::size_t) noexcept {
+        ::operator delete(p, std::align_val_t(Align));
+    }
+
+    template <typename U>
+    bool operator==(const aligned_allocator<U, Align> &) const noexcept { return true; }
+};
+
+template <typename T>
+using aligned_vector = std::vector<T, aligned_allocator<T>>;
+
+// A structure-of-arrays batch of 3-vectors, so that a time series of positions
+// is three contiguous streams that SIMD kernels can run down. Interchangeable
+// one element at a time with vec3 and friends; spherical vectors use the same
+// layout with (r, θ, ø) in (x, y, z) as basic_spherical3dvec does.
+template <typename T = double>
+struct Vec3Batch
+{
+    typedef T TT;
+    aligned_vector<T> x;
+    aligned_vector<T> y;
+    aligned_vector<T> z;
+
+    Vec3Batch() = default;
+    explicit Vec3Batch(std::size_t n) : x(n), y(n), z(n) {}
+
+    template <typename U>
+    explicit Vec3Batch(std::span<const U> vs) {
+        reserve(vs.size());
+        for (const U &v : vs) {
+            push_back(v);
+        }
+    }
+
+    std::size_t size() const { return x.size(); }
+    bool empty() const { return x.empty(); }
+    void reserve(std::size_t n) { x.reserve(n); y.reserve(n); z.reserve(n); }
+    void resize(std::size_t n) { x.resize(n); y.resize(n); z.resize(n); }
+    void clear() { x.clear(); y.clear(); z.clear(); }
+
+    template <typename U>
+    void push_back(const vec3<U> &v) {
+        x.push_back(T(v.raw[0]));
+        y.push_back(T(v.raw[1]));
+        z.push_back(T(v.raw[2]));
+    }
+
+    template <typename U>
+    void set(std::size_t i, const vec3<U> &v) {
+        x[i] = T(v.raw[0]);
+        y[i] = T(v.raw[1]);
+        z[i] = T(v.raw[2]);
+    }
+
+    basic_cartesian3dvec<T> cartesian(std::size_t i) const {
+        return {{x[i], y[i], z[i]}};
+    }
+
+    basic_spherical3dvec<T> spherical(std::size_t i) const {
+        return {{x[i], y[i], z[i]}};
+    }
+};
+
+typedef Vec3Batch<double> Vec3BatchD;
+
+// Element-wise operations over whole batches. Outputs must be at least as long
+// as the inputs, which must be the same length; out may alias an input.
+namespace batch {
+
+void dot(const Vec3BatchD &a, const Vec3BatchD &b, std::span<double> out, SimdLevel level = detectedSimdLevel());
+void cross(const Vec3BatchD &a, const Vec3BatchD &b, Vec3BatchD &out, SimdLevel level = detectedSimdLevel());
+void mag(const Vec3BatchD &a, std::span<double> out, SimdLevel level = detectedSimdLevel());
+void normalize(const Vec3BatchD &a, Vec3BatchD &out, SimdLevel level = detectedSimdLevel());
+// atan2(|a × b|, a · b), which unlike acos keeps its precision near 0 and π
+void angle(const Vec3BatchD &a, const Vec3BatchD &b, std::span<double> out, SimdLevel level = detectedSimdLevel());
+// to (r, θ, ø) as in basic_spacexfrm3d::cart2sph, θ from +z and ø from +x
+void cart2sph(const Vec3BatchD &cart, Vec3BatchD &sph, SimdLevel level = detectedSimdLevel());
+void sph2cart(const Vec3BatchD &sph, Vec3BatchD &cart, SimdLevel level = detectedSimdLevel());
+// m v for every v, eg. a frame rotation composed once
+void rotate(const mat3x3<double> &m, const Vec3BatchD &in, Vec3BatchD &out, SimdLevel level = detectedSimdLevel());
+
+}
+
+} /* namespace paulyc */
+} /* namespace github */
+
+#endif /* PAULYC_VEC3BATCH_HPP */
@@ -0,0 +1,216 @@
+/**
+ * vmath.cpp
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#include "vmath.hpp"
+#include "jd_clock.hpp"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define PAULYC_VMATH_X86 1
+#include <immintrin.h>
+#endif
+
+// the kernels pass vectors by value between functions of the same target,
+// never across the ABI boundary GCC warns about
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+namespace github {
+namespace paulyc {
+namespace vmath {
+
+namespace {
+
+constexpr std::int64_t SIGN_BIT = INT64_MIN;
+
+// adding 1.5 * 2^52 rounds to an integer, and leaves it in the low mantissa bits
+constexpr double ROUND_MAGIC = 6755399441055744.0;
+constexpr double TWO_OVER_PI = 0.63661977236758134308;
+
+// π/2 in three pieces, the first two short enough that q times them is exact for q < 2^28
+constexpr double PIO2_1 = 1.57079625129699707031e0;
+constexpr double PIO2_2 = 7.54978941586159635336e-8;
+constexpr double PIO2_3 = 5.39030285815811905290e-15;
+
+constexpr double PIO4 = 7.85398163397448309616e-1;
+constexpr double PIO2_HI = 1.57079632679489661923e0;
+constexpr double PIO2_LO = 6.123233995736765886130e-17;
+constexpr double PI_HI = 3.14159265358979323846e0;
+constexpr double PI_LO = 1.2246467991473531772e-16;
+
+// Cephes sin.c, on |r| <= π/4
+constexpr double SIN_COEF[] = {
+     1.58962301576546568060e-10,
+    -2.50507477628578072866e-8,
+     2.75573136213857245213e-6,
+    -1.98412698295895385996e-4,
+     8.33333333332211858878e-3,
+    -1.66666666666666307295e-1,
+};
+constexpr double COS_COEF[] = {
+    -1.13585365213876817300e-11,
+     2.08757008419747316778e-9,
+    -2.75573141792967388112e-7,
+     2.48015872888517045348e-5,
+    -1.38888888888730564116e-3,
+     4.16666666666665929218e-2,
+};
+
+// Cephes atan.c, P/Q on |x| <= 0.66
+constexpr double ATAN_P[] = {
+    -8.750608600031904122785e-1,
+    -1.615753718733365076637e1,
+    -7.500855792314704667340e1,
+    -1.228866684490136173410e2,
+    -6.485021904942025371773e1,
+};
+constexpr double ATAN_Q[] = {
+     1.0,
+     2.485846490142306297962e1,
+     1.650270098316988542046e2,
+     4.328810604912902668951e2,
+     4.853903996359136964868e2,
+     1.945506571482613964425e2,
+};
+
+// the baseline: SSE2 on x86-64, whatever GCC makes of it elsewhere
+namespace base {
+
+constexpr std::size_t W = 2;
+typedef double V __attribute__((vector_size(W * sizeof(double))));
+typedef std::int64_t VI __attribute__((vector_size(W * sizeof(double))));
+
+inline V vsqrt(V v) {
+#ifdef __SSE2__
+    return _mm_sqrt_pd(v);
+#else
+    for (std::size_t l = 0; l < W; ++l) {
+        v[l] = std::sqrt(v[l]);
+    }
+    return v;
+#endif
+}
+
+#include "vmath_kernels.inc"
+
+}
+
+#ifdef PAULYC_VMATH_X86
+
+#pragma GCC push_options
+#pragma GCC target("avx2,fma")
+
+namespace avx2 {
+
+constexpr std::size_t W = 4;
+typedef double V __attribute__((vector_size(W * sizeof(double))));
+typedef std::int64_t VI __attribute__((vector_size(W * sizeof(double))));
+
+inline V vsqrt(V v) {
+    return _mm256_sqrt_pd(v);
+}
+
+#include "vmath_kernels.inc"
+
+}
+
+#pragma GCC pop_options
+
+#pragma GCC push_options
+#pragma GCC target("avx512f")
+
+namespace avx512 {
+
+constexpr std::size_t W = 8;
+typedef double V __attribute__((vector_size(W * sizeof(double))));
+typedef std::int64_t VI __attribute__((vector_size(W * sizeof(double))));
+
+inline V vsqrt(V v) {
+    return _mm512_sqrt_pd(v);
+}
+
+#include "vmath_kernels.inc"
+
+}
+
+#pragma GCC pop_options
+
+#endif /* PAULYC_VMATH_X86 */
+
+void checkSizes(const char *op, std::size_t n, std::size_t m, std::size_t out) {
+    if (m != n) {
+        throw std::runtime_error("vmath::%s input sizes differ: %zu and %zu"_fmt.format(op, n, m));
+    }
+    if (out < n) {
+        throw std::runtime_error("vmath::%s output span too small"_fmt.format(op));
+    }
+}
+
+}
+
+#ifdef PAULYC_VMATH_X86
+#define PAULYC_DISPATCH(level, kernel, ...) \
+    switch (usableSimdLevel(level)) { \
+    case SimdLevel::AVX512: avx512::kernel(__VA_ARGS__); break; \
+    case SimdLevel::AVX2: avx2::kernel(__VA_ARGS__); break; \
+    default: base::kernel(__VA_ARGS__); break; \
+    }
+#else
+#define PAULYC_DISPATCH(level, kernel, ...) base::kernel(__VA_ARGS__)
+#endif
+
+void sin(std::span<const double> x, std::span<double> out, SimdLevel level) {
+    checkSizes("sin", x.size(), x.size(), out.size());
+    PAULYC_DISPATCH(level, sin, x.data(), out.data(), x.size());
+}
+
+void cos(std::span<const double> x, std::span<double> out, SimdLevel level) {
+    checkSizes("cos", x.size(), x.size(), out.size());
+    PAULYC_DISPATCH(level, cos, x.data(), out.data(), x.size());
+}
+
+void sincos(std::span<const double> x, std::span<double> s, std::span<double> c, SimdLevel level) {
+    checkSizes("sincos", x.size(), x.size(), std::min(s.size(), c.size()));
+    PAULYC_DISPATCH(level, sincos, x.data(), s.data(), c.data(), x.size());
+}
+
+void atan2(std::span<const double> y, std::span<const double> x, std::span<double> out, SimdLevel level) {
+    checkSizes("atan2", y.size(), x.size(), out.size());
+    PAULYC_DISPATCH(level, atan2, y.data(), x.data(), out.data(), y.size());
+}
+
+void asin(std::span<const double> x, std::span<double> out, SimdLevel level) {
+    checkSizes("asin", x.size(), x.size(), out.size());
+    PAULYC_DISPATCH(level, asin, x.data(), out.data(), x.size());
+}
+
+void acos(std::span<const double> x, std::span<double> out, SimdLevel level) {
+    checkSizes("acos", x.size(), x.size(), out.size());
+    PAULYC_DISPATCH(level, acos, x.data(), out.data(), x.size());
+}
+
+#undef PAULYC_DISPATCH
+
+}
+} /* namespace paulyc */
+} /* namespace github */
@@ -0,0 +1,64 @@
+/**
+ * vmath.hpp
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#ifndef PAULYC_VMATH_HPP
+#define PAULYC_VMATH_HPP
+
+#include <span>
+
+#include "simd.hpp"
+
+namespace github {
+namespace paulyc {
+
+/*
+ * Double precision sin, cos, atan2, asin and acos over whole arrays, a SIMD
+ * vector at a time: Cephes' polynomials with Cody-Waite argument reduction,
+ * written once with GCC vector extensions and compiled per instruction set.
+ *
+ * Error against the correctly rounded result, the most seen over millions
+ * of random arguments at each instruction set:
+ *   sin, cos, sincos    2 ulp for |x| <= TRIG_REDUCTION_LIMIT, libm beyond it.
+ *                       π/2 is carried to ~100 bits in the reduction, so within
+ *                       ~1e-17 of a zero the error is up to 1e-25 absolute
+ *                       rather than relative.
+ *   atan2               2 ulp
+ *   asin, acos          3 ulp, as atan2(x, √(1-x²)) and atan2(√(1-x²), x)
+ * NaN in gives NaN out; atan2 keeps the signed zero and infinity cases of
+ * std::atan2. Outputs must be at least as long as the inputs and may be the
+ * same array.
+ */
+namespace vmath {
+
+static constexpr double TRIG_REDUCTION_LIMIT = 131072.0;
+
+void sin(std::span<const double> x, std::span<double> out, SimdLevel level = detectedSimdLevel());
+void cos(std::span<const double> x, std::span<double> out, SimdLevel level = detectedSimdLevel());
+void sincos(std::span<const double> x, std::span<double> s, std::span<double> c, SimdLevel level = detectedSimdLevel());
+void atan2(std::span<const double> y, std::span<const double> x, std::span<double> out, SimdLevel level = detectedSimdLevel());
+void asin(std::span<const double> x, std::span<double> out, SimdLevel level = detectedSimdLevel());
+void acos(std::span<const double> x, std::span<double> out, SimdLevel level = detectedSimdLevel());
+
+}
+
+} /* namespace paulyc */
+} /* namespace github */
+
+#endif /* PAULYC_VMATH_HPP */
@@ -0,0 +1,128 @@
+/**
+ * apparent.cpp tests
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#include <gtest/gtest.h>
+#include "../src/apparent.hpp"
+#include "synthetic_sky.hpp"
+
+namespace {
+
+using namespace github::paulyc;
+using synthetic::Sky;
+using synthetic::at;
+
+static constexpr double JD = Sky::T0 + 1234.56;
+static constexpr double ARCSEC = M_PI / 648000.0;
+static constexpr double C_AU_PER_DAY = 299792.458 * 86400.0 / Sky::AU_KM;
+
+std::array<double, 3> geocentric(double jd, JPLEphems::Point body, double earthJd) {
+    const std::array<double, 3> b = Sky::ecliptic(jd, body), e = Sky::ecliptic(earthJd, JPLEphems::Earth);
+    return {b[0] - e[0], b[1] - e[1], b[2] - e[2]};
+}
+
+double norm(const std::array<double, 3> &v) {
+    return std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+}
+
+double longitude(const cartesian3dvec &v) {
+    return static_cast<double>(atan2l(v.y(), v.x()));
+}
+
+TEST(apparent_test_suite, test_geometric_and_light_time) {
+    JPLEphems ephems;
+    Sky::open(ephems);
+    ApparentPlace place(ephems);
+
+    const cartesian3dvec g = place.ecliptic(JPLEphems::Jupiter, at(JD), ApparentPlace::Geometric);
+    const std::array<double, 3> expected = geocentric(JD, JPLEphems::Jupiter, JD);
+    for (int k = 0; k < 3; ++k) {
+        ASSERT_NEAR(static_cast<double>(g.raw[k]), expected[k], 1e-12);
+    }
+
+    // where Jupiter was when the light now arriving left it: |p| = c τ
+    const cartesian3dvec p = place.ecliptic(JPLEphems::Jupiter, at(JD), ApparentPlace::LightTime);
+    const double τ = static_cast<double>(p.mag()) / C_AU_PER_DAY;
+    ASSERT_GT(τ, 0.0);
+    const std::array<double, 3> retarded = geocentric(JD - τ, JPLEphems::Jupiter, JD);
+    for (int k = 0; k < 3; ++k) {
+        ASSERT_NEAR(static_cast<double>(p.raw[k]), retarded[k], 1e-11);
+    }
+    // and again a day on, where the iteration starts from the last light time
+    const cartesian3dvec q = place.ecliptic(JPLEphems::Jupiter, at(JD + 1.0), ApparentPlace::LightTime);
+    const double τq = static_cast<double>(q.mag()) / C_AU_PER_DAY;
+    const std::array<double, 3> retardedq = geocentric(JD + 1.0 - τq, JPLEphems::Jupiter, JD + 1.0);
+    for (int k = 0; k < 3; ++k) {
+        ASSERT_NEAR(static_cast<double>(q.raw[k]), retardedq[k], 1e-11);
+    }
+}
+
+TEST(apparent_test_suite, test_aberration) {
+    JPLEphems ephems;
+    Sky::open(ephems);
+    ApparentPlace place(ephems);
+
+    // the Sun doesn't move here, so its apparent place is aberration alone:
+    // displaced toward the Earth's velocity by v/c, ~20.5"
+    const double geometric = longitude(place.ecliptic(JPLEphems::Sun, at(JD), ApparentPlace::Geometric));
+    const double apparent = longitude(place.ecliptic(JPLEphems::Sun, at(JD), ApparentPlace::LightTime | ApparentPlace::Aberration));
+    double pv[6];
+    Sky::state(JD, JPLEphems::Earth, pv);
+    const std::array<double, 3> u = geocentric(JD, JPLEphems::Sun, JD);
+    const double r = norm(u);
+    // first order u + V, in the ecliptic
+    const double vx = pv[3] / C_AU_PER_DAY;
+    const double vy = (std::cos(static_cast<double>(OBLIQUITY_J2000)) * pv[4] + std::sin(static_cast<double>(OBLIQUITY_J2000)) * pv[5]) / C_AU_PER_DAY;
+    const double expected = std::atan2(u[1] / r + vy, u[0] / r + vx);
+    ASSERT_NEAR(synthetic::wrap(apparent - expected), 0.0, 5e-9);
+    const double Δλ = synthetic::wrap(apparent - geometric);
+    ASSERT_LT(Δλ, -20.0 * ARCSEC);
+    ASSERT_GT(Δλ, -21.2 * ARCSEC);
+}
+
+TEST(apparent_test_suite, test_precession_and_nutation) {
+    JPLEphems ephems;
+    Sky::open(ephems);
+    ApparentPlace place(ephems);
+
+    const double geometric = longitude(place.ecliptic(JPLEphems::Mars, at(JD), ApparentPlace::Geometric));
+    const double precessed = longitude(place.ecliptic(JPLEphems::Mars, at(JD), ApparentPlace::Precession));
+    ASSERT_NEAR(synthetic::wrap(precessed - geometric), static_cast<double>(ApparentPlace::precessionInLongitude(JD)), 1e-13);
+
+    double nutation[6];
+    Sky::state(JD, JPLEphems::Nutations, nutation);
+    const double nutated = longitude(place.ecliptic(JPLEphems::Mars, at(JD), ApparentPlace::Nutation));
+    ASSERT_NEAR(synthetic::wrap(nutated - geometric), nutation[0], 1e-13);
+
+    // a little later the cached angle is carried forward with its rate
+    const double later = JD + 0.4;
+    Sky::state(later, JPLEphems::Nutations, nutation);
+    const double geometricLater = longitude(place.ecliptic(JPLEphems::Mars, at(later), ApparentPlace::Geometric));
+    const double nutatedLater = longitude(place.ecliptic(JPLEphems::Mars, at(later), ApparentPlace::Nutation));
+    ASSERT_NEAR(synthetic::wrap(nutatedLater - geometricLater), nutation[0], 0.01 * ARCSEC);
+
+    // the rate against a central difference of the angle
+    for (const double jd : {Sky::T0 - 36525.0, Sky::T0, Sky::T0 + 36525.0}) {
+        const long double h = 10.0l;
+        const long double numeric = (ApparentPlace::precessionInLongitude(jd + h) - ApparentPlace::precessionInLongitude(jd - h)) / (2.0l * h);
+        ASSERT_NEAR(static_cast<double>(ApparentPlace::precessionRate(jd)), static_cast<double>(numeric), 1e-15);
+    }
+}
+
+}
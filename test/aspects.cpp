@@ -0,0 +1,96 @@
+/**
+ * aspects.cpp tests
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#include <gtest/gtest.h>
+#include "../src/aspects.hpp"
+#include "split_range.hpp"
+
+#include <algorithm>
+
+namespace {
+
+using namespace github::paulyc;
+using synthetic::Sky;
+using synthetic::at;
+using synthetic::jdOf;
+
+static constexpr double FROM = Sky::T0;
+static constexpr double TO = FROM + 90.0;
+static constexpr double SPLIT = FROM + 41.7;
+
+double separation(double jd, JPLEphems::Point a, JPLEphems::Point b) {
+    return synthetic::wrap(Sky::longitude(jd, a) - Sky::longitude(jd, b));
+}
+
+// crossings of every aspect angle by every pair, counted on a fine grid
+std::size_t scanCount() {
+    static constexpr double STEP = 0.02;
+    static constexpr double ANGLES[] = {0.0, M_PI / 3.0, -M_PI / 3.0, M_PI / 2.0, -M_PI / 2.0, 2.0 * M_PI / 3.0, -2.0 * M_PI / 3.0, M_PI};
+    std::size_t count = 0;
+    for (std::size_t i = 0; i < Aspect::NBODIES; ++i) {
+        for (std::size_t j = i + 1; j < Aspect::NBODIES; ++j) {
+            double prev = separation(FROM, Aspect::BODIES[i], Aspect::BODIES[j]);
+            for (double jd = FROM + STEP; jd < TO + STEP / 2.0; jd += STEP) {
+                const double next = separation(std::min(jd, TO), Aspect::BODIES[i], Aspect::BODIES[j]);
+                for (const double θ : ANGLES) {
+                    const double a = synthetic::wrap(prev - θ), b = synthetic::wrap(next - θ);
+                    count += (a < 0.0) != (b < 0.0) && std::fabs(b - a) < M_PI;
+                }
+                prev = next;
+            }
+        }
+    }
+    return count;
+}
+
+TEST(aspects_test_suite, test_find_aspects) {
+    JPLEphems ephems;
+    Sky::open(ephems);
+    const std::vector<Aspect> aspects = findAspects(ephems, at(FROM), at(TO));
+    ASSERT_EQ(aspects.size(), scanCount());
+    ASSERT_TRUE(std::is_sorted(aspects.begin(), aspects.end(), [](const Aspect &a, const Aspect &b) {
+        return a.jd < b.jd;
+    }));
+
+    std::size_t sunMoon = 0;
+    for (const Aspect &a : aspects) {
+        const double jd = jdOf(a);
+        ASSERT_GE(jd, FROM);
+        ASSERT_LT(jd, TO);
+        ASSERT_NEAR(std::fabs(static_cast<double>(a.separation)), Aspect::degrees(a.kind) * M_PI / 180.0, 1e-9);
+        ASSERT_NEAR(synthetic::wrap(separation(jd, a.a, a.b) - static_cast<double>(a.separation)), 0.0, 1e-9);
+        sunMoon += a.a == JPLEphems::Sun && a.b == JPLEphems::Moon;
+    }
+    // eight aspect angles a synodic month
+    ASSERT_GE(sunMoon, 24u);
+    ASSERT_LE(sunMoon, 25u);
+}
+
+TEST(aspects_test_suite, test_split_range) {
+    JPLEphems ephems;
+    Sky::open(ephems);
+    synthetic::expectSplitRange([&](const jd_clock::time_point &from, const jd_clock::time_point &to) {
+        return findAspects(ephems, from, to);
+    }, FROM, SPLIT, TO, [](const Aspect &x, const Aspect &y) {
+        return x.a == y.a && x.b == y.b && x.kind == y.kind;
+    });
+}
+
+}
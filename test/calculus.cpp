@@ -0,0 +1,219 @@
+/**
+ * calculus.cpp tests
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#include <gtest/gtest.h>
+#include "../src/calculus.hpp"
+#include "../src/solvers.hpp"
+#include "../src/chebyshev.hpp"
+
+namespace {
+
+using namespace github::paulyc;
+
+TEST(calculus_test_suite, test_d_op_templates) {
+    const auto f = [](long double x) { return sinl(x) * expl(-0.1l * x); };
+    const auto df = [](long double x) { return expl(-0.1l * x) * (cosl(x) - 0.1l * sinl(x)); };
+    const auto d2f = [](long double x) { return expl(-0.1l * x) * (-0.2l * cosl(x) - 0.99l * sinl(x)); };
+
+    const auto id = make_id_op(f);
+    const auto d1 = make_d_op<1>(f, 1e-5l);
+    const auto d2 = make_d_op<2>(f, 1e-4l);
+    const auto r1 = make_richardson_op<1>(f, 1e-3l);
+    const auto r2 = make_richardson_op<2>(f, 1e-2l);
+    for (long double x = -3.0l; x < 3.0l; x += 0.37l) {
+        EXPECT_EQ(id(x), f(x));
+        EXPECT_NEAR(d1(x), df(x), 1e-9l);
+        EXPECT_NEAR(d2(x), d2f(x), 1e-6l);
+        EXPECT_NEAR(r1(x), df(x), 1e-12l);
+        EXPECT_NEAR(r2(x), d2f(x), 1e-8l);
+    }
+
+    // the std::function operators are the same stencils
+    EXPECT_EQ(d_op(f, 1e-5l)(0.5l), d1(0.5l));
+    EXPECT_EQ(d2_op(f, 1e-4l)(0.5l), d2(0.5l));
+}
+
+TEST(calculus_test_suite, test_d_op_nth) {
+    // the N-th central difference is exact on polynomials of degree N
+    const auto p = [](double x) { return x * x * x * x - 2.0 * x * x * x + x - 7.0; };
+    EXPECT_NEAR(make_d_op<3>(p, 0.25)(1.5), 24.0 * 1.5 - 12.0, 1e-9);
+    EXPECT_NEAR(make_d_op<4>(p, 0.25)(-2.0), 24.0, 1e-9);
+    // and works at other precisions
+    const auto q = [](__float128 x) { return x * x * x; };
+    EXPECT_NEAR(static_cast<double>(make_d_op<1>(q, __float128(1e-10q))(__float128(2))), 12.0, 1e-12);
+}
+
+TEST(calculus_test_suite, test_root_finders) {
+    // Wallis' cubic, root 2.0945514815423265...
+    const double root = 2.0945514815423265;
+    int calls = 0;
+    auto f = [&calls](double x) { ++calls; return x * x * x - 2.0 * x - 5.0; };
+    auto fdf = [&calls](double x) { ++calls; return std::pair<double, double>(x * x * x - 2.0 * x - 5.0, 3.0 * x * x - 2.0); };
+
+    const Bracket<double> b = bracket_root(f, 0.0, 0.5);
+    ASSERT_TRUE(b);
+    EXPECT_EQ(b.evaluations, calls);
+    EXPECT_TRUE((b.fa < 0.0) != (b.fb < 0.0));
+
+    calls = 0;
+    const SolverResult<double> brent = brent_root(f, 2.0, 3.0, f(2.0), f(3.0), 1e-12);
+    ASSERT_TRUE(brent);
+    EXPECT_NEAR(brent.x, root, 1e-12);
+    EXPECT_EQ(brent.evaluations + 2, calls);
+    // bisection would need 40
+    EXPECT_LT(brent.evaluations, 12);
+
+    const SolverResult<double> itp = itp_root(f, 3.0, 2.0, f(3.0), f(2.0), 1e-12);
+    ASSERT_TRUE(itp);
+    EXPECT_NEAR(itp.x, root, 1e-12);
+    EXPECT_LE(itp.evaluations, 41);
+
+    const SolverResult<double> newton = newton_root(fdf, 2.0, 3.0, f(2.0), f(3.0), 1e-14);
+    ASSERT_TRUE(newton);
+    EXPECT_NEAR(newton.x, root, 1e-14);
+    EXPECT_LT(newton.evaluations, 10);
+
+    // no sign change, no root
+    EXPECT_FALSE(brent_root(f, 0.0, 1.0, f(0.0), f(1.0), 1e-12));
+    EXPECT_FALSE(itp_root(f, 0.0, 1.0, f(0.0), f(1.0), 1e-12));
+    EXPECT_FALSE(newton_root(fdf, 0.0, 1.0, f(0.0), f(1.0), 1e-12));
+
+    // the iteration cap is honoured
+    const SolverResult<double> capped = brent_root(f, 2.0, 3.0, f(2.0), f(3.0), 1e-15, 3);
+    EXPECT_FALSE(capped);
+    EXPECT_EQ(capped.evaluations, 3);
+}
+
+TEST(calculus_test_suite, test_minimizers) {
+    auto f = [](long double x) { return (x - 2.0l) * (x - 2.0l) * (1.0l + 0.1l * sinl(x)) + 1.0l; };
+
+    const MinBracket<long double> mb = bracket_min(f, -5.0l, -4.0l);
+    ASSERT_TRUE(mb);
+    EXPECT_LT(std::min(mb.a, mb.c), 2.0l);
+    EXPECT_GT(std::max(mb.a, mb.c), 2.0l);
+
+    const SolverResult<long double> golden = golden_section_min(f, 0.0l, 5.0l, 1e-8l);
+    const SolverResult<long double> brent = brent_min(f, 0.0l, 5.0l, 1e-8l);
+    ASSERT_TRUE(golden);
+    ASSERT_TRUE(brent);
+    EXPECT_NEAR(golden.x, 2.0l, 1e-7l);
+    EXPECT_NEAR(brent.x, 2.0l, 1e-7l);
+    EXPECT_NEAR(brent.fx, 1.0l, 1e-14l);
+    EXPECT_LT(brent.evaluations, golden.evaluations);
+
+    // min_x is Brent's, and declines minima at the ends of the range
+    const std::optional<long double> x = min_x(f, 0.0l, 5.0l, 1e-8l);
+    ASSERT_TRUE(x);
+    EXPECT_NEAR(*x, 2.0l, 1e-7l);
+    EXPECT_FALSE(min_x(f, 3.0l, 5.0l, 1e-8l));
+}
+
+TEST(calculus_test_suite, test_minimizers_at_julian_dates) {
+    // to within a second however far from zero the bracket is; skewed by a cubic
+    // so the parabolic steps don't land on the minimum straight away
+    static constexpr long double C = 2451545.3l;
+    static constexpr long double SECOND = 1.0l / 86400.0l;
+    auto f = [](long double x) { return 1.0l + (x - C) * (x - C) * (1.0l + 0.05l * (x - C)); };
+    auto fd = [](double x) {
+        const double u = x - static_cast<double>(C);
+        return 1.0 + u * u * (1.0 + 0.05 * u);
+    };
+
+    const SolverResult<long double> brent = brent_min(f, C - 10.0l, C + 19.0l, 1e-6l);
+    ASSERT_TRUE(brent);
+    EXPECT_NEAR(brent.x, C, SECOND);
+    const SolverResult<double> brentd = brent_min(fd, static_cast<double>(C) - 10.0, static_cast<double>(C) + 19.0, 1e-6);
+    ASSERT_TRUE(brentd);
+    EXPECT_NEAR(brentd.x, static_cast<double>(C), static_cast<double>(SECOND));
+
+    const std::optional<long double> x = min_x(f, C - 10.0l, C + 19.0l, 1e-6l);
+    ASSERT_TRUE(x);
+    EXPECT_NEAR(*x, C, SECOND);
+    const std::optional<double> xd = min_x<double_precision>(fd, static_cast<double>(C) - 10.0, static_cast<double>(C) + 19.0, 1e-6);
+    ASSERT_TRUE(xd);
+    EXPECT_NEAR(*xd, static_cast<double>(C), static_cast<double>(SECOND));
+}
+
+TEST(calculus_test_suite, test_chebyshev_series) {
+    const auto f = [](double x) { return std::exp(x) * std::sin(3.0 * x); };
+    const auto df = [](double x) { return std::exp(x) * (std::sin(3.0 * x) + 3.0 * std::cos(3.0 * x)); };
+    // antiderivative of f
+    const auto F = [](double x) { return std::exp(x) * (std::sin(3.0 * x) - 3.0 * std::cos(3.0 * x)) / 10.0; };
+
+    const ChebyshevSeries<double> s = ChebyshevSeries<double>::fit(f, -1.0, 2.0, 40);
+    const ChebyshevSeries<double> ds = s.derivative();
+    const ChebyshevSeries<double> is = s.integral();
+    EXPECT_EQ(ds.degree(), s.degree() - 1);
+    EXPECT_EQ(is.degree(), s.degree() + 1);
+    EXPECT_NEAR(is(-1.0), 0.0, 1e-15);
+    for (double x = -1.0; x <= 2.0; x += 0.01) {
+        EXPECT_NEAR(s(x), f(x), 1e-13);
+        EXPECT_NEAR(ds(x), df(x), 1e-11);
+        EXPECT_NEAR(is(x), F(x) - F(-1.0), 1e-13);
+    }
+
+    // a polynomial is reproduced exactly, on any subinterval
+    const ChebyshevSeries<double> p = ChebyshevSeries<double>::fit([](double x) { return (x - 0.25) * (x + 0.5) * (x - 3.0); }, -1.0, 1.0, 4);
+    const ChebyshevSeries<double> q = p.restrict(0.0, 0.5);
+    EXPECT_NEAR(q(0.1), p(0.1), 1e-15);
+    const std::vector<double> pr = p.roots(1e-14);
+    ASSERT_EQ(pr.size(), 2);
+    EXPECT_NEAR(pr[0], -0.5, 1e-14);
+    EXPECT_NEAR(pr[1], 0.25, 1e-14);
+}
+
+TEST(calculus_test_suite, test_chebyshev_approximation) {
+    std::size_t calls = 0;
+    const auto runge = [&calls](double x) { ++calls; return 1.0 / (1.0 + 25.0 * x * x) - 0.5; };
+    const ChebyshevApproximation<double> r(runge, -1.0, 1.0, 1e-12, 16);
+    EXPECT_TRUE(r.converged());
+    EXPECT_GT(r.pieces().size(), 1);
+    EXPECT_EQ(r.evaluations(), calls);
+    for (double x = -1.0; x <= 1.0; x += 0.001) {
+        EXPECT_NEAR(r(x), 1.0 / (1.0 + 25.0 * x * x) - 0.5, 1e-12);
+    }
+    const std::vector<double> rr = r.roots(1e-13);
+    ASSERT_EQ(rr.size(), 2);
+    EXPECT_NEAR(rr[0], -0.2, 1e-13);
+    EXPECT_NEAR(rr[1], 0.2, 1e-13);
+    // ∫ 1/(1+25x²) - 1/2 over [-1, 1]
+    EXPECT_NEAR(r.integrate(-1.0, 1.0), 0.4 * std::atan(5.0) - 1.0, 1e-12);
+    // across pieces, against the closed form, and again on the antiderivative
+    const ChebyshevApproximation<double> ir = r.integral();
+    for (double x0 = -0.95, x1 = 0.9; x0 < x1; x0 += 0.173, x1 -= 0.061) {
+        EXPECT_NEAR(r.integrate(x0, x1), 0.2 * (std::atan(5.0 * x1) - std::atan(5.0 * x0)) - 0.5 * (x1 - x0), 1e-12);
+        EXPECT_NEAR(r.integrate(x0, x1), ir(x1) - ir(x0), 1e-14);
+        EXPECT_NEAR(ir.integrate(x0, x1), ir.integral()(x1) - ir.integral()(x0), 1e-14);
+    }
+
+    // every zero of sin over several periods, wherever they fall among the pieces
+    const ChebyshevApproximation<double> s([](double x) { return std::sin(x); }, 0.5, 25.5, 1e-13);
+    const std::vector<double> sr = s.roots(1e-12);
+    ASSERT_EQ(sr.size(), 8);
+    for (std::size_t k = 0; k < sr.size(); ++k) {
+        EXPECT_NEAR(sr[k], (k + 1) * M_PI, 1e-12);
+    }
+    const ChebyshevApproximation<double> ds = s.derivative();
+    EXPECT_NEAR(ds(1.0), std::cos(1.0), 1e-10);
+
+    EXPECT_THROW(ChebyshevApproximation<double>(runge, 1.0, 1.0, 1e-12), std::runtime_error);
+}
+
+}
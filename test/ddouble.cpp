@@ -0,0 +1,139 @@
+/**
+ * ddouble.cpp tests
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#include <gtest/gtest.h>
+#include <random>
+#include "../src/ddouble.hpp"
+#include "../src/lalgebra.hpp"
+#include "../src/jd_clock.hpp"
+
+namespace {
+
+using mmm::ddouble;
+
+// |a - b| relative to |b| (or absolute below 1), in units of 2^-106
+double error(const ddouble &a, __float128 b) {
+    const __float128 scale = fabsq(b) > 1 ? fabsq(b) : 1;
+    return static_cast<double>(fabsq(static_cast<__float128>(a) - b) / scale * 0x1p106q);
+}
+
+// exactly representable in a double-double, so the quad reference is exact too
+ddouble random(std::mt19937_64 &rng, double lo, double hi) {
+    std::uniform_real_distribution<double> u(lo, hi);
+    const double h = u(rng);
+    return ddouble(h) + u(rng) * 0x1p-60;
+}
+
+TEST(ddouble_test_suite, test_arithmetic) {
+    std::mt19937_64 rng(7);
+    for (int i = 0; i < 10000; ++i) {
+        const ddouble a = random(rng, -100.0, 100.0), b = random(rng, 0.01, 100.0);
+        const __float128 qa = static_cast<__float128>(a), qb = static_cast<__float128>(b);
+        EXPECT_LT(error(a + b, qa + qb), 2.0) << i;
+        EXPECT_LT(error(a - b, qa - qb), 2.0) << i;
+        EXPECT_LT(error(a * b, qa * qb), 4.0) << i;
+        EXPECT_LT(error(a / b, qa / qb), 8.0) << i;
+        EXPECT_LT(error(mmm::sqrt(b), sqrtq(qb)), 8.0) << i;
+    }
+    // conversions are exact where they can be
+    EXPECT_EQ(static_cast<long double>(ddouble(0.1l)), 0.1l);
+    EXPECT_EQ(static_cast<double>(ddouble(3) / ddouble(4)), 0.75);
+    EXPECT_TRUE(ddouble(1.0) + 0x1p-80 > 1);
+    EXPECT_TRUE(ddouble(-2.0) < -1.0l);
+    EXPECT_EQ(mmm::floor(ddouble(3.0) - 0x1p-90), ddouble(2.0));
+    EXPECT_EQ(mmm::sqrt(ddouble(0.0)), ddouble(0.0));
+}
+
+TEST(ddouble_test_suite, test_functions) {
+    std::mt19937_64 rng(11);
+    for (int i = 0; i < 5000; ++i) {
+        const ddouble x = random(rng, -50.0, 50.0);
+        const __float128 qx = static_cast<__float128>(x);
+        EXPECT_LT(error(mmm::sin(x), sinq(qx)), 16.0) << i;
+        EXPECT_LT(error(mmm::cos(x), cosq(qx)), 16.0) << i;
+        const ddouble y = random(rng, -2.0, 2.0);
+        const __float128 qy = static_cast<__float128>(y);
+        EXPECT_LT(error(mmm::atan2(y, x), atan2q(qy, qx)), 16.0) << i;
+        EXPECT_LT(error(mmm::atan2(x, y), atan2q(qx, qy)), 16.0) << i;
+        const ddouble s = y / 2.0;
+        EXPECT_LT(error(mmm::asin(s), asinq(static_cast<__float128>(s))), 16.0) << i;
+        EXPECT_LT(error(mmm::acos(s), acosq(static_cast<__float128>(s))), 16.0) << i;
+    }
+    EXPECT_LT(error(mmm::atan2(ddouble(0.0), ddouble(-1.0)), M_PIq), 1.0);
+    EXPECT_LT(error(mmm::atan2(ddouble(-1.0), ddouble(0.0)), -M_PI_2q), 1.0);
+    EXPECT_LT(error(mmm::sin(ddouble(M_PIq)), 0), 1.0);
+    // infinite arguments follow std::atan2 rather than turning into NaN
+    const double inf = std::numeric_limits<double>::infinity();
+    EXPECT_EQ(static_cast<double>(mmm::atan2(ddouble(inf), ddouble(1.0))), M_PI_2);
+    EXPECT_EQ(static_cast<double>(mmm::atan2(ddouble(-inf), ddouble(-3.0))), -M_PI_2);
+    EXPECT_EQ(static_cast<double>(mmm::atan2(ddouble(2.0), ddouble(inf))), 0.0);
+    EXPECT_EQ(static_cast<double>(mmm::atan2(ddouble(2.0), ddouble(-inf))), M_PI);
+    EXPECT_EQ(static_cast<double>(mmm::atan2(ddouble(inf), ddouble(inf))), M_PI_4);
+    EXPECT_EQ(static_cast<double>(mmm::atan2(ddouble(-inf), ddouble(-inf))), -3.0 * M_PI_4);
+    EXPECT_EQ(static_cast<double>(mmm::atan(ddouble(-inf))), -M_PI_2);
+    EXPECT_TRUE(std::isnan(static_cast<double>(mmm::atan2(ddouble(std::nan("")), ddouble(1.0)))));
+}
+
+TEST(ddouble_test_suite, test_vectors) {
+    typedef basic_cartesian3dvec<ddouble> vec_t;
+    const vec_t a {{ddouble(1.0), ddouble(2.0), ddouble(3.0)}};
+    const vec_t b {{ddouble(-2.0), ddouble(0.5), ddouble(1.0) / 3.0}};
+    const __float128 qa[] = {1, 2, 3}, qb[] = {-2, 0.5q, 1 / 3.0q};
+    EXPECT_LT(error(a.dotP(b), qa[0] * qb[0] + qa[1] * qb[1] + qa[2] * qb[2]), 4.0);
+    const vec3<ddouble> c = a.crossP(b);
+    EXPECT_LT(error(c.raw[0], qa[1] * qb[2] - qa[2] * qb[1]), 4.0);
+    EXPECT_LT(error(a.mag(), sqrtq(14.0q)), 4.0);
+    // rotate there and back
+    const mat3x3<ddouble> r = mat3x3<ddouble>::R_seq<3, 1>(ddouble(0.3), ddouble(1.1));
+    const vec3<ddouble> back = r.transposeMul(r.mul(a));
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_LT(error(back.raw[i], qa[i]), 32.0);
+    }
+    EXPECT_LT(error(basic_spacexfrm3d<ddouble>::cart2sph(a).ø(), atan2q(2, 1)), 16.0);
+}
+
+TEST(ddouble_test_suite, test_jd_clock) {
+    // a day in ten millisecond steps from J2000
+    const dd_jd_clock::duration step(ddouble(1.0) / 8640000.0);
+    dd_jd_clock::time_point t {dd_jd_clock::duration(ddouble(jd_clock::JD2000_EPOCH_JD))};
+    jd_clock::time_point l {jd_clock::duration(jd_clock::JD2000_EPOCH_JD)};
+    for (int i = 0; i < 8640000; ++i) {
+        t += step;
+        l += jd_clock::duration(1.0l / 8640000.0l);
+    }
+    const long double end = jd_clock::JD2000_EPOCH_JD + 1.0l;
+    // long double rounds every step to 2^-42 days and ends up tens of
+    // milliseconds out; the double-double sum is good to a picosecond
+    EXPECT_GT(fabsl(l.time_since_epoch().count() - end), 1e-7l);
+    EXPECT_LT(static_cast<double>(mmm::fabs(t.time_since_epoch().count() - ddouble(end))), 1e-18);
+
+    // the same unix times as jd_clock
+    for (std::time_t u = 0; u < 4000000000; u += 123456789) {
+        dd_jd_clock::time_point dd = dd_jd_clock::from_time_t(u);
+        jd_clock::time_point ld = jd_clock::from_time_t(u);
+        EXPECT_NEAR(static_cast<long double>(dd.time_since_epoch().count()), ld.time_since_epoch().count(), 1e-9l);
+        EXPECT_EQ(dd_jd_clock::to_time_t(dd), u);
+    }
+    std::ostringstream os;
+    os << dd_jd_clock::from_tdb(tdb_jd_clock::time_point(tdb_jd_clock::duration(2451545.25l)));
+    EXPECT_EQ(os.str(), "2451545.250000");
+}
+
+}
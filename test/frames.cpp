@@ -0,0 +1,93 @@
+/**
+ * frames.cpp tests
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#include <gtest/gtest.h>
+#include "../src/frames.hpp"
+
+namespace {
+
+using github::paulyc::FrameRotation;
+
+static constexpr long double JD2000 = jd_clock::JD2000_EPOCH_JD;
+
+long double maxAbsDiff(const mat3x3q_t &a, const mat3x3q_t &b) {
+    long double diff = 0.0l;
+    for (std::size_t i = 0; i < 3; ++i) {
+        for (std::size_t j = 0; j < 3; ++j) {
+            diff = std::max(diff, fabsl(a.elems[i][j] - b.elems[i][j]));
+        }
+    }
+    return diff;
+}
+
+mat3x3q_t identity() {
+    const long double m[3][3] = {{1.0l, 0.0l, 0.0l}, {0.0l, 1.0l, 0.0l}, {0.0l, 0.0l, 1.0l}};
+    return mat3x3q_t(m);
+}
+
+TEST(FramesTestSuite, TestOrthonormal) {
+    FrameRotation frames;
+    const mat3x3q_t &m = frames.npb(JD2000 + 7777.7l);
+    EXPECT_LT(maxAbsDiff(m.mul(m.transpose()), identity()), 1e-15l);
+}
+
+TEST(FramesTestSuite, TestJ2000IsFrameBias) {
+    FrameRotation frames([](double) -> std::pair<long double, long double> { return {0.0l, 0.0l}; }, 1.0l);
+    // only the ~23 mas frame bias is left at the epoch
+    EXPECT_LT(maxAbsDiff(frames.npb(JD2000), identity()), 1e-7l);
+    const vec3q_t pole = frames.ecliptic(JD2000).mul(vec3q_t {{0.0l, 0.0l, 1.0l}});
+    EXPECT_NEAR(static_cast<double>(pole.raw[1]), static_cast<double>(sinl(OBLIQUITY_J2000)), 1e-7);
+    EXPECT_NEAR(static_cast<double>(pole.raw[2]), static_cast<double>(cosl(OBLIQUITY_J2000)), 1e-7);
+}
+
+TEST(FramesTestSuite, TestPrecessionRate) {
+    FrameRotation frames([](double) -> std::pair<long double, long double> { return {0.0l, 0.0l}; }, 1.0l);
+    // the equinox of date runs ahead ~50.3"/year, so the J2000 equinox falls behind in longitude
+    const vec3q_t x = frames.ecliptic(JD2000 + 36525.0l).mul(vec3q_t {{1.0l, 0.0l, 0.0l}});
+    const long double λ = atan2l(x.raw[1], x.raw[0]) * 648000.0l / MMM_PI;
+    EXPECT_NEAR(static_cast<double>(λ), 5029.9, 0.5);
+}
+
+TEST(FramesTestSuite, TestInterpolationError) {
+    FrameRotation frames;
+    long double worst = 0.0l;
+    for (long double jd = JD2000 + 1000.0l; jd < JD2000 + 1060.0l; jd += 0.0137l) {
+        worst = std::max(worst, maxAbsDiff(frames.npbInterpolated(jd), frames.npb(jd)));
+        worst = std::max(worst, maxAbsDiff(frames.eclipticInterpolated(jd), frames.ecliptic(jd)));
+    }
+    EXPECT_LT(worst, 2e-9l);
+}
+
+TEST(FramesTestSuite, TestEclipticRoundTrip) {
+    FrameRotation frames;
+    const jd_clock::time_point jds[2] = {jd_clock::time_point(jd_clock::duration(JD2000 + 3.3l)), jd_clock::time_point(jd_clock::duration(JD2000 + 4.4l))};
+    const cartesian3dvec in[2] = {{{0.3l, -0.4l, 0.5l}}, {{1.0l, 2.0l, 3.0l}}};
+    cartesian3dvec ecl[2] = {{{0.0l, 0.0l, 0.0l}}, {{0.0l, 0.0l, 0.0l}}};
+    cartesian3dvec back[2] = {{{0.0l, 0.0l, 0.0l}}, {{0.0l, 0.0l, 0.0l}}};
+    frames.toEclipticOfDate(jds, in, ecl);
+    frames.fromEclipticOfDate(jds, ecl, back);
+    for (std::size_t i = 0; i < 2; ++i) {
+        for (std::size_t k = 0; k < 3; ++k) {
+            EXPECT_NEAR(static_cast<double>(back[i].raw[k]), static_cast<double>(in[i].raw[k]), 1e-12);
+        }
+    }
+}
+
+}
@@ -0,0 +1,144 @@
+/**
+ * ingress.cpp tests
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#include <gtest/gtest.h>
+#include "../src/ingress.hpp"
+#include "synthetic_sky.hpp"
+
+namespace {
+
+using namespace github::paulyc;
+
+// the Sun on a fixed Kepler ellipse, to second order in e
+struct KeplerSun {
+    static constexpr long double N = MMM_2_PI / 365.242190l;
+    static constexpr long double E = 0.0167086l;
+    static constexpr long double L0 = 280.46646l * MMM_PI / 180.0l;
+    static constexpr long double M0 = 357.52911l * MMM_PI / 180.0l;
+    int samples = 0;
+
+    LongitudeSample operator()(long double jd) {
+        ++samples;
+        const long double t = jd - jd_clock::JD2000_EPOCH_JD;
+        const long double M = M0 + N * t;
+        long double λ = fmodl(L0 + N * t + 2.0l * E * sinl(M) + 1.25l * E * E * sinl(2.0l * M), MMM_2_PI);
+        if (λ < 0.0l) {
+            λ += MMM_2_PI;
+        }
+        return LongitudeSample {λ, N * (1.0l + 2.0l * E * cosl(M) + 2.5l * E * E * cosl(2.0l * M))};
+    }
+};
+
+static constexpr long double SIGN = MMM_PI / 6.0l;
+static constexpr long double FROM = 2451545.0l;
+static constexpr long double TO = FROM + 10 * 365.25l;
+
+TEST(ingress_test_suite, test_solve_ingresses) {
+    KeplerSun sun;
+    std::vector<PlanetEvent> events;
+    solveIngresses(sun, JPLEphems::Sun, FROM, TO, SolarIngresses::TOLERANCE_JD, events);
+
+    // one per boundary the longitude passes, found by stepping through a day at a time
+    int crossings = 0;
+    KeplerSun daily;
+    for (long double jd = FROM; jd < TO; jd += 1.0l) {
+        const long double a = daily(jd).λ, b = daily(std::min(jd + 1.0l, TO)).λ;
+        crossings += static_cast<int>(floorl(b / SIGN)) != static_cast<int>(floorl(a / SIGN));
+    }
+    ASSERT_EQ(events.size(), static_cast<std::size_t>(crossings));
+    ASSERT_EQ(events.size(), 120u);
+
+    const int samples = sun.samples;
+    for (std::size_t i = 0; i < events.size(); ++i) {
+        const long double jd = events[i].jd.time_since_epoch().count();
+        ASSERT_EQ(events[i].kind, PlanetEvent::Ingress);
+        ASSERT_GE(jd, FROM);
+        ASSERT_LT(jd, TO);
+        if (i > 0) {
+            ASSERT_EQ(events[i].sign, (events[i - 1].sign + 1) % 12);
+            ASSERT_NEAR(jd - events[i - 1].jd.time_since_epoch().count(), 365.25l / 12.0l, 1.5l);
+        }
+        const long double λ = sun(jd).λ;
+        ASSERT_NEAR(remainderl(λ - events[i].sign * SIGN, MMM_2_PI), 0.0l, 1e-9l);
+    }
+    // a handful of samples a sign, not a scan through it
+    ASSERT_LT(samples, 8 * static_cast<int>(events.size()));
+}
+
+TEST(ingress_test_suite, test_solve_ingresses_split) {
+    KeplerSun sun;
+    std::vector<PlanetEvent> whole, split;
+    solveIngresses(sun, JPLEphems::Sun, FROM, TO, SolarIngresses::TOLERANCE_JD, whole);
+    for (int y = 0; y < 10; ++y) {
+        solveIngresses(sun, JPLEphems::Sun, FROM + y * 365.25l, FROM + (y + 1) * 365.25l, SolarIngresses::TOLERANCE_JD, split);
+    }
+    ASSERT_EQ(whole.size(), split.size());
+    for (std::size_t i = 0; i < whole.size(); ++i) {
+        ASSERT_EQ(whole[i].sign, split[i].sign);
+        ASSERT_NEAR(whole[i].jd.time_since_epoch().count(), split[i].jd.time_since_epoch().count(), 1e-7l);
+    }
+}
+
+TEST(ingress_test_suite, test_solar_ingresses) {
+    JPLEphems ephems;
+    synthetic::Sky::open(ephems);
+    SolarIngresses sun(ephems);
+    ApparentPlace apparent(ephems);
+    EXPECT_EQ(SolarIngresses::newYear(2000).time_since_epoch().count(), 2451544.5l);
+    EXPECT_EQ(SolarIngresses::newYear(2001).time_since_epoch().count(), 2451544.5l + 366.0l);
+
+    for (int y : {1999, 2000, 2024}) {
+        const std::vector<PlanetEvent> events = sun.year(y);
+        const long double lo = SolarIngresses::newYear(y).time_since_epoch().count();
+        const long double hi = SolarIngresses::newYear(y + 1).time_since_epoch().count();
+        // twelve a year, Aquarius in January first
+        ASSERT_EQ(events.size(), 12u) << y;
+        for (std::size_t i = 0; i < events.size(); ++i) {
+            const long double jd = events[i].jd.time_since_epoch().count();
+            ASSERT_EQ(events[i].body, JPLEphems::Sun);
+            ASSERT_EQ(events[i].kind, PlanetEvent::Ingress);
+            ASSERT_EQ(events[i].sign, static_cast<int>((10 + i) % 12)) << y << ' ' << i;
+            ASSERT_GE(jd, lo);
+            ASSERT_LT(jd, hi);
+            // on the boundary by apparent longitude of date, aberration and nutation included
+            const long double λ = apparent.eclipticLonLat(JPLEphems::Sun, events[i].jd).first;
+            ASSERT_NEAR(remainderl(λ - events[i].sign * SIGN, MMM_2_PI), 0.0l, 1e-9l) << y << ' ' << i;
+            // and the rate Newton steps with is the apparent longitude's, short only of the
+            // nutation rate (~1e-7 rad/day) and well inside the precession's 7e-7
+            static constexpr long double H = 0.01l;
+            const long double ahead = apparent.eclipticLonLat(JPLEphems::Sun, jd_clock::time_point(jd_clock::duration(jd + H))).first;
+            const long double behind = apparent.eclipticLonLat(JPLEphems::Sun, jd_clock::time_point(jd_clock::duration(jd - H))).first;
+            ASSERT_NEAR(sun.longitude(jd).dλ, remainderl(ahead - behind, MMM_2_PI) / (2.0l * H), 2e-7l);
+        }
+    }
+
+    // consecutive years join up into one search over both
+    std::vector<PlanetEvent> both = sun.year(2000);
+    const std::vector<PlanetEvent> next = sun.year(2001);
+    both.insert(both.end(), next.begin(), next.end());
+    const std::vector<PlanetEvent> found = sun.find(SolarIngresses::newYear(2000), SolarIngresses::newYear(2002));
+    ASSERT_EQ(found.size(), both.size());
+    for (std::size_t i = 0; i < found.size(); ++i) {
+        ASSERT_EQ(found[i].sign, both[i].sign);
+        ASSERT_NEAR(found[i].jd.time_since_epoch().count(), both[i].jd.time_since_epoch().count(), 1e-7l);
+    }
+}
+
+}
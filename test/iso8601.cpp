@@ -0,0 +1,123 @@
+/**
+ * iso8601.cpp tests
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#include <gtest/gtest.h>
+#include "../src/iso8601.hpp"
+
+#include <ctime>
+#include <string>
+
+namespace {
+
+using namespace github::paulyc;
+using namespace std::chrono;
+
+std::string formatted(sys_time<milliseconds> tp) {
+    char buf[iso8601::MAX_LENGTH];
+    return std::string(buf, iso8601::format(tp, buf));
+}
+
+sys_time<milliseconds> at(std::int64_t ms) {
+    return sys_time<milliseconds>(milliseconds(ms));
+}
+
+TEST(iso8601_test_suite, test_civil_days) {
+    EXPECT_EQ(iso8601::days_from_civil(1970, 1, 1), 0);
+    EXPECT_EQ(iso8601::days_from_civil(2000, 3, 1), 11017);
+    EXPECT_EQ(iso8601::days_from_civil(1969, 12, 31), -1);
+    // both ways over a few thousand years, through every kind of leap year
+    for (std::int64_t z = -800000; z < 800000; z += 13) {
+        const iso8601::civil_date c = iso8601::civil_from_days(z);
+        ASSERT_EQ(iso8601::days_from_civil(c.year, c.month, c.day), z);
+        ASSERT_LE(c.day, iso8601::days_in_month(c.year, c.month));
+    }
+    EXPECT_EQ(iso8601::days_in_month(1900, 2), 28u);
+    EXPECT_EQ(iso8601::days_in_month(2000, 2), 29u);
+}
+
+TEST(iso8601_test_suite, test_format) {
+    EXPECT_EQ(formatted(at(0)), "1970-01-01T00:00:00.000Z");
+    EXPECT_EQ(formatted(at(-1)), "1969-12-31T23:59:59.999Z");
+    EXPECT_EQ(formatted(at(951782400123)), "2000-02-29T00:00:00.123Z");
+    EXPECT_EQ(formatted(at(253402300799999)), "9999-12-31T23:59:59.999Z");
+    EXPECT_EQ(formatted(at(253402300800000)), "+010000-01-01T00:00:00.000Z");
+    EXPECT_EQ(formatted(at(-62167219200001)), "-000001-12-31T23:59:59.999Z");
+    EXPECT_EQ(formatted(at(0)).size(), iso8601::LENGTH);
+
+    // down to the millisecond, as gmtime() has it to the second
+    for (std::int64_t t = -2000000000ll; t < 4000000000ll; t += 7654321ll) {
+        const std::time_t tt = t;
+        std::tm tm;
+        gmtime_r(&tt, &tm);
+        char expect[64];
+        std::strftime(expect, sizeof(expect), "%Y-%m-%dT%H:%M:%S", &tm);
+        const system_clock::time_point tp = system_clock::from_time_t(tt) + microseconds(456789);
+        char buf[iso8601::MAX_LENGTH];
+        EXPECT_EQ(std::string(buf, iso8601::format(tp, buf)), std::string(expect) + ".456Z");
+    }
+}
+
+TEST(iso8601_test_suite, test_parse) {
+    sys_time<milliseconds> tp;
+    for (std::int64_t ms = -62167219200001ll; ms < 300000000000000ll; ms += 98765432109ll) {
+        ASSERT_TRUE(iso8601::parse(formatted(at(ms)), tp)) << formatted(at(ms));
+        EXPECT_EQ(tp, at(ms));
+    }
+
+    // other spellings of the same instant
+    const sys_time<milliseconds> expect = at(951782400123);
+    for (const char *s : {"2000-02-29T00:00:00.123Z", "2000-02-29 00:00:00.1239z", "2000-02-29T01:30:00.123+01:30",
+                          "2000-02-28T23:00:00.123-0100", "2000-02-29T02:00:00.123+02", "+002000-02-29T00:00:00,123Z"}) {
+        ASSERT_TRUE(iso8601::parse(s, tp)) << s;
+        EXPECT_EQ(tp, expect) << s;
+    }
+    system_clock::time_point fine;
+    ASSERT_TRUE(iso8601::parse("2020-06-01T12:00:00.123456789Z", fine));
+    EXPECT_EQ(fine.time_since_epoch() % seconds(1), duration_cast<system_clock::duration>(nanoseconds(123456789)));
+    // a leap second reads as the next minute
+    ASSERT_TRUE(iso8601::parse("2016-12-31T23:59:60Z", tp));
+    EXPECT_EQ(formatted(tp), "2017-01-01T00:00:00.000Z");
+
+    tp = at(42);
+    for (const char *s : {"", "2000-02-30T00:00:00Z", "1900-02-29T00:00:00Z", "2000-13-01T00:00:00Z",
+                          "2000-01-01T24:00:00Z", "2000-01-01T00:60:00Z", "2000-01-01T00:00:61Z", "2000-01-01T00:00:00.Z",
+                          "2000-01-01T00:00:00Zjunk", "2000-01-01X00:00:00Z", "2000-1-01T00:00:00Z", "+123-01-01T00:00:00Z",
+                          "2000-01-01T00:00:00+5", "2000-01-01T00:00:00+25:00"}) {
+        EXPECT_FALSE(iso8601::parse(s, tp)) << s;
+    }
+    EXPECT_EQ(tp, at(42));
+
+    // expanded years past what the time point holds are refused, not wrapped
+    for (const char *s : {"+99999999999-01-01T00:00:00Z", "-99999999999-12-31T23:59:59Z", "+999999999999-12-31T23:59:59Z",
+                          "+292278994-08-17T07:12:55.807Z", "-292275055-05-16T16:47:04.191Z"}) {
+        EXPECT_FALSE(iso8601::parse(s, tp)) << s;
+    }
+    EXPECT_EQ(tp, at(42));
+    ASSERT_TRUE(iso8601::parse("+200000000-01-01T00:00:00Z", tp));
+    EXPECT_EQ(formatted(tp), "+200000000-01-01T00:00:00.000Z");
+    // nanoseconds only reach 1677-2262
+    sys_time<nanoseconds> ns;
+    EXPECT_FALSE(iso8601::parse("1500-01-01T00:00:00Z", ns));
+    EXPECT_FALSE(iso8601::parse("2300-01-01T00:00:00Z", ns));
+    ASSERT_TRUE(iso8601::parse("2262-01-01T00:00:00Z", ns));
+    EXPECT_EQ(formatted(time_point_cast<milliseconds>(ns)), "2262-01-01T00:00:00.000Z");
+}
+
+}
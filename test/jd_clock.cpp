@@ -20,6 +20,10 @@
 
 #include <gtest/gtest.h>
 #include "../src/jd_clock.hpp"
+#include "../src/split_jd_clock.hpp"
+
+#include <algorithm>
+#include <cmath>
 
 namespace {
 
@@ -29,4 +33,134 @@ TEST(jd_clock_test_suite, test_delta_t_lerp) {
     EXPECT_TRUE(jd_clock::delta_t_lerp(2030) > 68.97);
 }
 
+TEST(jd_clock_test_suite, test_delta_t_table) {
+    // whole years are the polynomials exactly, and published anchor values
+    EXPECT_DOUBLE_EQ(delta_t::seconds(1900), -2.79);
+    EXPECT_DOUBLE_EQ(delta_t::seconds(1950), 29.07);
+    EXPECT_NEAR(delta_t::seconds(2000), 63.86, 1e-9);
+    // in between, the spline follows the polynomials away from their joins
+    const double joins[] = {500, 1600, 1700, 1800, 1860, 1900, 1920, 1941, 1961, 1986, 2005, 2050};
+    for (double y = -450.5; y < 2100; y += 7.0) {
+        if (std::any_of(std::begin(joins), std::end(joins), [y](double j) { return fabs(y - j) < 2.0; })) {
+            continue;
+        }
+        EXPECT_NEAR(delta_t::seconds(y), delta_t::polynomial(y), 0.02) << "year " << y;
+    }
+    // outside the table it's the long-term parabola
+    EXPECT_DOUBLE_EQ(delta_t::seconds(-1000.25), delta_t::long_term(-1000.25));
+    EXPECT_DOUBLE_EQ(delta_t::seconds(3000), delta_t::long_term(3000));
+    EXPECT_NEAR(delta_t::seconds(2150), delta_t::long_term(2150), 1e-9);
+}
+
+TEST(jd_clock_test_suite, test_delta_t_batch) {
+    std::vector<double> jds, out(64);
+    for (int i = 0; i < 64; ++i) {
+        jds.push_back(jd_clock::JD2000_EPOCH_JD + (i - 32) * 12345.678);
+    }
+    delta_t::seconds_at_jd(jds, out);
+    for (int i = 0; i < 64; ++i) {
+        EXPECT_EQ(out[i], delta_t::seconds_at_jd(jds[i]));
+    }
+    EXPECT_THROW(delta_t::seconds_at_jd(jds, std::span<double>(out.data(), 10)), std::runtime_error);
+}
+
+TEST(jd_clock_test_suite, test_timescales) {
+    // J2000.0 is 2000-01-01T12:00:00 TT = 11:58:55.816 UTC
+    const long double utc2000 = jd_clock::JD2000_EPOCH_JD - 64.184l / 86400.0l;
+    EXPECT_EQ(timescales::tai_minus_utc(2451544.5), 32.0);
+    EXPECT_EQ(timescales::tai_minus_utc(2457754.5), 37.0);
+    EXPECT_EQ(timescales::tai_minus_utc(2457754.4), 36.0);
+    EXPECT_NEAR(timescales::convert(utc2000, timescales::UTC, timescales::TT), jd_clock::JD2000_EPOCH_JD, 1e-10);
+    EXPECT_NEAR(timescales::convert(jd_clock::JD2000_EPOCH_JD, timescales::TT, timescales::UTC), utc2000, 1e-10);
+    EXPECT_NEAR(timescales::convert(jd_clock::JD2000_EPOCH_JD, timescales::TT, timescales::TAI), jd_clock::JD2000_EPOCH_JD - 32.184l / 86400.0l, 1e-10);
+
+    // TDB - TT stays under 2ms and moves with the Earth's orbit
+    for (double jd = 2440000.5; jd < 2470000.5; jd += 17.3) {
+        EXPECT_LT(fabs(timescales::tdb_minus_tt(jd)), 0.0018);
+    }
+
+    // before 1972 TT - UTC is ΔT
+    EXPECT_DOUBLE_EQ(timescales::tt_minus_utc(2415020.5), delta_t::seconds_at_jd(2415020.5));
+
+    // round trips and the typed clocks agree with the untyped conversion
+    for (long double jd = 2400000.5l; jd < 2470000.5l; jd += 1234.567l) {
+        const utc_jd_clock::time_point utc(utc_jd_clock::duration{jd});
+        const tdb_jd_clock::time_point tdb = scale_cast<tdb_jd_clock>(utc);
+        EXPECT_EQ(tdb.time_since_epoch().count(), timescales::convert(jd, timescales::UTC, timescales::TDB));
+        EXPECT_NEAR(scale_cast<utc_jd_clock>(tdb).time_since_epoch().count(), jd, 1e-10);
+    }
+
+    std::vector<long double> in = {2451544.5l, 2455000.25l, 2460000.75l}, out(3);
+    timescales::convert(in, out, timescales::UTC, timescales::TT);
+    for (std::size_t i = 0; i < in.size(); ++i) {
+        EXPECT_EQ(out[i], timescales::convert(in[i], timescales::UTC, timescales::TT));
+    }
+}
+
+TEST(jd_clock_test_suite, test_unix_time) {
+    // unix time is UTC; time points are TDB
+    const std::time_t t2000 = 946727936;
+    const jd_clock::time_point jd = jd_clock::from_time_t(t2000);
+    EXPECT_NEAR(jd.time_since_epoch().count(), jd_clock::JD2000_EPOCH_JD + 0.184l / 86400.0l, 0.002l / 86400.0l);
+    jd_clock::time_point copy = jd;
+    EXPECT_EQ(jd_clock::to_time_t(copy), t2000);
+    EXPECT_EQ(jd_clock::from_tdb(jd_clock::to_tdb(jd)), jd);
+}
+
+
+TEST(jd_clock_test_suite, test_split_jd_clock) {
+    typedef split_jd_clock::time_point split_t;
+    using std::chrono::system_clock;
+    using std::chrono::nanoseconds;
+
+    // normalized whatever the nanoseconds, and ordered by day then nanosecond
+    EXPECT_EQ(split_t(10, -1), split_t(9, split_jd_clock::NS_PER_DAY - 1));
+    EXPECT_EQ(split_t(10, 3 * split_jd_clock::NS_PER_DAY + 5), split_t(13, 5));
+    EXPECT_LT(split_t(9, split_jd_clock::NS_PER_DAY - 1), split_t(10, 0));
+    EXPECT_EQ(split_t(12, 7) - split_t(10, 9), nanoseconds(2 * split_jd_clock::NS_PER_DAY - 2));
+
+    // unix and system_clock time round trip exactly, sub-second part and all,
+    // before 1970 and across leap seconds too
+    for (std::int64_t t = -1000000000ll; t < 4000000000ll; t += 12345679ll) {
+        EXPECT_EQ(split_jd_clock::to_time_t(split_jd_clock::from_time_t(t)), t);
+        const system_clock::time_point tp = system_clock::from_time_t(t) +
+            std::chrono::duration_cast<system_clock::duration>(nanoseconds((t * 7919) % 1000000000ll + 1000000000ll) / 2);
+        EXPECT_EQ(split_jd_clock::to_system_clock(split_jd_clock::from_system_clock(tp)), tp);
+        // and agree with the long double clock
+        EXPECT_NEAR(split_jd_clock::to_jd(split_jd_clock::from_time_t(t)).time_since_epoch().count(),
+                    jd_clock::from_time_t(t).time_since_epoch().count(), 1e-11);
+    }
+    // J2000.0 TT is 11:58:55.816 UTC, and TDB - TT is well under a millisecond there
+    const split_t j2000 = split_jd_clock::from_system_clock(system_clock::from_time_t(946727935) + std::chrono::milliseconds(816));
+    EXPECT_LT(std::chrono::abs(j2000 - split_t(2451545, 0)), std::chrono::microseconds(100));
+
+    // a month of one minute steps lands exactly a month on, where a long double
+    // julian date has wandered off by tens of microseconds
+    split_t split = split_jd_clock::from_jd(jd_clock::time_point(jd_clock::duration(2459000.5l)));
+    jd_clock::time_point jd = split_jd_clock::to_jd(split);
+    const split_t start = split;
+    for (int i = 0; i < 41760; ++i) {
+        split += std::chrono::minutes(1);
+        jd += jd_clock::duration(60.0l / 86400.0l);
+    }
+    EXPECT_EQ(split, split_t(start.day + 29, start.ns));
+    EXPECT_GT(fabsl(jd.time_since_epoch().count() - (2459000.5l + 29.0l)) * 86400.0l, 1e-6l);
+
+    // the epoch for the ephemeris reader keeps the fraction apart from the day
+    const std::array<double, 2> e = split_t(2459000, 1).epoch();
+    EXPECT_EQ(e[0], 2459000.0);
+    EXPECT_EQ(e[1], 1.0 / split_jd_clock::NS_PER_DAY);
+    // a long double date is only good to ~20ns
+    EXPECT_LE(std::chrono::abs(split_jd_clock::from_jd(split_jd_clock::to_jd(split_t(2459000, 123456789))) - split_t(2459000, 123456789)), nanoseconds(32));
+    EXPECT_EQ(split_jd_clock::to_dd(split_t(2459000, 0)).time_since_epoch().count(), mmm::ddouble(2459000.0));
+}
+
+TEST(jd_clock_test_suite, test_system_clock_sub_second) {
+    // the long double clock keeps sub-second parts too, to a microsecond
+    using std::chrono::system_clock;
+    const system_clock::time_point tp = system_clock::from_time_t(1600000000) + std::chrono::microseconds(250123);
+    const system_clock::time_point back = jd_clock::to_system_clock(jd_clock::from_system_clock(tp));
+    EXPECT_LE(std::chrono::abs(back - tp), std::chrono::microseconds(1));
+}
+
 }
@@ -20,6 +20,7 @@
 
 #include <gtest/gtest.h>
 #include "../src/lalgebra.hpp"
+#include "../src/astro.hpp"
 
 namespace {
 
@@ -108,7 +109,6 @@ TEST_F(NxMmatrixTestFixture, TestTrue) {
     EXPECT_TRUE(true);
 }
 
-#if 0
 TEST_F(NxMmatrixTestFixture, TestVecMul) {
     NxMmatrix<3,3> m({
         {1.0q, 2.0q, 3.0q},
@@ -130,7 +130,172 @@ TEST_F(NxMmatrixTestFixture, TestVecMul) {
     EXPECT_TRUE(fuzzy_eq(dotP2, 7.0q+16.0q+27.0q));
     Nvec<3> z = {{dotP0, dotP1, dotP2}};
     EXPECT_TRUE(fuzzy_eq(v, z));
+    const NxMmatrix<3,3> mn = m.mul(n);
+    EXPECT_TRUE(fuzzy_eq(mn.row(1), Nvec<3>({4.0q*10.0q + 5.0q*40.0q + 6.0q*70.0q, 4.0q*20.0q + 5.0q*50.0q + 6.0q*80.0q, 4.0q*30.0q + 5.0q*60.0q + 6.0q*90.0q})));
+    EXPECT_TRUE(fuzzy_eq(m.mul(NxMmatrix<3,3>::identity()).col(2), m.col(2)));
+}
+
+TEST_F(NxMmatrixTestFixture, TestNonSquare) {
+    // 2 rows x 3 cols times 3 rows x 1 col
+    const NxMmatrix<3,2> a({
+        {1.0l, 2.0l, 3.0l},
+        {4.0l, 5.0l, 6.0l},
+    });
+    const NxMmatrix<1,3> b({{1.0l}, {0.0l}, {-1.0l}});
+    const NxMmatrix<1,2> ab = a.mul(b);
+    EXPECT_EQ(ab.rows[0][0], -2.0l);
+    EXPECT_EQ(ab.rows[1][0], -2.0l);
+    const Nvec<2> v = a.mul(Nvec<3>({1.0l, 1.0l, 1.0l}));
+    EXPECT_EQ(v[0], 6.0l);
+    EXPECT_EQ(v[1], 15.0l);
+    const NxMmatrix<2,3> at = a.transpose();
+    EXPECT_EQ(at.rows[2][1], 6.0l);
+    EXPECT_EQ(at.col(1)[0], 4.0l);
+}
+
+TEST_F(NvecTestFixture, TestCrossPNegate) {
+    const Nvec<3> c = u.crossP(v);
+    EXPECT_TRUE(fuzzy_eq(c, Nvec<3>({-3.0l, 6.0l, -3.0l})));
+    EXPECT_TRUE(fuzzy_eq(c.dotP(u), 0.0l));
+    EXPECT_TRUE(fuzzy_eq(u.negate(), Nvec<3>({-1.0l, -2.0l, -3.0l})));
+    EXPECT_TRUE(fuzzy_eq(v.crossP(u), c.negate()));
+}
+
+// all of it can be done by the compiler
+constexpr mat3x3<double> MAT_A({{1.0, 2.0, 0.0}, {0.0, 1.0, 3.0}, {4.0, 0.0, 1.0}});
+static_assert(MAT_A.mul(mat3x3<double>::identity()).elems[2][0] == 4.0);
+static_assert(MAT_A.mul(MAT_A).elems[0][2] == 6.0);
+static_assert(MAT_A.transpose().elems[0][2] == 4.0);
+static_assert(MAT_A.mul(vec3<double> {1.0, 1.0, 1.0}).raw[1] == 4.0);
+static_assert(Nvec<3, double>({1.0, 0.0, 0.0}).crossP(Nvec<3, double>({0.0, 1.0, 0.0}))[2] == 1.0);
+
+bool near(const mat3x3q_t &a, const mat3x3q_t &b, long double tol) {
+    for (std::size_t i = 0; i < 3; ++i) {
+        for (std::size_t j = 0; j < 3; ++j) {
+            if (fabsl(a.elems[i][j] - b.elems[i][j]) > tol) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+TEST(Mat3x3TestSuite, TestComposedRotations) {
+    const long double a = 0.409l, b = -1.3l, c = 0.0002l, d = 2.5l;
+    const mat3x3q_t chain = mat3x3q_t::R_1(a).mul(mat3x3q_t::R_3(b)).mul(mat3x3q_t::R_2(c)).mul(mat3x3q_t::R_1(d));
+    EXPECT_TRUE(near(mat3x3q_t::R_seq<1, 3, 2, 1>(a, b, c, d), chain, 1e-18l));
+    EXPECT_TRUE(near(mat3x3q_t::R_seq<2>(c), mat3x3q_t::R_2(c), 0.0l));
+    for (int axis = 1; axis <= 3; ++axis) {
+        const mat3x3q_t r = axis == 1 ? mat3x3q_t::R_1(a) : axis == 2 ? mat3x3q_t::R_2(a) : mat3x3q_t::R_3(a);
+        EXPECT_TRUE(near(chain.rotated(axis, a), r.mul(chain), 1e-18l));
+    }
+    // orthonormal: the transpose is the inverse
+    EXPECT_TRUE(near(chain.mul(chain.transpose()), mat3x3q_t::identity(), 1e-18l));
+    const vec3q_t v = {0.3l, -0.7l, 1.1l};
+    const vec3q_t w = chain.transposeMul(chain.mul(v));
+    for (std::size_t i = 0; i < 3; ++i) {
+        EXPECT_NEAR(w.raw[i], v.raw[i], 1e-18l);
+    }
+}
+
+typedef funmat3x3<spherical3dvec> fm;
+
+// the product is multiplied out symbolically, dropping the zeros and ones
+static_assert(std::is_same_v<decltype(fm::identitymatrix.mul(fm::R_1_mtrx)), std::remove_const_t<decltype(fm::R_1_mtrx)>>);
+static_assert(std::is_same_v<decltype(fm::R_3_mtrx)::elem<2, 0>, funexpr::zero>);
+// and only takes the trig functions it needs: sin θ and cos θ here
+static_assert(decltype(fm::R_1_mtrx.mul(fm::R_3_mtrx))::trig == ((1u << 1) | (8u << 1)));
+static_assert(decltype(fm::sph2cart_mtrx)::trig == ((1u << 1) | (1u << 2) | (8u << 1) | (8u << 2)));
+
+TEST(Mat3x3TestSuite, TestFunmat) {
+    const spherical3dvec v = {{2.0l, 0.6l, -0.3l}};
+    const vec3q_t vq = {v.raw[0], v.raw[1], v.raw[2]};
+    const spherical3dvec r3 = fm::R_3_mtrx.mul(v);
+    const vec3q_t expect = mat3x3q_t::R_3(v.θ()).mul(vq);
+    for (std::size_t i = 0; i < 3; ++i) {
+        EXPECT_NEAR(r3.raw[i], expect.raw[i], 1e-18l);
+    }
+
+    const spherical3dvec r13 = fm::R_1_mtrx.mul(fm::R_3_mtrx).mul(v);
+    const vec3q_t expect13 = mat3x3q_t::R_1(v.θ()).mul(mat3x3q_t::R_3(v.θ())).mul(vq);
+    for (std::size_t i = 0; i < 3; ++i) {
+        EXPECT_NEAR(r13.raw[i], expect13.raw[i], 1e-18l);
+    }
+
+    const mat3x3q_t j = fm::sph2cart_mtrx.eval(v);
+    EXPECT_NEAR(j.elems[0][0], sinl(0.6l) * cosl(-0.3l), 1e-18l);
+    EXPECT_NEAR(j.elems[1][2], cosl(-0.3l), 1e-18l);
+    EXPECT_NEAR(j.elems[2][1], -sinl(0.6l), 1e-18l);
+    EXPECT_EQ(j.elems[2][2], 0.0l);
+
+    // the positional terms: v on the diagonal, sin v on the diagonal
+    const spherical3dvec d = funexpr::make_matrix(fm::ident, fm::zero, fm::zero, fm::zero, fm::ident, fm::zero, fm::zero, fm::zero, fm::ident).mul(v);
+    EXPECT_EQ(d.raw[1], v.raw[1] * v.raw[1]);
+    const mat3x3q_t s = funexpr::make_matrix(fm::sine, fm::one, fm::sine, fm::sine, fm::sine, fm::sine, fm::sine, fm::sine, fm::sine).eval(v);
+    EXPECT_EQ(s.elems[2][2], sinl(-0.3l));
+    EXPECT_EQ(s.elems[0][1], 1.0l);
+    EXPECT_EQ(s.elems[0][2], 0.0l);
+}
+
+typedef mmm::dual<long double> dual_t;
+typedef mmm::dual2<long double> dual2_t;
+
+TEST(DualTestSuite, TestChainRule) {
+    // f(x) = sin(x) exp(-x/10) / (1 + x²), against its derivatives by hand
+    const long double x0 = 0.7l;
+    auto f = [](auto x) { return mmm::sin(x) * mmm::exp(-0.1l * x) / (1.0l + x * x); };
+    const dual_t d = f(dual_t::variable(x0));
+    const dual2_t d2 = f(dual2_t::variable(x0));
+    const long double h = 1e-4l;
+    EXPECT_NEAR(d.v, f(x0), 1e-18l);
+    EXPECT_NEAR(d.d, (f(x0 + h) - f(x0 - h)) / (2 * h), 1e-8l);
+    EXPECT_EQ(d2.v, d.v);
+    EXPECT_NEAR(d2.d, d.d, 1e-18l);
+    EXPECT_NEAR(d2.dd, (f(x0 + h) - 2 * f(x0) + f(x0 - h)) / (h * h), 1e-6l);
+}
+
+TEST(DualTestSuite, TestAtan2) {
+    // a point on a circle at angle t² has θ' = 2t, θ'' = 2
+    const dual2_t t = dual2_t::variable(0.9l);
+    const dual2_t θ = mmm::atan2(3.0l * mmm::sin(t * t), 3.0l * mmm::cos(t * t));
+    EXPECT_NEAR(θ.v, 0.81l, 1e-15l);
+    EXPECT_NEAR(θ.d, 1.8l, 1e-15l);
+    EXPECT_NEAR(θ.dd, 2.0l, 1e-14l);
+}
+
+TEST(DualTestSuite, TestCart2Sph) {
+    // a position and velocity in, longitude and latitude rates out
+    const long double p[3] = {0.3l, -0.8l, 0.2l}, v[3] = {0.01l, 0.02l, -0.005l};
+    const basic_cartesian3dvec<dual_t> c {{dual_t(p[0], v[0]), dual_t(p[1], v[1]), dual_t(p[2], v[2])}};
+    const basic_spherical3dvec<dual_t> sph = basic_spacexfrm3d<dual_t>::cart2sph(c);
+
+    const long double h = 1e-3l;
+    const cartesian3dvec ahead {{p[0] + h * v[0], p[1] + h * v[1], p[2] + h * v[2]}};
+    const cartesian3dvec behind {{p[0] - h * v[0], p[1] - h * v[1], p[2] - h * v[2]}};
+    const spherical3dvec a = spacexfrm3d::cart2sph(ahead), b = spacexfrm3d::cart2sph(behind);
+    EXPECT_NEAR(sph.r().d, (a.r() - b.r()) / (2 * h), 1e-9l);
+    EXPECT_NEAR(sph.θ().d, (a.θ() - b.θ()) / (2 * h), 1e-9l);
+    EXPECT_NEAR(sph.ø().d, (a.ø() - b.ø()) / (2 * h), 1e-9l);
+
+    // and plain values are untouched by going through the dual type
+    const spherical3dvec plain = spacexfrm3d::cart2sph(cartesian3dvec {{p[0], p[1], p[2]}});
+    EXPECT_EQ(sph.ø().v, plain.ø());
+}
+
+TEST(DualTestSuite, TestElongationRate) {
+    // two bodies on circular orbits at different rates, elongation rate is the difference
+    auto at = [](long double t, long double r, long double ω) {
+        return basic_cartesian3dvec<dual_t> {{dual_t(r * cosl(ω * t), -r * ω * sinl(ω * t)), dual_t(r * sinl(ω * t), r * ω * cosl(ω * t)), dual_t(0.0l)}};
+    };
+    const dual_t e = elongation(at(3.0l, 0.0026l, 0.23l), at(3.0l, 1.0l, 0.0172l));
+    EXPECT_NEAR(e.v, 3.0l * (0.23l - 0.0172l), 1e-15l);
+    EXPECT_NEAR(e.d, 0.23l - 0.0172l, 1e-15l);
+
+    const mat3x3q_t rot = mat3x3q_t::R_1(0.4l);
+    const vec3<dual_t> q = rot.mul(at(1.0l, 2.0l, 0.5l));
+    const basic_cartesian3dvec<dual_t> rotated {{q.raw[0], q.raw[1], q.raw[2]}};
+    EXPECT_NEAR(rotated.mag().v, 2.0l, 1e-15l);
+    EXPECT_NEAR(rotated.mag().d, 0.0l, 1e-15l);
 }
-#endif
 
 }
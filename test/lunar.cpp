@@ -0,0 +1,143 @@
+/**
+ * lunar.cpp tests
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#include <gtest/gtest.h>
+#include "../src/lunar.hpp"
+#include "split_range.hpp"
+
+#include <algorithm>
+
+namespace {
+
+using namespace github::paulyc;
+using synthetic::Sky;
+using synthetic::at;
+using synthetic::jdOf;
+
+static constexpr double FROM = Sky::T0;
+static constexpr double TO = FROM + 365.25;
+static constexpr double SPLIT = FROM + 100.3;
+
+// the events of one kind, in order
+std::vector<double> times(const std::vector<LunarEvent> &events, LunarEvent::Kind kind) {
+    std::vector<double> out;
+    for (const LunarEvent &ev : events) {
+        if (ev.kind == kind) {
+            out.push_back(jdOf(ev));
+        }
+    }
+    return out;
+}
+
+// every time in [FROM, TO) angle(jd) = start + rate * (jd - T0) passes target
+std::vector<double> crossings(double start, double rate, double target) {
+    std::vector<double> out;
+    for (double jd = Sky::nextCrossing(FROM, start, rate, target); jd < TO; jd += 2.0 * M_PI / rate) {
+        out.push_back(jd);
+    }
+    return out;
+}
+
+void expectTimes(const std::vector<double> &found, const std::vector<double> &expected, double tolerance) {
+    // 13 or 14 of each a year
+    ASSERT_GE(expected.size(), 13u);
+    ASSERT_EQ(found.size(), expected.size());
+    for (std::size_t i = 0; i < found.size(); ++i) {
+        ASSERT_NEAR(found[i], expected[i], tolerance);
+    }
+}
+
+TEST(lunar_test_suite, test_apsides_and_nodes) {
+    JPLEphems ephems;
+    Sky::open(ephems);
+    const std::vector<LunarEvent> events = findLunarEvents(ephems, at(FROM), at(TO), LunarEvent::Apsides | LunarEvent::Nodes);
+    ASSERT_TRUE(std::is_sorted(events.begin(), events.end(), [](const LunarEvent &a, const LunarEvent &b) {
+        return a.jd < b.jd;
+    }));
+
+    expectTimes(times(events, LunarEvent::Perigee), crossings(Sky::MOON_M0, Sky::MOON_N_ANOMALISTIC, 0.0), 1e-6);
+    expectTimes(times(events, LunarEvent::Apogee), crossings(Sky::MOON_M0, Sky::MOON_N_ANOMALISTIC, M_PI), 1e-6);
+    expectTimes(times(events, LunarEvent::AscendingNode), crossings(Sky::MOON_F0, Sky::MOON_N_DRACONIC, 0.0), 1e-6);
+    expectTimes(times(events, LunarEvent::DescendingNode), crossings(Sky::MOON_F0, Sky::MOON_N_DRACONIC, M_PI), 1e-6);
+
+    for (const LunarEvent &ev : events) {
+        if (ev.kind == LunarEvent::Perigee) {
+            ASSERT_NEAR(ev.value, Sky::MOON_A * (1.0 - Sky::MOON_E) * Sky::AU_KM, 1e-3);
+        } else if (ev.kind == LunarEvent::Apogee) {
+            ASSERT_NEAR(ev.value, Sky::MOON_A * (1.0 + Sky::MOON_E) * Sky::AU_KM, 1e-3);
+        } else {
+            ASSERT_NEAR(synthetic::wrap(ev.value - Sky::longitude(jdOf(ev), JPLEphems::Moon)), 0.0, 1e-9);
+        }
+    }
+}
+
+TEST(lunar_test_suite, test_phases) {
+    JPLEphems ephems;
+    Sky::open(ephems);
+    const std::vector<LunarEvent> events = findLunarEvents(ephems, at(FROM), at(TO), LunarEvent::Phases);
+    auto D = [](double jd) {
+        return synthetic::wrap(Sky::longitude(jd, JPLEphems::Moon) - Sky::longitude(jd, JPLEphems::Sun));
+    };
+    const std::pair<LunarEvent::Kind, double> phases[4] = {
+        {LunarEvent::NewMoon, 0.0}, {LunarEvent::FirstQuarter, M_PI / 2.0},
+        {LunarEvent::FullMoon, M_PI}, {LunarEvent::LastQuarter, -M_PI / 2.0},
+    };
+
+    // as many of each as D passes its target on a quarter-day scan
+    for (const auto &[kind, target] : phases) {
+        std::size_t expected = 0;
+        for (double jd = FROM; jd < TO; jd += 0.25) {
+            const double a = synthetic::wrap(D(jd) - target), b = synthetic::wrap(D(std::min(jd + 0.25, TO)) - target);
+            expected += a < 0.0 && b >= 0.0 && b - a < M_PI;
+        }
+        EXPECT_GE(expected, 12u);
+        EXPECT_EQ(times(events, kind).size(), expected);
+    }
+    // on target, with the Moon's longitude, and in order round the month
+    ASSERT_FALSE(events.empty());
+    std::size_t k = std::find_if(std::begin(phases), std::end(phases), [&](const auto &p) { return p.first == events[0].kind; }) - std::begin(phases);
+    for (const LunarEvent &ev : events) {
+        ASSERT_EQ(ev.kind, phases[k].first) << jdOf(ev);
+        ASSERT_NEAR(synthetic::wrap(D(jdOf(ev)) - phases[k].second), 0.0, 1e-9);
+        ASSERT_NEAR(synthetic::wrap(ev.value - Sky::longitude(jdOf(ev), JPLEphems::Moon)), 0.0, 1e-9);
+        k = (k + 1) % 4;
+    }
+    // the same among the other kinds
+    const std::vector<LunarEvent> all = findLunarEvents(ephems, at(FROM), at(TO));
+    for (const auto &phase : phases) {
+        const std::vector<double> alone = times(events, phase.first), mixed = times(all, phase.first);
+        ASSERT_EQ(alone.size(), mixed.size());
+        for (std::size_t i = 0; i < alone.size(); ++i) {
+            ASSERT_NEAR(alone[i], mixed[i], 1e-9);
+        }
+    }
+}
+
+TEST(lunar_test_suite, test_split_range) {
+    JPLEphems ephems;
+    Sky::open(ephems);
+    synthetic::expectSplitRange([&](const jd_clock::time_point &from, const jd_clock::time_point &to) {
+        return findLunarEvents(ephems, from, to);
+    }, FROM, SPLIT, TO, [](const LunarEvent &a, const LunarEvent &b) {
+        return a.kind == b.kind;
+    });
+}
+
+}
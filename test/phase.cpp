@@ -0,0 +1,127 @@
+/**
+ * phase.cpp tests
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#include <gtest/gtest.h>
+#include "../src/phase.hpp"
+#include "synthetic_sky.hpp"
+
+namespace {
+
+using namespace github::paulyc;
+using synthetic::at;
+
+static constexpr double MOON_R = 0.00257;
+
+// the Sun 1 au along the ecliptic x axis from the Earth, and the Moon at
+// elongation (jd - J2000) * 90° in the ecliptic
+void quarterSky(double jd, JPLEphems::Point point, double *pv) {
+    const double θ = (jd - synthetic::Sky::T0) * M_PI / 2.0;
+    std::array<double, 3> e {0.0, 0.0, 0.0};
+    if (point == JPLEphems::Earth) {
+        e = {-1.0, 0.0, 0.0};
+    } else if (point == JPLEphems::Moon) {
+        e = {-1.0 + MOON_R * std::cos(θ), MOON_R * std::sin(θ), 0.0};
+    }
+    synthetic::Sky::equatorial(e, pv);
+    pv[3] = pv[4] = pv[5] = 0.0;
+}
+
+TEST(phase_test_suite, test_quarters) {
+    JPLEphems ephems;
+    ephems.init("quarters", &quarterSky, synthetic::Sky::AU_KM);
+    // out of order, to check the output follows the input
+    const jd_clock::time_point jds[] = {at(synthetic::Sky::T0 + 2.0), at(synthetic::Sky::T0), at(synthetic::Sky::T0 + 1.0)};
+    const PhaseSeries s = moonPhases(ephems, jds);
+    ASSERT_EQ(s.size(), 3u);
+
+    // full: the Moon opposite the Sun, lit face on
+    ASSERT_NEAR(s.elongation[0], M_PI, 1e-12);
+    ASSERT_NEAR(s.phaseAngle[0], 0.0, 1e-12);
+    ASSERT_NEAR(s.illuminated[0], 1.0, 1e-12);
+    ASSERT_NEAR(s.age[0], SYNODIC_MONTH_JD / 2.0, 1e-9);
+
+    // new: between the Earth and the Sun, dark
+    ASSERT_NEAR(s.elongation[1], 0.0, 1e-12);
+    ASSERT_NEAR(s.phaseAngle[1], M_PI, 1e-12);
+    ASSERT_NEAR(s.illuminated[1], 0.0, 1e-12);
+    ASSERT_NEAR(s.age[1], 0.0, 1e-9);
+
+    // first quarter: at the Moon the Sun is 1 au off at right angles to the Earth,
+    // so the phase angle falls short of 90° by the parallax atan(MOON_R)
+    ASSERT_NEAR(s.elongation[2], M_PI / 2.0, 1e-12);
+    ASSERT_NEAR(s.phaseAngle[2], M_PI / 2.0 - std::atan(MOON_R), 1e-12);
+    ASSERT_NEAR(s.illuminated[2], 0.5 * (1.0 + std::sin(std::atan(MOON_R))), 1e-12);
+    ASSERT_NEAR(s.age[2], SYNODIC_MONTH_JD / 4.0, 1e-9);
+}
+
+TEST(phase_test_suite, test_synthetic_sky) {
+    JPLEphems ephems;
+    synthetic::Sky::open(ephems);
+    std::vector<jd_clock::time_point> jds;
+    for (int i = 0; i < 3000; ++i) {
+        jds.push_back(at(synthetic::Sky::T0 + i * 0.37));
+    }
+    const PhaseSeries s = moonPhases(ephems, jds);
+    for (std::size_t i = 0; i < jds.size(); ++i) {
+        const double jd = synthetic::Sky::T0 + static_cast<double>(i) * 0.37;
+        const double Δλ = synthetic::Sky::longitude(jd, JPLEphems::Moon) - synthetic::Sky::longitude(jd, JPLEphems::Sun);
+        ASSERT_NEAR(s.age[i], (Δλ < 0.0 ? Δλ + 2.0 * M_PI : Δλ) * SYNODIC_MONTH_JD / (2.0 * M_PI), 1e-9);
+        ASSERT_NEAR(s.illuminated[i], 0.5 * (1.0 + std::cos(s.phaseAngle[i])), 1e-15);
+        // the phase angle and elongation add to a bit under π, the rest is the Sun's parallax
+        ASSERT_NEAR(s.phaseAngle[i] + s.elongation[i], M_PI, 0.003);
+        ASSERT_LE(s.phaseAngle[i] + s.elongation[i], M_PI + 1e-12);
+    }
+}
+
+TEST(phase_test_suite, test_simd_levels) {
+    JPLEphems ephems;
+    synthetic::Sky::open(ephems);
+    // a couple of chunks and a ragged end
+    std::vector<jd_clock::time_point> jds;
+    std::vector<double> epochs;
+    for (int i = 0; i < 2500; ++i) {
+        epochs.push_back(synthetic::Sky::T0 + i * 0.113);
+        jds.push_back(at(epochs.back()));
+    }
+    // one libm atan2 and cos per epoch, as the series was computed before it was batched
+    std::vector<JPLEphems::State> moon(epochs.size()), sun(epochs.size());
+    ephems.get_moon_sun(epochs.data(), epochs.size(), moon.data(), sun.data());
+    auto angle = [](const double *a, const double *b) {
+        const double c[3] = {a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0]};
+        return std::atan2(std::sqrt(c[0] * c[0] + c[1] * c[1] + c[2] * c[2]), a[0] * b[0] + a[1] * b[1] + a[2] * b[2]);
+    };
+    for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::AVX2, SimdLevel::AVX512}) {
+        if (level > detectedSimdLevel()) {
+            continue;
+        }
+        const PhaseSeries s = moonPhases(ephems, jds, level);
+        ASSERT_EQ(s.size(), jds.size());
+        for (std::size_t i = 0; i < jds.size(); ++i) {
+            const double *m = moon[i].pv, *p = sun[i].pv;
+            const double toEarth[3] = {-m[0], -m[1], -m[2]}, toSun[3] = {p[0] - m[0], p[1] - m[1], p[2] - m[2]};
+            const double phaseAngle = angle(toEarth, toSun);
+            ASSERT_NEAR(s.elongation[i], angle(m, p), 1e-14) << name(level) << ' ' << i;
+            ASSERT_NEAR(s.phaseAngle[i], phaseAngle, 1e-14) << name(level) << ' ' << i;
+            ASSERT_NEAR(s.illuminated[i], 0.5 * (1.0 + std::cos(phaseAngle)), 1e-15) << name(level) << ' ' << i;
+        }
+    }
+}
+
+}
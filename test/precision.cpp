@@ -0,0 +1,74 @@
+/**
+ * precision.cpp tests
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#include <gtest/gtest.h>
+#include "../src/astro.hpp"
+
+namespace {
+
+using namespace github::paulyc;
+
+static_assert(std::is_same_v<real_t<default_precision>, long double>);
+static_assert(std::is_same_v<quad_precision::fun_1d, std::function<__float128(__float128)>>);
+// same storage, not the same number
+static_assert(extended_precision::digits < quad_precision::digits);
+
+template <typename P>
+MoonSunGeometry<P> sample() {
+    typedef real_t<P> real;
+    return moonSunGeometry<P>(typename P::cartesian {{real(-0.0021l), real(0.0013l), real(0.0007l)}},
+                              typename P::cartesian {{real(0.17l), real(-0.89l), real(-0.386l)}});
+}
+
+template <typename P>
+void expectAgrees(long double tolerance) {
+    const MoonSunGeometry<quad_precision> q = sample<quad_precision>();
+    const MoonSunGeometry<P> g = sample<P>();
+    EXPECT_NEAR(static_cast<long double>(g.elongation), static_cast<long double>(q.elongation), tolerance) << P::name;
+    EXPECT_NEAR(static_cast<long double>(g.α_sun), static_cast<long double>(q.α_sun), tolerance) << P::name;
+    EXPECT_NEAR(static_cast<long double>(g.δ_moon), static_cast<long double>(q.δ_moon), tolerance) << P::name;
+    // the chord and the angle describe the same separation
+    EXPECT_NEAR(static_cast<long double>(g.sphDistance), 2.0l * sinl(0.5l * static_cast<long double>(q.elongation)), 8.0l * tolerance) << P::name;
+}
+
+TEST(precision_test_suite, test_policies_agree) {
+    expectAgrees<double_precision>(1e-15l);
+    expectAgrees<extended_precision>(1e-18l);
+    expectAgrees<quad_precision>(0.0l);
+
+    const MoonSunGeometry<extended_precision> g = sample<extended_precision>();
+    EXPECT_NEAR(g.α_sun, asinl(-0.89l / sqrtl(0.17l * 0.17l + 0.89l * 0.89l)), 1e-18l);
+    EXPECT_NEAR(g.dα, g.α_moon - g.α_sun, 0.0l);
+}
+
+TEST(precision_test_suite, test_policy_operators) {
+    auto f = [](__float128 x) { return (x - 0.75q) * (x - 0.75q) + cosq(x); };
+    const std::optional<__float128> x = min_x<quad_precision>(f, 0.0q, 2.0q, 1e-25q);
+    ASSERT_TRUE(x);
+    // f' = 2(x - 0.75) - sin x; a minimum is only located to about √ε, which in
+    // double would be 1e-8
+    EXPECT_LT(static_cast<double>(fabsq(2.0q * (*x - 0.75q) - sinq(*x))), 1e-15);
+
+    const double_precision::fun_1d d = d_op<double_precision>([](double x) { return x * x * x; }, 1e-5);
+    EXPECT_NEAR(d(2.0), 12.0, 1e-8);
+    EXPECT_NEAR(d2_op<double_precision>([](double x) { return x * x * x; }, 1e-3)(2.0), 12.0, 1e-6);
+}
+
+}
@@ -0,0 +1,156 @@
+/**
+ * quaternion.cpp tests
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#include <gtest/gtest.h>
+#include "../src/quaternion.hpp"
+
+namespace {
+
+using namespace github::paulyc;
+
+long double maxDiff(const mat3x3q_t &a, const mat3x3q_t &b) {
+    long double d = 0.0l;
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            d = std::max(d, fabsl(a.elems[i][j] - b.elems[i][j]));
+        }
+    }
+    return d;
+}
+
+TEST(quaternion_test_suite, test_matches_matrices) {
+    const long double a = 0.3l, b = -1.2l, c = 2.9l;
+    EXPECT_LT(maxDiff(quaternionq_t::R_1(a).matrix(), mat3x3q_t::R_1(a)), 1e-18l);
+    EXPECT_LT(maxDiff(quaternionq_t::R_2(b).matrix(), mat3x3q_t::R_2(b)), 1e-18l);
+    EXPECT_LT(maxDiff(quaternionq_t::R_3(c).matrix(), mat3x3q_t::R_3(c)), 1e-18l);
+    const quaternionq_t q = quaternionq_t::R_seq<3, 1, 3, 2>(a, b, c, a);
+    const mat3x3q_t m = mat3x3q_t::R_seq<3, 1, 3, 2>(a, b, c, a);
+    EXPECT_LT(maxDiff(q.matrix(), m), 1e-18l);
+    EXPECT_LT(maxDiff(quaternionq_t::R_1(a).mul(quaternionq_t::R_3(b)).matrix(), mat3x3q_t::R_1(a).mul(mat3x3q_t::R_3(b))), 1e-18l);
+
+    const vec3q_t v {0.2l, -3.0l, 1.5l};
+    const vec3q_t qv = q.mul(v), mv = m.mul(v), back = q.transposeMul(qv);
+    for (int i = 0; i < 3; ++i) {
+        EXPECT_NEAR(qv.raw[i], mv.raw[i], 1e-17l);
+        EXPECT_NEAR(back.raw[i], v.raw[i], 1e-17l);
+    }
+
+    // back from the matrix, through each of Shepperd's four branches
+    for (const quaternionq_t &r : {q, quaternionq_t::R_1(3.0l), quaternionq_t::R_2(3.0l), quaternionq_t::R_3(-3.0l)}) {
+        const quaternionq_t f = quaternionq_t::fromMatrix(r.matrix());
+        EXPECT_LT(quaternionq_t::angle(f, r), 1e-17l);
+        EXPECT_GE(f.w, 0.0l);
+    }
+}
+
+TEST(quaternion_test_suite, test_slerp) {
+    const quaterniond_t a = quaterniond_t::R_seq<3, 1>(0.4, 0.1), step = quaterniond_t::R_2(0.8);
+    const quaterniond_t b = step.mul(a);
+    EXPECT_NEAR(quaterniond_t::angle(a, b), 0.8, 1e-15);
+    // slerp advances the angle uniformly along the one rotation between them
+    for (double t = 0.0; t <= 1.0; t += 0.125) {
+        const quaterniond_t s = quaterniond_t::slerp(a, b, t);
+        EXPECT_NEAR(s.norm(), 1.0, 1e-15);
+        EXPECT_LT(quaterniond_t::angle(s, quaterniond_t::R_2(0.8 * t).mul(a)), 1e-14) << t;
+    }
+    // -b is b, and slerp goes the short way round
+    const quaterniond_t nb {-b.w, -b.x, -b.y, -b.z};
+    EXPECT_LT(quaterniond_t::angle(quaterniond_t::slerp(a, nb, 0.5), quaterniond_t::R_2(0.4).mul(a)), 1e-14);
+    EXPECT_EQ(quaterniond_t::slerp(a, a, 0.3).w, a.w);
+}
+
+TEST(quaternion_test_suite, test_batch_rotate) {
+    const quaterniond_t q = quaterniond_t::R_seq<3, 1, 3>(-0.2, 0.409, 0.1);
+    const mat3x3<double> m = q.matrix();
+    Vec3BatchD in;
+    for (std::size_t i = 0; i < 1003; ++i) {
+        in.push_back(vec3d_t {std::cos(0.01 * i), std::sin(0.03 * i), 0.5 - 0.001 * i});
+    }
+    for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::AVX2, SimdLevel::AVX512}) {
+        Vec3BatchD out;
+        batch::rotate(q, in, out, level);
+        ASSERT_EQ(out.size(), in.size());
+        for (std::size_t i = 0; i < in.size(); ++i) {
+            const vec3d_t e = m.mul(vec3d_t {in.x[i], in.y[i], in.z[i]});
+            EXPECT_NEAR(out.x[i], e.raw[0], 1e-15);
+            EXPECT_NEAR(out.y[i], e.raw[1], 1e-15);
+            EXPECT_NEAR(out.z[i], e.raw[2], 1e-15);
+        }
+    }
+    // in place
+    Vec3BatchD copy = in;
+    batch::rotate(m, copy, copy);
+    EXPECT_NEAR(copy.x[7], m.mul(vec3d_t {in.x[7], in.y[7], in.z[7]}).raw[0], 1e-15);
+}
+
+TEST(quaternion_test_suite, test_slerped_rotation) {
+    // a frame turning at a constant rate about a fixed axis is exactly what slerp does
+    const quaterniond_t tilt = quaterniond_t::R_1(0.409);
+    int evaluations = 0;
+    SlerpedRotation<double> r([&](long double jd) {
+        ++evaluations;
+        return tilt.mul(quaterniond_t::R_3(static_cast<double>(0.0172l * (jd - 2451545.0l))));
+    }, 2.0l);
+    std::vector<jd_clock::time_point> jds;
+    Vec3BatchD in;
+    for (int i = 0; i < 100; ++i) {
+        const long double jd = 2451545.0l + 0.37l * i;
+        jds.push_back(jd_clock::time_point(jd_clock::duration(jd)));
+        in.push_back(vec3d_t {1.0, 0.5 * i, -2.0});
+        const quaterniond_t exact = tilt.mul(quaterniond_t::R_3(static_cast<double>(0.0172l * (jd - 2451545.0l))));
+        EXPECT_LT(quaterniond_t::angle(r.at(jd), exact), 1e-14) << i;
+    }
+    // one node per step for a time ordered series
+    EXPECT_LE(evaluations, 2 + 37 / 2 + 1);
+
+    Vec3BatchD out;
+    r.apply(jds, in, out);
+    const vec3d_t e = r.at(jds[42].time_since_epoch().count()).mul(vec3d_t {in.x[42], in.y[42], in.z[42]});
+    EXPECT_NEAR(out.y[42], e.raw[1], 1e-13);
+    EXPECT_THROW(r.apply(std::span<const jd_clock::time_point>(jds).first(3), in, out), std::runtime_error);
+    EXPECT_THROW(SlerpedRotation<double>(nullptr, 0.0l), std::runtime_error);
+}
+
+TEST(quaternion_test_suite, test_composition_drift) {
+    // a million small steps: the matrix product drifts off orthogonal, the
+    // renormalized quaternion stays a rotation
+    const double θ = 1e-3;
+    const mat3x3<double> dm = mat3x3<double>::R_seq<1, 3>(θ, 0.7 * θ);
+    const quaterniond_t dq = quaterniond_t::R_seq<1, 3>(θ, 0.7 * θ);
+    mat3x3<double> m = mat3x3<double>::identity();
+    quaterniond_t q = quaterniond_t::identity();
+    for (int i = 0; i < 1000000; ++i) {
+        m = dm.mul(m);
+        q = dq.mul(q);
+    }
+    const mat3x3<double> mq = q.normalize().matrix();
+    double mDrift = 0.0, qDrift = 0.0;
+    const mat3x3<double> mmt = m.mul(m.transpose()), qqt = mq.mul(mq.transpose());
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            mDrift = std::max(mDrift, std::fabs(mmt.elems[i][j] - (i == j)));
+            qDrift = std::max(qDrift, std::fabs(qqt.elems[i][j] - (i == j)));
+        }
+    }
+    EXPECT_LT(qDrift, 1e-15);
+    EXPECT_GT(mDrift, 10.0 * qDrift);
+}
+
+}
@@ -0,0 +1,47 @@
+/**
+ * split_range.hpp
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#ifndef PAULYC_SPLIT_RANGE_HPP
+#define PAULYC_SPLIT_RANGE_HPP
+
+#include <gtest/gtest.h>
+#include "synthetic_sky.hpp"
+
+namespace synthetic {
+
+// search(from, to) over [from, split) and [split, to) finds the same events as
+// over [from, to) in one go: same(a, b) for each pair, at times within tolerance
+template <typename Search, typename Same>
+void expectSplitRange(Search &&search, double from, double split, double to, Same &&same, double tolerance = 1e-7) {
+    const auto whole = search(at(from), at(to));
+    auto pieces = search(at(from), at(split));
+    const auto rest = search(at(split), at(to));
+    pieces.insert(pieces.end(), rest.begin(), rest.end());
+
+    ASSERT_EQ(whole.size(), pieces.size());
+    for (std::size_t i = 0; i < whole.size(); ++i) {
+        ASSERT_TRUE(same(whole[i], pieces[i])) << i;
+        ASSERT_NEAR(jdOf(whole[i]), jdOf(pieces[i]), tolerance) << i;
+    }
+}
+
+}
+
+#endif /* PAULYC_SPLIT_RANGE_HPP */
@@ -0,0 +1,122 @@
+/**
+ * stations.cpp tests
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#include <gtest/gtest.h>
+#include "../src/frames.hpp"
+#include "../src/solvers.hpp"
+#include "../src/stations.hpp"
+#include "split_range.hpp"
+
+#include <algorithm>
+
+namespace {
+
+using namespace github::paulyc;
+using synthetic::Sky;
+using synthetic::at;
+using synthetic::jdOf;
+
+static constexpr double FROM = Sky::T0;
+static constexpr double TO = FROM + 800.0;
+static constexpr double SPLIT = FROM + 333.3;
+static constexpr double SIGN = M_PI / 6.0;
+
+// geocentric longitude on the true ecliptic and equinox of date, through the exact
+// frame rotation, and its rate by central difference
+struct OfDate {
+    JPLEphems &ephems;
+    FrameRotation frame;
+
+    explicit OfDate(JPLEphems &e) : ephems(e), frame(e) {}
+
+    double λ(double jd, JPLEphems::Point body) {
+        const JPLEphems::State s = ephems.get_state(jd, JPLEphems::Earth, body);
+        const vec3q_t p = frame.ecliptic(jd).mul(s.position());
+        const double a = static_cast<double>(atan2l(p.raw[1], p.raw[0]));
+        return a < 0.0 ? a + 2.0 * M_PI : a;
+    }
+    double dλ(double jd, JPLEphems::Point body) {
+        static constexpr double H = 1e-3;
+        return synthetic::wrap(λ(jd + H, body) - λ(jd - H, body)) / (2.0 * H);
+    }
+};
+
+TEST(stations_test_suite, test_stations_and_ingresses) {
+    JPLEphems ephems;
+    Sky::open(ephems);
+    OfDate truth(ephems);
+    const std::vector<PlanetEvent> events = findPlanetEvents(ephems, at(FROM), at(TO));
+    ASSERT_TRUE(std::is_sorted(events.begin(), events.end(), [](const PlanetEvent &a, const PlanetEvent &b) {
+        return a.jd < b.jd;
+    }));
+
+    for (const JPLEphems::Point body : PlanetEvent::BODIES) {
+        // sign boundaries crossed, on a grid fine enough to see each one
+        int crossings = 0;
+        for (double jd = FROM; jd < TO; jd += 0.25) {
+            crossings += std::floor(truth.λ(jd, body) / SIGN) != std::floor(truth.λ(std::min(jd + 0.25, TO), body) / SIGN);
+        }
+
+        int ingresses = 0, stations = 0;
+        PlanetEvent::Kind lastStation = PlanetEvent::Ingress;
+        for (const PlanetEvent &ev : events) {
+            if (ev.body != body) {
+                continue;
+            }
+            const double jd = jdOf(ev);
+            if (ev.kind == PlanetEvent::Ingress) {
+                ++ingresses;
+                // on a boundary, the one at the start of the sign or, going backwards, its end
+                const double boundary = static_cast<double>(ev.longitude);
+                ASSERT_NEAR(synthetic::wrap(boundary - std::round(boundary / SIGN) * SIGN), 0.0, 1e-12);
+                ASSERT_NEAR(synthetic::wrap(truth.λ(jd, body) - boundary), 0.0, 1e-8);
+                // just after, the body is in the sign it entered
+                ASSERT_EQ(static_cast<int>(std::floor(truth.λ(jd + 1e-3, body) / SIGN)), ev.sign);
+            } else {
+                ++stations;
+                ASSERT_NE(ev.kind, lastStation);
+                lastStation = ev.kind;
+                // where the rate of the longitude of date really turns
+                auto rate = [&](double t) { return truth.dλ(t, body); };
+                const SolverResult<double> root = brent_root(rate, jd - 0.1, jd + 0.1, rate(jd - 0.1), rate(jd + 0.1), 1e-7);
+                ASSERT_TRUE(root);
+                ASSERT_NEAR(jd, root.x, 1e-4);
+            }
+        }
+        ASSERT_EQ(ingresses, crossings);
+        if (body == JPLEphems::Sun || body == JPLEphems::Moon) {
+            ASSERT_EQ(stations, 0);
+        } else {
+            ASSERT_GE(stations, 2);
+        }
+    }
+}
+
+TEST(stations_test_suite, test_split_range) {
+    JPLEphems ephems;
+    Sky::open(ephems);
+    synthetic::expectSplitRange([&](const jd_clock::time_point &from, const jd_clock::time_point &to) {
+        return findPlanetEvents(ephems, from, to);
+    }, FROM, SPLIT, TO, [](const PlanetEvent &a, const PlanetEvent &b) {
+        return a.body == b.body && a.kind == b.kind && a.sign == b.sign;
+    });
+}
+
+}
@@ -0,0 +1,172 @@
+/**
+ * synthetic_sky.hpp
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#ifndef PAULYC_SYNTHETIC_SKY_HPP
+#define PAULYC_SYNTHETIC_SKY_HPP
+
+#include "../src/astro.hpp"
+
+#include <array>
+#include <cmath>
+
+namespace synthetic {
+
+/*
+ * A made-up solar system to run the searches against without an ephemeris file.
+ * The Sun sits at the barycenter, the Earth goes round it on a Kepler ellipse
+ * (to first order in e) and the planets on circles, all in the J2000 ecliptic.
+ * The Moon's orbit is inclined and eccentric, with its node regressing. States
+ * are handed out in the equatorial frame as the ephemeris does, and velocities
+ * are central differences.
+ *
+ * Everything is closed form, so the events have exact times to check against:
+ * perigee where the Moon's mean anomaly is 0, apogee where it's π, and the nodes
+ * where its argument of latitude is 0 or π.
+ */
+struct Sky {
+    static constexpr double AU_KM = 149597870.7;
+    static constexpr double T0 = 2451545.0;
+    static constexpr double DEG = M_PI / 180.0;
+    static constexpr double VELOCITY_STEP_JD = 1e-3;
+
+    // Earth
+    static constexpr double EARTH_N = 2.0 * M_PI / 365.256363;
+    static constexpr double EARTH_E = 0.0167;
+    static constexpr double EARTH_L0 = 100.46 * DEG;
+    static constexpr double EARTH_M0 = 357.53 * DEG;
+
+    // Moon
+    static constexpr double MOON_A = 0.00257;
+    static constexpr double MOON_E = 0.0549;
+    static constexpr double MOON_I = 5.145 * DEG;
+    static constexpr double MOON_N_ANOMALISTIC = 2.0 * M_PI / 27.554550;
+    static constexpr double MOON_N_DRACONIC = 2.0 * M_PI / 27.212221;
+    static constexpr double MOON_N_NODE = -2.0 * M_PI / 6798.38;
+    static constexpr double MOON_M0 = 134.96 * DEG;
+    static constexpr double MOON_F0 = 93.27 * DEG;
+    static constexpr double MOON_Ω0 = 125.04 * DEG;
+
+    // nutation in longitude and obliquity, the 18.6 year term only
+    static constexpr double NUTATION_Δψ = -17.2 / 206264.806;
+    static constexpr double NUTATION_Δε = 9.2 / 206264.806;
+
+    // heliocentric radius and longitude at epoch of Mercury .. Pluto
+    static constexpr double PLANET_A[9] = {0.387, 0.723, 1.0, 1.524, 5.203, 9.537, 19.19, 30.07, 39.48};
+    static constexpr double PLANET_L0[9] = {252.25, 181.98, 0.0, 355.43, 34.35, 50.08, 314.06, 304.35, 238.93};
+
+    static double moonMeanAnomaly(double jd) { return MOON_M0 + MOON_N_ANOMALISTIC * (jd - T0); }
+    static double moonArgumentOfLatitude(double jd) { return MOON_F0 + MOON_N_DRACONIC * (jd - T0); }
+
+    // first jd >= from where angle(jd) = start + rate * (jd - T0) is target mod 2π
+    static double nextCrossing(double from, double start, double rate, double target) {
+        const double phase = start + rate * (from - T0) - target;
+        const double k = std::ceil(phase / (2.0 * M_PI));
+        return from + (2.0 * M_PI * k - phase) / rate;
+    }
+
+    // J2000 ecliptic position of a point, au, relative to the barycenter
+    static std::array<double, 3> ecliptic(double jd, JPLEphems::Point point) {
+        const double t = jd - T0;
+        switch (point) {
+        case JPLEphems::Sun:
+        case JPLEphems::SolarSystemBarycenter:
+            return {0.0, 0.0, 0.0};
+        case JPLEphems::Earth:
+        case JPLEphems::EarthMoonBarycenter: {
+            const double M = EARTH_M0 + EARTH_N * t;
+            const double r = 1.0 - EARTH_E * std::cos(M);
+            const double θ = EARTH_L0 + EARTH_N * t + 2.0 * EARTH_E * std::sin(M);
+            return {r * std::cos(θ), r * std::sin(θ), 0.0};
+        }
+        case JPLEphems::Moon: {
+            const std::array<double, 3> e = ecliptic(jd, JPLEphems::Earth);
+            const double r = MOON_A * (1.0 - MOON_E * std::cos(moonMeanAnomaly(jd)));
+            const double u = moonArgumentOfLatitude(jd);
+            const double Ω = MOON_Ω0 + MOON_N_NODE * t;
+            return {
+                e[0] + r * (std::cos(Ω) * std::cos(u) - std::sin(Ω) * std::sin(u) * std::cos(MOON_I)),
+                e[1] + r * (std::sin(Ω) * std::cos(u) + std::cos(Ω) * std::sin(u) * std::cos(MOON_I)),
+                e[2] + r * std::sin(u) * std::sin(MOON_I),
+            };
+        }
+        default: {
+            const double a = PLANET_A[point - 1];
+            const double θ = PLANET_L0[point - 1] * DEG + 0.01720209895 / (a * std::sqrt(a)) * t;
+            return {a * std::cos(θ), a * std::sin(θ), 0.0};
+        }
+        }
+    }
+
+    static void equatorial(const std::array<double, 3> &e, double *out) {
+        const double c = std::cos(static_cast<double>(OBLIQUITY_J2000));
+        const double s = std::sin(static_cast<double>(OBLIQUITY_J2000));
+        out[0] = e[0];
+        out[1] = c * e[1] - s * e[2];
+        out[2] = s * e[1] + c * e[2];
+    }
+
+    static void state(double jd, JPLEphems::Point point, double *pv) {
+        if (point == JPLEphems::Nutations) {
+            const double Ω = MOON_Ω0 + MOON_N_NODE * (jd - T0);
+            pv[0] = NUTATION_Δψ * std::sin(Ω);
+            pv[1] = NUTATION_Δε * std::cos(Ω);
+            pv[2] = NUTATION_Δψ * MOON_N_NODE * std::cos(Ω);
+            pv[3] = -NUTATION_Δε * MOON_N_NODE * std::sin(Ω);
+            return;
+        }
+        double ahead[3], behind[3];
+        equatorial(ecliptic(jd, point), pv);
+        equatorial(ecliptic(jd + VELOCITY_STEP_JD, point), ahead);
+        equatorial(ecliptic(jd - VELOCITY_STEP_JD, point), behind);
+        for (int k = 0; k < 3; ++k) {
+            pv[3 + k] = (ahead[k] - behind[k]) / (2.0 * VELOCITY_STEP_JD);
+        }
+    }
+
+    static void open(JPLEphems &ephems) {
+        ephems.init("synthetic", &state, AU_KM);
+    }
+
+    // geocentric J2000 ecliptic longitude of a body in [0, 2π)
+    static double longitude(double jd, JPLEphems::Point body) {
+        const std::array<double, 3> b = ecliptic(jd, body), e = ecliptic(jd, JPLEphems::Earth);
+        const double λ = std::atan2(b[1] - e[1], b[0] - e[0]);
+        return λ < 0.0 ? λ + 2.0 * M_PI : λ;
+    }
+};
+
+// to (-π, π]
+inline double wrap(double a) {
+    return std::remainder(a, 2.0 * M_PI);
+}
+
+inline jd_clock::time_point at(double jd) {
+    return jd_clock::time_point(jd_clock::duration(jd));
+}
+
+// the time of a LunarEvent, Aspect or PlanetEvent
+template <typename Event>
+double jdOf(const Event &ev) {
+    return static_cast<double>(ev.jd.time_since_epoch().count());
+}
+
+}
+
+#endif /* PAULYC_SYNTHETIC_SKY_HPP */
@@ -0,0 +1,276 @@
+/**
+ * tetrabiblos.cpp tests
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#include <gtest/gtest.h>
+#include "../src/tetrabiblos.hpp"
+#include "../src/ingress.hpp"
+
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <thread>
+
+namespace {
+
+using namespace github::paulyc;
+using namespace github::paulyc::tetrabiblos;
+using std::chrono::system_clock;
+
+// mean new moons and equal signs, the Sun entering Capricornus on 2020-12-21
+struct MeanSky {
+    static constexpr long double SYNODIC = 29.530588853l;
+    static constexpr long double SIGN = 365.24219l / 12.0l;
+    static constexpr long double NEW_MOON = 2459198.18l;
+    static constexpr long double CAPRICORNUS = 2459205.42l;
+    static constexpr long double FROM = 2459100.0l;
+    static constexpr long double TO = FROM + 6 * 365.25l;
+    std::vector<jd_clock::time_point> newMoons;
+    // from the ingress before from
+    std::vector<PlanetEvent> ingresses;
+
+    explicit MeanSky(long double from = FROM, long double to = TO) {
+        for (long k = static_cast<long>(floorl((from - NEW_MOON) / SYNODIC)); NEW_MOON + k * SYNODIC < to; ++k) {
+            if (NEW_MOON + k * SYNODIC >= from) {
+                newMoons.push_back(at(NEW_MOON + k * SYNODIC));
+            }
+        }
+        for (long k = static_cast<long>(floorl((from - CAPRICORNUS) / SIGN)); CAPRICORNUS + k * SIGN < to; ++k) {
+            const int sign = static_cast<int>(((9 + k) % 12 + 12) % 12);
+            ingresses.push_back(PlanetEvent {JPLEphems::Sun, PlanetEvent::Ingress, at(CAPRICORNUS + k * SIGN), sign * MMM_PI / 6.0l, sign});
+        }
+    }
+    static jd_clock::time_point at(long double jd) {
+        return jd_clock::time_point(jd_clock::duration(jd));
+    }
+    static system_clock::time_point utc(long double jd) {
+        return jd_clock::to_system_clock(at(jd));
+    }
+    // the sign the Sun is in at jd
+    int sign(long double jd) const {
+        int s = -1;
+        for (const PlanetEvent &ev : ingresses) {
+            if (ev.jd.time_since_epoch().count() <= jd) {
+                s = ev.sign;
+            }
+        }
+        return s;
+    }
+};
+
+TEST(tetrabiblos_test_suite, test_months) {
+    const MeanSky sky;
+    Calendar calendar;
+    calendar.insert(MeanSky::at(MeanSky::FROM), MeanSky::at(MeanSky::TO), sky.newMoons, sky.ingresses);
+    EXPECT_EQ(calendar.months(), sky.newMoons.size());
+
+    // the first new moon after the ingress into Capricornus starts 2021
+    const long double newYear = 2459198.18l + MeanSky::SYNODIC;
+    Date d = calendar.date(MeanSky::utc(newYear + 0.01l));
+    ASSERT_TRUE(d.valid);
+    EXPECT_EQ(d.month, CAPRICORNUS);
+    EXPECT_EQ(d.dayOfMonth, 1);
+    EXPECT_EQ(d.year, 2021);
+    EXPECT_EQ(d.precessionalCycle, 0);
+    EXPECT_FALSE(d.leap);
+    // the month before is Sagittarius of a year that began before the events did
+    EXPECT_FALSE(calendar.date(MeanSky::utc(newYear - 0.01l)).valid);
+    std::ostringstream os;
+    os << calendar.date(MeanSky::utc(newYear + 4.5l));
+    EXPECT_EQ(os.str(), "dayOfMonth: 5 month: Capricornus year: 2021 cycle: 0");
+
+    // every month is named for the Sun's sign at its new moon, a repeat is a leap
+    // month, and the year turns over at each Capricornus month
+    int leaps = 0;
+    int prevSign = sky.sign(newYear - MeanSky::SYNODIC);
+    int year = 2021;
+    for (long double jd = newYear; jd + MeanSky::SYNODIC < MeanSky::TO; jd += MeanSky::SYNODIC) {
+        const int sign = sky.sign(jd);
+        d = calendar.date(MeanSky::utc(jd + 12.5l));
+        ASSERT_TRUE(d.valid);
+        EXPECT_EQ(d.month, signMonth(sign));
+        EXPECT_EQ(d.dayOfMonth, 13);
+        EXPECT_EQ(d.leap, sign == prevSign);
+        if (d.month == CAPRICORNUS && !d.leap && jd > newYear) {
+            ++year;
+        }
+        EXPECT_EQ(d.year, year);
+        EXPECT_EQ(calendar.date(MeanSky::utc(jd + MeanSky::SYNODIC - 0.01l)).dayOfMonth, 30);
+        leaps += d.leap;
+        prevSign = sign;
+    }
+    // 7 in 19 years
+    EXPECT_GE(leaps, 1);
+    EXPECT_LE(leaps, 3);
+
+    // nothing before the first year start or after the last new moon
+    EXPECT_FALSE(calendar.date(MeanSky::utc(MeanSky::FROM + 1.0l)).valid);
+    EXPECT_FALSE(calendar.date(MeanSky::utc(MeanSky::TO + 1.0l)).valid);
+    os.str("");
+    os << calendar.date(MeanSky::utc(MeanSky::FROM));
+    EXPECT_EQ(os.str(), "invalid Date");
+}
+
+TEST(tetrabiblos_test_suite, test_insert) {
+    const MeanSky sky;
+    // in two overlapping pieces, the same as in one
+    Calendar whole, pieces;
+    whole.insert(MeanSky::at(MeanSky::FROM), MeanSky::at(MeanSky::TO), sky.newMoons, sky.ingresses);
+    const long double mid = MeanSky::FROM + 1000.0l;
+    pieces.insert(MeanSky::at(mid), MeanSky::at(MeanSky::TO), sky.newMoons, sky.ingresses);
+    pieces.insert(MeanSky::at(MeanSky::FROM), MeanSky::at(mid + 100.0l), sky.newMoons, sky.ingresses);
+    EXPECT_EQ(pieces.months(), whole.months());
+
+    std::vector<system_clock::time_point> tps;
+    for (long double jd = MeanSky::FROM; jd < MeanSky::TO; jd += 0.37l) {
+        tps.push_back(MeanSky::utc(jd));
+    }
+    std::vector<Date> a(tps.size()), b(tps.size());
+    whole.dates(tps, a);
+    pieces.dates(tps, b);
+    for (std::size_t i = 0; i < tps.size(); ++i) {
+        ASSERT_EQ(a[i].valid, b[i].valid);
+        EXPECT_EQ(a[i].month, b[i].month);
+        EXPECT_EQ(a[i].dayOfMonth, b[i].dayOfMonth);
+        EXPECT_EQ(a[i].year, b[i].year);
+        EXPECT_EQ(a[i].leap, b[i].leap);
+        EXPECT_EQ(a[i].valid, whole.date(tps[i]).valid);
+    }
+
+    EXPECT_THROW(whole.insert(MeanSky::at(MeanSky::TO + 10.0l), MeanSky::at(MeanSky::TO + 20.0l), {}, {}), std::runtime_error);
+    EXPECT_THROW(whole.dates(tps, std::span<Date>(a.data(), 1)), std::runtime_error);
+}
+
+
+TEST(tetrabiblos_test_suite, test_calendar_months) {
+    const MeanSky sky;
+    Calendar calendar;
+    calendar.insert(MeanSky::at(MeanSky::FROM), MeanSky::at(MeanSky::TO), sky.newMoons, sky.ingresses);
+
+    const std::vector<CalendarMonth> months = calendar.months(2021, 2024);
+    ASSERT_FALSE(months.empty());
+    EXPECT_EQ(months.front().year, 2021);
+    EXPECT_EQ(months.front().month, CAPRICORNUS);
+    EXPECT_EQ(months.back().year, 2024);
+    // 12 or 13 months a year, each starting where the one before ended
+    int leaps = 0;
+    for (std::size_t i = 0; i < months.size(); ++i) {
+        EXPECT_EQ(months[i].days, 30);
+        const Date d = calendar.date(months[i].start);
+        EXPECT_EQ(d.dayOfMonth, 1);
+        EXPECT_EQ(d.month, months[i].month);
+        EXPECT_EQ(d.leap, months[i].leap);
+        leaps += months[i].leap;
+        if (i > 0) {
+            EXPECT_EQ(calendar.date(months[i].start - std::chrono::seconds(1)).dayOfMonth, months[i - 1].days);
+        }
+    }
+    EXPECT_EQ(months.size(), 48u + leaps);
+    EXPECT_TRUE(calendar.months(1900, 2000).empty());
+
+    std::ostringstream csv, json;
+    writeCsv(csv, std::span<const CalendarMonth>(months.data(), 2));
+    writeJson(json, std::span<const CalendarMonth>(months.data(), 1));
+    const std::string c = csv.str(), j = json.str();
+    EXPECT_EQ(c.substr(0, 33), "cycle,year,month,leap,start,days\n");
+    EXPECT_EQ(c.substr(33, 25), "0,2021,Capricornus,0,2021");
+    EXPECT_EQ(std::count(c.begin(), c.end(), '\n'), 3);
+    EXPECT_EQ(j.substr(0, 68), "[\n  {\"cycle\": 0, \"year\": 2021, \"month\": \"Capricornus\", \"leap\": false");
+    EXPECT_EQ(j.substr(j.size() - 16), ", \"days\": 30}\n]\n");
+}
+
+TEST(tetrabiblos_test_suite, test_generator) {
+    // mean events from 2010 to 2034, handed out a Gregorian year at a time
+    const MeanSky sky(MeanSky::FROM - 10 * 365.25l, MeanSky::FROM + 14 * 365.25l);
+    std::mutex mutex;
+    std::map<int, int> searched;
+    std::set<std::thread::id> workers;
+    auto search = [&](JPLEphems &, int year) {
+        const jd_clock::time_point lo = SolarIngresses::newYear(year), hi = SolarIngresses::newYear(year + 1);
+        CalendarGenerator::YearEvents events;
+        std::copy_if(sky.newMoons.begin(), sky.newMoons.end(), std::back_inserter(events.newMoons), [&](const jd_clock::time_point &jd) {
+            return jd >= lo && jd < hi;
+        });
+        std::copy_if(sky.ingresses.begin(), sky.ingresses.end(), std::back_inserter(events.ingresses), [&](const PlanetEvent &ev) {
+            return ev.jd >= lo && ev.jd < hi;
+        });
+        std::lock_guard<std::mutex> lock(mutex);
+        ++searched[year];
+        workers.insert(std::this_thread::get_id());
+        return events;
+    };
+    auto open = [](JPLEphems &) {};
+    auto same = [](const std::vector<CalendarMonth> &a, const std::vector<CalendarMonth> &b) {
+        return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](const CalendarMonth &x, const CalendarMonth &y) {
+            return x.precessionalCycle == y.precessionalCycle && x.year == y.year && x.month == y.month &&
+                x.leap == y.leap && x.start == y.start && x.days == y.days;
+        });
+    };
+    auto eachOnce = [&](int first, int last) {
+        std::map<int, int> expect;
+        for (int y = first; y <= last; ++y) {
+            expect[y] = 1;
+        }
+        return searched == expect;
+    };
+
+    // a year either side of the range is searched, each once, on one worker
+    CalendarGenerator serial(open, search);
+    const std::vector<CalendarMonth> one = serial.generate(2013, 2029, 1);
+    EXPECT_TRUE(eachOnce(2012, 2030));
+    EXPECT_EQ(serial.years(), 19u);
+    EXPECT_EQ(workers.size(), 1u);
+    ASSERT_FALSE(one.empty());
+    EXPECT_EQ(one.front().year, 2013);
+    EXPECT_EQ(one.front().month, CAPRICORNUS);
+    EXPECT_EQ(one.back().year, 2029);
+    // the years stitched back together make the calendar the events make in one piece
+    Calendar calendar;
+    calendar.insert(SolarIngresses::newYear(2012), SolarIngresses::newYear(2031), sky.newMoons, sky.ingresses);
+    EXPECT_TRUE(same(one, calendar.months(2013, 2029)));
+
+    // the same on four workers
+    searched.clear();
+    workers.clear();
+    CalendarGenerator parallel(open, search);
+    const std::vector<CalendarMonth> four = parallel.generate(2013, 2029, 4);
+    EXPECT_TRUE(eachOnce(2012, 2030));
+    EXPECT_LE(workers.size(), 4u);
+    EXPECT_TRUE(same(one, four));
+
+    // a later range only searches the years it hasn't seen
+    searched.clear();
+    const std::vector<CalendarMonth> more = parallel.generate(2025, 2032, 4);
+    EXPECT_TRUE(eachOnce(2031, 2033));
+    EXPECT_EQ(parallel.years(), 22u);
+    searched.clear();
+    EXPECT_TRUE(same(parallel.generate(2020, 2024, 3), calendar.months(2020, 2024)));
+    EXPECT_TRUE(searched.empty());
+    const std::vector<CalendarMonth> overlap(std::find_if(one.begin(), one.end(), [](const CalendarMonth &m) { return m.year == 2025; }), one.end());
+    ASSERT_GT(more.size(), overlap.size());
+    EXPECT_TRUE(same(std::vector<CalendarMonth>(more.begin(), more.begin() + overlap.size()), overlap));
+    EXPECT_EQ(more.back().year, 2032);
+
+    EXPECT_TRUE(parallel.generate(2030, 2029, 4).empty());
+    EXPECT_TRUE(searched.empty());
+}
+
+}
@@ -0,0 +1,126 @@
+/**
+ * vec3batch.cpp tests
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#include <gtest/gtest.h>
+#include "../src/vec3batch.hpp"
+#include "../src/astro.hpp"
+
+namespace {
+
+using namespace github::paulyc;
+
+// odd, so every kernel has a partial vector at the end
+static constexpr std::size_t N = 1003;
+
+struct Pair {
+    Vec3BatchD a, b;
+    std::vector<cartesian3dvec> va, vb;
+
+    Pair() {
+        for (std::size_t i = 0; i < N; ++i) {
+            const long double t = 0.01l * i;
+            va.push_back(cartesian3dvec {{cosl(t) * (1.0l + t), sinl(3.0l * t), 0.5l - t}});
+            vb.push_back(cartesian3dvec {{sinl(t), 2.0l + cosl(t), 0.1l * t}});
+        }
+        // exactly parallel and exactly antiparallel, where acos would lose it
+        vb[5] = cartesian3dvec {{2.0l * va[5].x(), 2.0l * va[5].y(), 2.0l * va[5].z()}};
+        vb[6] = cartesian3dvec {{-va[6].x(), -va[6].y(), -va[6].z()}};
+        a = Vec3BatchD(std::span<const cartesian3dvec>(va));
+        b = Vec3BatchD(std::span<const cartesian3dvec>(vb));
+    }
+};
+
+std::vector<SimdLevel> levels() {
+    std::vector<SimdLevel> ls = {SimdLevel::Scalar};
+    if (detectedSimdLevel() >= SimdLevel::AVX2) {
+        ls.push_back(SimdLevel::AVX2);
+    }
+    if (detectedSimdLevel() >= SimdLevel::AVX512) {
+        ls.push_back(SimdLevel::AVX512);
+    }
+    return ls;
+}
+
+TEST(Vec3BatchTestSuite, test_layout) {
+    Pair p;
+    ASSERT_EQ(p.a.size(), N);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(p.a.x.data()) % 64, 0);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(p.a.z.data()) % 64, 0);
+    const cartesian3dvec v = p.va[17];
+    const basic_cartesian3dvec<double> w = p.a.cartesian(17);
+    EXPECT_EQ(w.x(), double(v.x()));
+    EXPECT_EQ(w.z(), double(v.z()));
+    p.a.set(17, vec3d_t {1.0, 2.0, 3.0});
+    EXPECT_EQ(p.a.y[17], 2.0);
+}
+
+TEST(Vec3BatchTestSuite, test_kernels) {
+    const Pair p;
+    for (SimdLevel level : levels()) {
+        SCOPED_TRACE(name(level));
+        std::vector<double> dot(N), mag(N), angle(N);
+        Vec3BatchD cross, unit, sph, back;
+        batch::dot(p.a, p.b, dot, level);
+        batch::cross(p.a, p.b, cross, level);
+        batch::mag(p.a, mag, level);
+        batch::normalize(p.a, unit, level);
+        batch::angle(p.a, p.b, angle, level);
+        batch::cart2sph(p.a, sph, level);
+        batch::sph2cart(sph, back, level);
+        ASSERT_EQ(cross.size(), N);
+        for (std::size_t i = 0; i < N; ++i) {
+            const cartesian3dvec &a = p.va[i], &b = p.vb[i];
+            const vec3q_t c = a.crossP(b);
+            EXPECT_NEAR(dot[i], a.dotP(b), 1e-13);
+            EXPECT_NEAR(cross.x[i], c.raw[0], 1e-13);
+            EXPECT_NEAR(cross.y[i], c.raw[1], 1e-13);
+            EXPECT_NEAR(cross.z[i], c.raw[2], 1e-13);
+            EXPECT_NEAR(mag[i], a.mag(), 1e-13);
+            EXPECT_NEAR(unit.x[i], a.normalize().x(), 1e-15);
+            EXPECT_NEAR(angle[i], elongation(a, b), 1e-14);
+            const spherical3dvec s = spacexfrm3d::cart2sph(a);
+            EXPECT_NEAR(sph.x[i], s.r(), 1e-13);
+            EXPECT_NEAR(sph.y[i], s.θ(), 1e-14);
+            EXPECT_NEAR(sph.z[i], s.ø(), 1e-14);
+            EXPECT_NEAR(back.x[i], a.x(), 1e-13);
+            EXPECT_NEAR(back.y[i], a.y(), 1e-13);
+            EXPECT_NEAR(back.z[i], a.z(), 1e-13);
+        }
+        EXPECT_NEAR(angle[5], 0.0, 1e-15);
+        EXPECT_NEAR(angle[6], M_PI, 1e-15);
+    }
+}
+
+TEST(Vec3BatchTestSuite, test_in_place_and_sizes) {
+    Pair p;
+    Vec3BatchD sph;
+    batch::cart2sph(p.a, sph);
+    batch::cart2sph(p.a, p.a);
+    EXPECT_EQ(p.a.x, sph.x);
+    EXPECT_EQ(p.a.y, sph.y);
+    EXPECT_EQ(p.a.z, sph.z);
+
+    std::vector<double> small(N - 1);
+    EXPECT_THROW(batch::dot(p.a, p.b, small), std::runtime_error);
+    Vec3BatchD shorter(N - 1), out;
+    EXPECT_THROW(batch::cross(p.a, shorter, out), std::runtime_error);
+}
+
+}
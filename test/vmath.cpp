@@ -0,0 +1,164 @@
+/**
+ * vmath.cpp tests
+ *
+ * Copyright (C) 2020 Paul Ciarlo <paul.ciarlo@gmail.com>
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Suite 500, Boston, MA  02110-1335, USA.
+ **/
+
+#include <gtest/gtest.h>
+#include <random>
+#include "../src/vmath.hpp"
+
+namespace {
+
+using namespace github::paulyc;
+
+// odd, so every kernel has a partial vector at the end
+static constexpr std::size_t N = 100001;
+
+// |got - ref| in units in the last place of ref, rounded to double
+double ulps(double got, long double ref) {
+    const double r = static_cast<double>(ref);
+    if (got == r) {
+        return 0.0;
+    }
+    const double ulp = r == 0.0 ? std::numeric_limits<double>::denorm_min() : std::nextafter(std::fabs(r), INFINITY) - std::fabs(r);
+    return static_cast<double>(fabsl(static_cast<long double>(got) - ref) / ulp);
+}
+
+std::vector<double> uniform(double lo, double hi, unsigned seed) {
+    std::mt19937_64 gen(seed);
+    std::uniform_real_distribution<double> dist(lo, hi);
+    std::vector<double> v(N);
+    for (double &d : v) {
+        d = dist(gen);
+    }
+    return v;
+}
+
+std::vector<SimdLevel> levels() {
+    std::vector<SimdLevel> ls = {SimdLevel::Scalar};
+    if (detectedSimdLevel() >= SimdLevel::AVX2) {
+        ls.push_back(SimdLevel::AVX2);
+    }
+    if (detectedSimdLevel() >= SimdLevel::AVX512) {
+        ls.push_back(SimdLevel::AVX512);
+    }
+    return ls;
+}
+
+TEST(VmathTestSuite, test_sincos_ulp) {
+    for (SimdLevel level : levels()) {
+        SCOPED_TRACE(name(level));
+        for (double range : {4.0, 1000.0, vmath::TRIG_REDUCTION_LIMIT, 1e9}) {
+            const std::vector<double> x = uniform(-range, range, 1);
+            std::vector<double> s(N), c(N), s1(N), c1(N);
+            vmath::sincos(x, s, c, level);
+            vmath::sin(x, s1, level);
+            vmath::cos(x, c1, level);
+            double worst = 0.0;
+            for (std::size_t i = 0; i < N; ++i) {
+                worst = std::max({worst, ulps(s[i], sinl(x[i])), ulps(c[i], cosl(x[i]))});
+                ASSERT_EQ(s[i], s1[i]);
+                ASSERT_EQ(c[i], c1[i]);
+            }
+            EXPECT_LE(worst, 2.0) << "|x| <= " << range;
+        }
+        // multiples of π/2 land on the quadrant boundaries
+        std::vector<double> q(N), s(N), c(N);
+        for (std::size_t i = 0; i < N; ++i) {
+            q[i] = (static_cast<double>(i) - static_cast<double>(N / 2)) * M_PI_2;
+        }
+        vmath::sincos(q, s, c, level);
+        for (std::size_t i = 0; i < N; ++i) {
+            // half of these are near zeros, where the bound is absolute
+            EXPECT_TRUE(ulps(s[i], sinl(q[i])) <= 2.0 || fabsl(s[i] - sinl(q[i])) < 1e-25l) << q[i];
+            EXPECT_TRUE(ulps(c[i], cosl(q[i])) <= 2.0 || fabsl(c[i] - cosl(q[i])) < 1e-25l) << q[i];
+        }
+    }
+}
+
+TEST(VmathTestSuite, test_inverse_ulp) {
+    const std::vector<double> y = uniform(-10.0, 10.0, 2), x = uniform(-10.0, 10.0, 3);
+    std::vector<double> u = uniform(-1.0, 1.0, 4);
+    u[0] = 1.0;
+    u[1] = -1.0;
+    u[2] = 1.0 - 0x1p-52;
+    u[3] = 1e-300;
+    for (SimdLevel level : levels()) {
+        SCOPED_TRACE(name(level));
+        std::vector<double> a(N), as(N), ac(N);
+        vmath::atan2(y, x, a, level);
+        vmath::asin(u, as, level);
+        vmath::acos(u, ac, level);
+        double worst_atan2 = 0.0, worst_asin = 0.0, worst_acos = 0.0;
+        for (std::size_t i = 0; i < N; ++i) {
+            worst_atan2 = std::max(worst_atan2, ulps(a[i], atan2l(y[i], x[i])));
+            worst_asin = std::max(worst_asin, ulps(as[i], asinl(u[i])));
+            worst_acos = std::max(worst_acos, ulps(ac[i], acosl(u[i])));
+        }
+        EXPECT_LE(worst_atan2, 2.0);
+        EXPECT_LE(worst_asin, 3.0);
+        EXPECT_LE(worst_acos, 3.0);
+    }
+}
+
+TEST(VmathTestSuite, test_special_values) {
+    const double inf = INFINITY;
+    const std::vector<double> ys = {0.0, -0.0, 0.0, -0.0, inf, inf, -inf, 1.0, 3.0, -3.0, 1.0, NAN};
+    const std::vector<double> xs = {0.0, 0.0, -0.0, -0.0, inf, -inf, 1.0, -inf, -0.0, 0.0, NAN, 1.0};
+    const std::vector<double> trig = {0.0, -0.0, inf, -inf, NAN, 1e300, -0x1p-1074};
+    const std::vector<double> unit = {1.0, -1.0, 0.0, -0.0, 1.5, NAN};
+    for (SimdLevel level : levels()) {
+        SCOPED_TRACE(name(level));
+        std::vector<double> out(ys.size());
+        vmath::atan2(ys, xs, out, level);
+        for (std::size_t i = 0; i < ys.size(); ++i) {
+            const double expect = std::atan2(ys[i], xs[i]);
+            if (std::isnan(expect)) {
+                EXPECT_TRUE(std::isnan(out[i])) << i;
+            } else {
+                EXPECT_EQ(out[i], expect) << i;
+                EXPECT_EQ(std::signbit(out[i]), std::signbit(expect)) << i;
+            }
+        }
+        std::vector<double> s(trig.size()), c(trig.size());
+        vmath::sincos(trig, s, c, level);
+        for (std::size_t i = 0; i < trig.size(); ++i) {
+            if (std::isnan(std::sin(trig[i]))) {
+                EXPECT_TRUE(std::isnan(s[i]) && std::isnan(c[i])) << i;
+            } else {
+                EXPECT_EQ(s[i], std::sin(trig[i])) << i;
+                EXPECT_EQ(std::signbit(s[i]), std::signbit(std::sin(trig[i]))) << i;
+                EXPECT_EQ(c[i], std::cos(trig[i])) << i;
+            }
+        }
+        std::vector<double> as(unit.size()), ac(unit.size());
+        vmath::asin(unit, as, level);
+        vmath::acos(unit, ac, level);
+        EXPECT_EQ(as[0], M_PI_2);
+        EXPECT_EQ(as[1], -M_PI_2);
+        EXPECT_EQ(ac[0], 0.0);
+        EXPECT_EQ(ac[1], M_PI);
+        EXPECT_TRUE(std::signbit(as[3]));
+        EXPECT_TRUE(std::isnan(as[4]) && std::isnan(ac[4]));
+        EXPECT_TRUE(std::isnan(as[5]) && std::isnan(ac[5]));
+    }
+    std::vector<double> small(1);
+    EXPECT_THROW(vmath::atan2(ys, xs, small), std::runtime_error);
+}
+
+}